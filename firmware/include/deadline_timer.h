@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstdint>
+#include <IntervalTimer.h>
+
+/**
+ * @brief One-shot deadlines for every in-flight operation on a single PIT channel
+ *
+ * Deadlines live in a binary min-heap keyed on their absolute expiry (micros()), with each
+ * slot remembering its heap position so arm and cancel are both O(log n). The PIT is only
+ * ever programmed for the earliest deadline; when it fires, every expired entry is popped,
+ * its callback runs in interrupt context and the timer is re-armed for the new head.
+ *
+ * Callbacks run inside the ISR: they may only set flags and wake threads.
+ */
+class deadline_timer {
+public:
+    typedef void (*expiry_callback_t)( void* context );
+    typedef uint16_t handle_t;                      // generation << 8 | slot
+
+    static const uint8_t  k_max_deadlines   = 24;   // HAL transfers, watchdog trackers and one trigger per channel
+    static const handle_t k_invalid_handle  = 0xFFFF;
+    static const uint32_t k_min_arm_micros  = 2;    // anything sooner fires on the next tick
+
+    deadline_timer();
+
+    // Arms a deadline timeout_us from now; k_invalid_handle when all slots are taken
+    handle_t arm( uint32_t timeout_us, expiry_callback_t callback, void* context );
+
+    // False when the deadline already fired (or the handle is stale)
+    bool cancel( handle_t handle );
+
+    uint8_t get_armed_count() const { return heap_size_; }
+    uint32_t get_expired_count() const { return expired_count_; }
+
+    // Shared instance, so every bus sits on the same PIT channel
+    static deadline_timer& shared();
+
+private:
+    struct slot_t {
+        uint32_t deadline_us;
+        expiry_callback_t callback;
+        void* context;
+        uint8_t heap_position;
+        uint8_t generation;
+        bool armed;
+
+        slot_t() :
+            deadline_us( 0 ), callback( nullptr ), context( nullptr ),
+            heap_position( 0 ), generation( 0 ), armed( false ) {}
+    };
+
+    slot_t slots_[k_max_deadlines];
+    uint8_t heap_[k_max_deadlines];                 // slot indexes, earliest deadline first
+    uint8_t heap_size_;
+    uint32_t expired_count_;
+    bool timer_running_;
+    IntervalTimer timer_;
+
+    static inline bool earlier( uint32_t a_us, uint32_t b_us ) { return static_cast< int32_t >( a_us - b_us ) < 0; }
+
+    void swap_nodes( uint8_t a, uint8_t b );
+    void sift_up( uint8_t position );
+    void sift_down( uint8_t position );
+    void remove_at( uint8_t position );
+    void reprogram( uint32_t now_us );
+    void service_expired();
+
+    static void timer_isr();
+};
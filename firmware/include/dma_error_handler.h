@@ -2,7 +2,10 @@
 
 #include <cstdint>
 #include "drivers/dma_i2c_hal.h"
+#include "drivers/i2c_fault_injector.h"
 #include "TeensyThreads.h"
+#include "deadline_timer.h"
+#include "transport_arbiter.h"
 
 namespace dma_diagnostics {
 
@@ -14,6 +17,9 @@ namespace dma_diagnostics {
  */
 class dma_error_handler {
 public:
+    // Performs the actual peripheral reset for a DAC; returns true if the device is back
+    typedef bool (*peripheral_reset_callback_t)( uint8_t dac_index, void* user_data );
+    
     // Error severity levels
     enum class error_severity_t : uint8_t {
         INFO = 0,           // Informational, no action needed
@@ -60,12 +66,18 @@ public:
         uint32_t failed_recoveries;
         uint32_t fallback_to_sync_count;
         uint32_t peripheral_resets;
+        uint32_t failed_peripheral_resets;
+        uint32_t last_reset_time_us;        // Bus recovery + device re-init + frame replay
+        uint32_t max_reset_time_us;
+        uint32_t average_reset_time_us;
         float error_rate_percentage;
         
         error_statistics_t() :
             total_errors( 0 ), timeout_errors( 0 ), nak_errors( 0 ), dma_errors( 0 ),
             arbitration_errors( 0 ), successful_recoveries( 0 ), failed_recoveries( 0 ),
-            fallback_to_sync_count( 0 ), peripheral_resets( 0 ), error_rate_percentage( 0.0f ) {}
+            fallback_to_sync_count( 0 ), peripheral_resets( 0 ), failed_peripheral_resets( 0 ),
+            last_reset_time_us( 0 ), max_reset_time_us( 0 ), average_reset_time_us( 0 ),
+            error_rate_percentage( 0.0f ) {}
     };
     
     // Configuration for error handling behavior
@@ -99,11 +111,19 @@ private:
     
     Threads::Mutex error_mutex_;
     
+    drivers::i2c_fault_injector* fault_injector_;
+    
+    peripheral_reset_callback_t reset_callback_;
+    void* reset_user_data_;
+    
     // Recovery state tracking
     struct recovery_state_t {
         uint8_t consecutive_errors[4];  // Per DAC error count
         uint32_t last_error_time[4];    // Per DAC last error timestamp
         bool fallback_mode[4];          // Per DAC sync fallback state
+        transport_arbiter* transport[4];// Per DAC transport, follows fallback_mode
+        volatile uint32_t retry_at_ms[4];   // Per DAC end of the RETRY_WITH_DELAY backoff
+        volatile bool backing_off[4];
         uint32_t peripheral_reset_count;
         
         recovery_state_t() : peripheral_reset_count( 0 ) {
@@ -111,6 +131,9 @@ private:
                 consecutive_errors[i] = 0;
                 last_error_time[i] = 0;
                 fallback_mode[i] = false;
+                transport[i] = nullptr;
+                retry_at_ms[i] = 0;
+                backing_off[i] = false;
             }
         }
     } recovery_state_;
@@ -121,8 +144,8 @@ private:
     void log_error_event( const error_event_t& event );
     void update_error_statistics( const error_event_t& event );
     uint32_t calculate_retry_delay( uint8_t retry_count );
-    bool should_reset_peripheral( uint8_t dac_index );
-    void reset_peripheral( uint8_t dac_index );
+    bool should_reset_peripheral( const error_event_t& error_event );
+    bool reset_peripheral( uint8_t dac_index );
 
 public:
     dma_error_handler( const error_config_t& config = error_config_t() );
@@ -134,13 +157,18 @@ public:
                                     uint8_t retry_count = 0,
                                     uint32_t context_data = 0 );
     
-    // Recovery execution
+    // Recovery execution; never blocks, RETRY_WITH_DELAY only records the backoff
     bool execute_recovery( const error_event_t& error_event );
+    // The DAC's worker, before each frame: false while a RETRY_WITH_DELAY backoff runs
+    bool may_retry( uint8_t dac_index, uint32_t now_millis );
     bool retry_operation( uint8_t dac_index, uint8_t retry_count );
     void enable_sync_fallback( uint8_t dac_index );
     void disable_sync_fallback( uint8_t dac_index );
     bool is_sync_fallback_active( uint8_t dac_index ) const;
     
+    // Fallback decisions are pushed straight into the device's transport arbiter
+    void attach_transport_arbiter( uint8_t dac_index, transport_arbiter* arbiter );
+    
     // Operation success notification
     void notify_success( uint8_t dac_index );
     void increment_operation_count();
@@ -163,9 +191,17 @@ public:
     bool is_system_healthy() const;
     uint32_t get_time_since_last_error( uint8_t dac_index ) const;
     
+    // Peripheral reset is delegated to whoever owns the bus and the last frame
+    void set_peripheral_reset_callback( peripheral_reset_callback_t callback, void* user_data );
+    
+    // Fault injection: chosen strategies are reported so recovery latency is kept per strategy
+    void attach_fault_injector( drivers::i2c_fault_injector* injector ) { fault_injector_ = injector; }
+    drivers::i2c_fault_injector* get_fault_injector() const { return fault_injector_; }
+    
     // Debug and diagnostic output
     void print_error_summary() const;
     void print_error_log() const;
+    void print_fault_latency_report() const;
     const char* error_code_to_string( drivers::dma_i2c_hal::error_code_t error_code ) const;
     const char* severity_to_string( error_severity_t severity ) const;
     const char* recovery_strategy_to_string( recovery_strategy_t strategy ) const;
@@ -174,21 +210,20 @@ public:
 /**
  * @brief Timeout watchdog for DMA operations
  * 
- * Provides timeout detection and automatic recovery for stuck DMA operations.
+ * Every tracked operation arms a deadline on the shared hardware timer. The watchdog
+ * thread stays suspended until a deadline fires, then runs recovery for that DAC.
  */
 class dma_timeout_watchdog {
 public:
     struct watchdog_config_t {
         uint32_t timeout_threshold_ms;
-        uint32_t check_interval_ms;
         bool enable_auto_recovery;
         bool enable_statistics;
         
         watchdog_config_t() :
-            timeout_threshold_ms( 500 ), check_interval_ms( 100 ),
+            timeout_threshold_ms( 500 ),
             enable_auto_recovery( true ), enable_statistics( true ) {}
     };
-    
     struct watchdog_statistics_t {
         uint32_t total_timeouts_detected;
         uint32_t successful_recoveries;
@@ -208,10 +243,15 @@ private:
         uint32_t start_time_ms;
         uint8_t dac_index;
         uint32_t timeout_count;
+        deadline_timer::handle_t deadline;
+        volatile bool expired;              // Set from the timer ISR
+        dma_timeout_watchdog* owner;
         
         operation_tracker_t() :
             operation_active( false ), start_time_ms( 0 ),
-            dac_index( 0 ), timeout_count( 0 ) {}
+            dac_index( 0 ), timeout_count( 0 ),
+            deadline( deadline_timer::k_invalid_handle ),
+            expired( false ), owner( nullptr ) {}
     } trackers_[4]; // One per DAC
     
     watchdog_config_t config_;
@@ -220,9 +260,13 @@ private:
     
     Threads::Mutex watchdog_mutex_;
     volatile bool watchdog_active_;
+    volatile uint8_t pending_expiries_;
+    volatile int watchdog_thread_id_;
     
     // Watchdog thread function
     static void watchdog_thread( void* user_data );
+    static void deadline_expired( void* context );
+    void wake_watchdog();
     void check_timeouts();
 
 public:
@@ -131,12 +131,15 @@ private:
         uint32_t high_frequency_operations;
         uint32_t concurrent_bus_operations;
         uint32_t error_injection_count;
+        uint8_t next_fault;             // Round-robin over i2c_fault_injector::fault_t
         
         stress_test_state_t() :
             active( false ), high_frequency_operations( 0 ),
-            concurrent_bus_operations( 0 ), error_injection_count( 0 ) {}
+            concurrent_bus_operations( 0 ), error_injection_count( 0 ), next_fault( 1 ) {}
     } stress_state_;
     
+    drivers::i2c_fault_injector* fault_injector_;
+    
     // Internal methods
     void update_latency_statistics(uint32_t latency_us);
     void update_throughput_statistics();
@@ -170,7 +173,9 @@ public:
     // Stress testing
     void enable_stress_testing();
     void disable_stress_testing();
+    bool is_stress_testing_active() const { return stress_state_.active; }
     void inject_error_scenario( uint8_t dac_index );
+    void set_fault_injector( drivers::i2c_fault_injector* injector ) { fault_injector_ = injector; }
     
     // Metrics access
     const performance_metrics_t& get_current_metrics() const { return metrics_; }
@@ -277,11 +282,14 @@ public:
         bool enable_constraint_checking;
         uint32_t alert_threshold_latency_us;
         float alert_threshold_error_rate;
+        int watched_thread_id;                      // Thread whose CPU share must not drop (-1: none)
+        uint16_t alert_threshold_thread_share_permille;
         
         monitor_config_t() :
             monitoring_interval_ms( 5000 ), enable_automatic_alerts( true ),
             enable_performance_logging( false ), enable_constraint_checking( true ),
-            alert_threshold_latency_us( 2000 ), alert_threshold_error_rate( 1.0f ) {}
+            alert_threshold_latency_us( 2000 ), alert_threshold_error_rate( 1.0f ),
+            watched_thread_id( -1 ), alert_threshold_thread_share_permille( 0 ) {}
     };
     
     enum class alert_level_t : uint8_t {
@@ -11,6 +11,109 @@ struct dr_teeth {
     
     static constexpr int      k_thread_slice_micros         = 10;
     static constexpr int      k_force_refresh_every_millis  = 100;
+    static constexpr uint16_t k_midi_min_cpu_permille       = 20;     // monitor alarm below 2% CPU for MIDI input
+
+    // Execution model for the MIDI -> frame -> DAC path: preemptive threads (false) or one
+    // run-to-completion event loop driven from loop() (true, see muppet_event_loop). There the
+    // voice is polled every k_voice_every_micros, the show runs when the voice had something
+    // and a worker when its device got a frame, or every k_worker_every_micros for re-probes,
+    // CV input and DMA completions. The DMA HAL worker stays a thread either way.
+    static constexpr bool     k_run_to_completion           = false;
+    static constexpr uint32_t k_voice_every_micros          = 125;    // one USB high speed microframe
+    static constexpr uint32_t k_worker_every_micros         = 250;
+
+    // Latency benchmark (muppet_latency_probe): channel 0 of every device changes every
+    // k_latency_probe_every_micros and is timed until it is on the DAC; latency, jitter and CPU
+    // use of the execution model above go to Serial every k_latency_report_every_millis.
+    static constexpr bool     k_latency_probe               = false;
+    static constexpr uint32_t k_latency_probe_every_micros  = 1000;
+    static constexpr uint32_t k_latency_report_every_millis = 5000;
+
+    // Thread stacks in bytes, each a multiple of the guard. They are static arrays, so they sit
+    // in DTCM with the rest of .bss instead of on the heap; a THREADS_STACK_PROFILING build
+    // reports the high-water marks ('u' in DMA validation mode) to tighten them against. The
+    // first k_stack_guard_bytes of every stack are TeensyThreads' MPU guard, never usable.
+    static constexpr int      k_stack_guard_bytes           = 512;    // THREADS_MPU_GUARD_SIZE
+    static constexpr int      k_muppet_show_stack_bytes     = k_stack_guard_bytes + 1024;
+    static constexpr int      k_voice_stack_bytes           = k_stack_guard_bytes + 2048;   // usbMIDI callbacks run here
+    static constexpr int      k_worker_stack_bytes          = k_stack_guard_bytes + 1024;
+    static constexpr int      k_party_pooper_stack_bytes    = k_stack_guard_bytes + 512;
+    static constexpr int      k_hal_worker_stack_bytes      = k_stack_guard_bytes + 1024;
+
+    // Device health: every device is brought up by its own worker, all buses at once; what is
+    // not up by the boot deadline is re-probed in the background
+    static constexpr uint8_t  k_boot_probe_attempts         = 3;      // blocking initialize() only
+    static constexpr uint32_t k_boot_probe_delay_millis     = 2;
+    static constexpr uint32_t k_boot_deadline_millis        = 20;
+    static constexpr uint8_t  k_failures_to_open_circuit    = 8;
+    static constexpr uint32_t k_reprobe_every_millis        = 500;
+    static constexpr bool     k_verify_config_writes        = false;  // read back every DAC config write
+
+    // Frame journal (muppet_frame_journal): the output frame survives power cycles in a ring of
+    // EEPROM records and is the first thing written to each device at boot. Rate limits spare
+    // the flash behind the EEPROM emulation: a changed frame is written once it held still for
+    // k_journal_settle_millis (or kept changing for k_journal_max_lag_millis), never twice
+    // within k_journal_every_millis.
+    static constexpr int      k_journal_eeprom_base         = 0;
+    static constexpr int      k_journal_eeprom_end          = 512;    // the journal's EEPROM partition
+    static constexpr uint8_t  k_journal_slots               = 8;
+    static constexpr uint32_t k_journal_check_every_millis  = 100;
+    static constexpr uint32_t k_journal_settle_millis       = 1000;
+    static constexpr uint32_t k_journal_every_millis        = 10000;
+    static constexpr uint32_t k_journal_max_lag_millis      = 60000;
+    // The journal also keeps the frame config's routing, quantizer and calibration as last
+    // applied over SysEx: two slots in a partition of their own after the presets
+    static constexpr int      k_calibration_eeprom_base     = 3712;
+    static constexpr int      k_calibration_eeprom_end      = 4096;
+
+    // Config store (muppet_config_store): wiring kept as a key / value log in the EEPROM right
+    // after the journal, changed over SysEx and applied at the next boot. keep() writes at most
+    // k_config_bytes_per_pass bytes per call, the rest waits for the next pass of loop().
+    static constexpr int      k_config_eeprom_base          = 512;
+    static constexpr int      k_config_eeprom_end           = 2048;   // the store's EEPROM partition, two segments
+    static constexpr int      k_config_bytes_per_pass       = 32;
+
+    // Presets (muppet_preset_bank, muppet_preset_morph): whole input frames plus the modulation
+    // settings in their own EEPROM partition, cached in RAM. On k_preset_midi_channel a program
+    // change morphs the outputs from where they are to that preset over the morph time (14 bit
+    // CC pair k_morph_time_cc / +32, in milliseconds, 0 jumps), one step every
+    // k_morph_tick_micros, and swaps its modulation in at once; k_preset_store_cc stores the
+    // current input and modulation as the preset its value names. A record is 200 bytes, so the
+    // partition holds 8 of them.
+    static constexpr int      k_preset_eeprom_base          = 2048;
+    static constexpr int      k_preset_eeprom_end           = 3712;   // the presets' EEPROM partition
+    static constexpr uint8_t  k_preset_count                = 8;
+    static constexpr uint8_t  k_preset_midi_channel         = 16;
+    static constexpr uint8_t  k_morph_time_cc               = 20;     // general purpose 5, LSB on 52
+    static constexpr uint8_t  k_preset_store_cc             = 21;
+    static constexpr uint32_t k_morph_tick_micros           = 1000;
+
+    // Modulation (muppet_modulation): up to k_modulation_routes routes from MIDI, CV input, LFO,
+    // envelope and random sources onto output channels, each with a Q15 depth, kept in the frame config
+    // and evaluated every k_modulation_tick_micros. Envelope e follows note on / off on MIDI
+    // channel e + 1; a note on there also clocks random source e when it samples and holds.
+    static constexpr uint8_t  k_modulation_routes           = 32;
+    static constexpr uint8_t  k_lfo_count                   = 2;
+    static constexpr uint8_t  k_envelope_count              = 4;
+    static constexpr uint8_t  k_random_count                = 4;
+    static constexpr uint32_t k_modulation_tick_micros      = 1000;
+
+    // Gates: device pins in k_gate_mask are GPIO outputs instead of DAC channels (same mask on
+    // every device), driven by MIDI note on/off on the matching channel. Pins also in
+    // k_trigger_mask fire a k_trigger_width_micros pulse on note on and ignore note off.
+    static constexpr uint8_t  k_gate_mask                   = 0x00;
+    static constexpr uint8_t  k_trigger_mask                = 0x00;
+    static constexpr uint32_t k_trigger_width_micros        = 2000;
+    static_assert( ( k_trigger_mask & ~k_gate_mask ) == 0, "triggers must be gates" );
+
+    // CV inputs: device pins in k_cv_input_mask are ADC inputs, converted one at a time between
+    // frames (at most one conversion every k_cv_input_every_micros per device) and sent out as
+    // 14 bit CC pairs (k_cv_input_cc, +32) on the matching MIDI channel.
+    static constexpr uint8_t  k_cv_input_mask               = 0x00;
+    static constexpr uint32_t k_cv_input_every_micros       = 1000;
+    static constexpr uint8_t  k_cv_input_cc                 = 16;     // general purpose 1, LSB on 48
+    static constexpr uint32_t k_cv_input_send_every_millis  = 5;
+    static_assert( ( k_cv_input_mask & k_gate_mask ) == 0, "a pin is either a gate or a CV input" );
 
     // Audio/Signal Processing Constants
     static constexpr uint16_t k_audio_half_scale            = 32 * 1024;
@@ -18,17 +121,24 @@ struct dr_teeth {
     static constexpr uint16_t k_midi_pitch_zero_offset      = 8192;   // from 0 - 8192, we have negative bend
     static constexpr uint16_t k_midi_pitch_14_bit_max       = 0x3FFF; // and from 8193 till k_midi_pitch_14_bit_max positive
     static constexpr uint8_t  k_midi_to_framework_scale     = 4;
+    static constexpr uint8_t  k_midi_messages_per_pass      = 32;     // drained per voice pass, a flood can't starve the rest of it
 
     static uint16_t           input_buffer[  k_total_channels ];
     static uint16_t           output_buffer[ k_total_channels ];
+    static volatile uint8_t   input_gates[   k_dac_count ];         // one bit per device pin, trigger ends land from an ISR
+    static uint8_t            output_gates[  k_dac_count ];
+    static volatile uint16_t  cv_input_buffer[ k_total_channels ];  // written by the workers, framework scale
     
-    template< typename T >
-    static void     go_muppets( T& muppets ) {
+    // config is the show's snapshot of the routing and calibration (muppet_frame_config),
+    // modulation the per channel offsets of the modulation matrix or nullptr
+    template< typename T, typename C >
+    static void     go_muppets( T& muppets, const C& config, const int32_t* modulation ) {
         for ( uint8_t muppet_index = 0; muppet_index < k_dac_count; ++muppet_index ) {
             if ( muppets.attention_please( muppet_index ) ) {
                 uint8_t starting_channel = muppet_index * T::k_channels_per_dac;
 
-                memcpy( &output_buffer[ starting_channel ], &input_buffer[ starting_channel ], sizeof( uint16_t ) * T::k_channels_per_dac );
+                config.build( &output_buffer[ starting_channel ], input_buffer, modulation, starting_channel, T::k_channels_per_dac );
+                output_gates[ muppet_index ] = input_gates[ muppet_index ];
 
                 muppets.throw_muppet_in_the_mud( muppet_index );
                 muppets.thanks( muppet_index );
@@ -29,14 +29,27 @@ public:
         uint8_t  ldac_port;
     };
 
-    void initialize( const initialization_struct_t& initialization_struct );
+    // attach() and then bring_up() until it answers; initialize() is both, blocking, and zeroes the outputs
+    bool initialize( const initialization_struct_t& initialization_struct );
+    void attach( const initialization_struct_t& initialization_struct );
+    bool bring_up( void );
+    void reinitialize( void );
+    bool recover_bus( void );
+    bool probe( void );
 
     void enable( void );
     void disable( void );
 
     void set_channel_value( uint8_t channel_index, value_t value );
     void set_all_channels_same_value( value_t value_for_all_channels );
-    void set_values( value_t values[ k_channels ] );
+    bool set_values( value_t values[ k_channels ] );
+
+    // no GPIO on the MCP4728, gates go nowhere
+    bool    set_gates( uint8_t ) { return true; }
+    uint8_t what_gates( void ) const { return 0; }
+
+    // nor any ADC
+    bool read_cv_input( uint8_t&, value_t& ) { return false; }
 
 protected:
     TwoWire*         wire;
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "drivers/adafruit_mcp_4728.h"
+#include "drivers/dma_i2c_hal.h"
+#include "drivers/async_dac.h"
+#include "TeensyThreads.h"
+
+namespace drivers {
+
+/**
+ * @brief Asynchronous extension of the MCP4728 driver
+ *
+ * Packs the four channels into one fast write frame (two bytes per channel, power down
+ * bits clear) and hands it to the DMA I2C HAL, so the worker no longer blocks for the
+ * length of Adafruit_MCP4728::fastWrite. The synchronous API is still there for the
+ * bring-up, the re-probe and the fallback path.
+ */
+class adafruit_mcp_4728_async : public adafruit_mcp_4728 {
+public:
+    const static uint8_t k_fast_write_bytes = 2 * k_channels;
+
+    typedef drivers::async_completion_callback_t async_completion_callback_t;
+
+    // Async operation status
+    enum class async_status_t : uint8_t {
+        READY = 0,          // Ready for new operation
+        IN_PROGRESS,        // Async operation in progress
+        COMPLETED,          // Last operation completed successfully
+        ERROR_OCCURRED      // Last operation failed
+    };
+
+    // Statistics for monitoring async operations
+    struct async_stats_t {
+        uint32_t total_operations;
+        uint32_t successful_operations;
+        uint32_t failed_operations;
+        uint32_t max_transfer_time_us;
+
+        async_stats_t() :
+            total_operations( 0 ), successful_operations( 0 ), failed_operations( 0 ),
+            max_transfer_time_us( 0 ) {}
+    };
+
+private:
+    dma_i2c_hal dma_hal_;
+
+    // Async operation state
+    volatile async_status_t async_status_;
+    async_completion_callback_t current_callback_;
+    void* current_user_data_;
+    Threads::Mutex async_mutex_;
+
+    // The fast write frame the HAL sends (must be DMA-safe)
+    uint8_t dma_write_buffer_[k_fast_write_bytes] __attribute__((aligned(32)));
+
+    async_stats_t stats_;
+    uint32_t transfer_start_time_;
+
+    static void dma_completion_callback( dma_i2c_hal::transfer_state_t state,
+                                       dma_i2c_hal::error_code_t error,
+                                       void* user_data );
+
+    void prepare_fast_write_buffer( const value_t values[] );
+
+public:
+    adafruit_mcp_4728_async();
+    virtual ~adafruit_mcp_4728_async();
+
+    // DMA on top of an attach()ed driver; no bus traffic, bring_up() stays with the worker
+    bool initialize_async( const initialization_struct_t& initialization_struct,
+                         uint8_t dma_channel = 0 );
+
+    // Asynchronous operations (non-blocking)
+    dma_i2c_hal::error_code_t set_values_async( const value_t values[],
+                                               async_completion_callback_t callback,
+                                               void* user_data = nullptr );
+
+    // The MCP4728 has no gates, the frame is the four DAC values
+    dma_i2c_hal::error_code_t set_frame_async( const value_t values[],
+                                              uint8_t gate_bits,
+                                              async_completion_callback_t callback,
+                                              void* user_data = nullptr );
+
+#ifdef MUPPET_COROUTINES
+    typedef async_frame_transfer< adafruit_mcp_4728_async > frame_transfer;
+
+    // co_await write_frame( values, gates, executor ) - one fast write frame
+    frame_transfer write_frame( const value_t values[], uint8_t gate_bits, muppet_executor& executor ) {
+        return frame_transfer( *this, values, gate_bits, executor );
+    }
+#endif
+
+    // Status and monitoring operations
+    async_status_t get_async_status() const { return async_status_; }
+    bool is_async_mode_available() const { return dma_hal_.is_initialized(); }
+    dma_i2c_hal::error_code_t get_last_async_error() const { return dma_hal_.get_last_error(); }
+
+    // Blocking wait operations (with timeout)
+    dma_i2c_hal::error_code_t wait_for_async_completion( uint32_t timeout_ms = 100 );
+
+    // Abort ongoing async operation
+    dma_i2c_hal::error_code_t abort_async_operation();
+
+    // Statistics and diagnostics
+    const async_stats_t& get_async_statistics() const { return stats_; }
+    void reset_async_statistics();
+
+    // Fault injection on this device's bus
+    void attach_fault_injector( i2c_fault_injector* injector, uint8_t bus_index ) { dma_hal_.set_fault_injector( injector, bus_index ); }
+};
+
+} // namespace drivers
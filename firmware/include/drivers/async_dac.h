@@ -0,0 +1,184 @@
+#pragma once
+
+#include "drivers/dma_i2c_hal.h"
+#include "muppet_state_word.h"
+#include "muppet_coroutine.h"
+
+namespace drivers {
+
+// What electric_mayhem_dma needs from an async DAC driver (rob_tillaart_ad_5993r_async,
+// adafruit_mcp_4728_async), besides its synchronous base:
+//
+//   bool initialize_async( const initialization_struct_t&, uint8_t dma_channel )    after attach(), no bus traffic
+//   bool is_async_mode_available( void ) const
+//   dma_i2c_hal::error_code_t set_frame_async( const value_t values[], uint8_t gate_bits,
+//                                              async_completion_callback_t, void* user_data )
+//   dma_i2c_hal::error_code_t abort_async_operation( void )
+//   void attach_fault_injector( i2c_fault_injector*, uint8_t bus_index )
+//   write_frame( values, gate_bits, executor )                                       with MUPPET_COROUTINES
+//
+// The pieces below only go through that, so every driver shares them.
+
+// Async operation completion callback type
+typedef void (*async_completion_callback_t)( bool success, dma_i2c_hal::error_code_t error, void* user_data );
+
+#ifdef MUPPET_COROUTINES
+/**
+ * @brief Awaitable frame transfer: co_await yields the transfer's result
+ *
+ * The transfer starts when the coroutine suspends; its completion schedules the
+ * coroutine on the given executor, which resumes it on the executor's thread. If the
+ * transfer can't start the coroutine doesn't suspend at all, started() is false and
+ * the result says why.
+ */
+template < typename async_driver_t >
+class async_frame_transfer {
+public:
+    typedef typename async_driver_t::value_t value_t;
+
+    async_frame_transfer( async_driver_t& driver, const value_t values[], uint8_t gate_bits, muppet_executor& executor ) :
+        driver_(driver), values_(values), gate_bits_(gate_bits), executor_(executor),
+        result_(dma_i2c_hal::error_code_t::SUCCESS), started_(false) {}
+
+    bool await_ready() const noexcept { return false; }
+
+    bool await_suspend( std::coroutine_handle<> handle ) {
+        handle_ = handle;
+
+        // Completion may land before this returns; it only schedules, nothing resumes us yet
+        dma_i2c_hal::error_code_t result = driver_.set_frame_async(values_, gate_bits_, completed, this);
+        started_ = (result == dma_i2c_hal::error_code_t::SUCCESS);
+        if (!started_) {
+            result_ = result;
+        }
+
+        return started_;
+    }
+
+    dma_i2c_hal::error_code_t await_resume() const noexcept { return result_; }
+
+    bool started() const { return started_; }
+
+private:
+    static void completed( bool success, dma_i2c_hal::error_code_t error, void* user_data ) {
+        async_frame_transfer* transfer = static_cast<async_frame_transfer*>(user_data);
+
+        transfer->result_ = success ? dma_i2c_hal::error_code_t::SUCCESS : error;
+        transfer->executor_.schedule(transfer->handle_);
+    }
+
+    async_driver_t&                     driver_;
+    const value_t*                      values_;    // copied into the DMA buffer before suspending
+    uint8_t                             gate_bits_;
+    muppet_executor&                    executor_;
+    std::coroutine_handle<>             handle_;
+    volatile dma_i2c_hal::error_code_t  result_;
+    bool                                started_;
+};
+#endif
+
+/**
+ * @brief Thread-safe async operation manager for integration with electric_mayhem
+ *
+ * Provides a higher-level interface for managing async DAC operations within
+ * the Master of Muppets threading architecture. Lives next to its driver, which
+ * attach() points it at once the driver's DMA is up.
+ */
+template < typename async_driver_t >
+class async_dac_manager {
+private:
+    async_driver_t* async_driver_;
+
+    // Operation sequence, pending/completed phase and result code in one atomic word;
+    // written by the worker and by the HAL completion callback
+    muppet_state_word operation_state_;
+
+    // Pending -> completed with the result, in one CAS
+    static void async_operation_callback( bool success, dma_i2c_hal::error_code_t error, void* user_data ) {
+        async_dac_manager* manager = static_cast<async_dac_manager*>(user_data);
+
+        if (!manager) {
+            return;
+        }
+
+        dma_i2c_hal::error_code_t result = success ? dma_i2c_hal::error_code_t::SUCCESS : error;
+        manager->operation_state_.transition(muppet_state_word::k_pending, 0,
+                                             muppet_state_word::k_completed | muppet_state_word::with_code(static_cast<uint8_t>(result)),
+                                             muppet_state_word::k_pending | muppet_state_word::k_code_mask);
+    }
+
+public:
+    async_dac_manager( async_driver_t* driver = nullptr ) : async_driver_(driver) {}
+
+    ~async_dac_manager() {
+        if (operation_state_.is(muppet_state_word::k_pending)) {
+            force_operation_completion();
+        }
+    }
+
+    void attach( async_driver_t* driver ) { async_driver_ = driver; }
+
+    // High-level async operations for worker threads
+    bool initiate_async_update( const typename async_driver_t::value_t values[], uint8_t gate_bits ) {
+        if (!async_driver_ || !values) {
+            return false;
+        }
+
+        // Claim the next operation in one CAS, unless one is still in flight
+        uint32_t sequence;
+        if (!operation_state_.try_start(muppet_state_word::k_pending, muppet_state_word::k_pending, sequence)) {
+            return false;
+        }
+
+        // Start async operation
+        dma_i2c_hal::error_code_t result = async_driver_->set_frame_async(values,
+                                                                          gate_bits,
+                                                                          async_operation_callback,
+                                                                          this);
+
+        if (result != dma_i2c_hal::error_code_t::SUCCESS) {
+            // Operation failed to start, reset state but keep the reason
+            operation_state_.transition(muppet_state_word::k_pending, 0,
+                                        muppet_state_word::with_code(static_cast<uint8_t>(result)),
+                                        muppet_state_word::k_phase_mask | muppet_state_word::k_code_mask);
+            return false;
+        }
+
+        return true;
+    }
+
+    bool is_operation_pending() const { return operation_state_.is(muppet_state_word::k_pending); }
+    bool is_operation_completed() const { return operation_state_.is(muppet_state_word::k_completed); }
+    uint32_t get_completion_sequence() const { return operation_state_.sequence(); }
+    dma_i2c_hal::error_code_t get_operation_result() { return static_cast<dma_i2c_hal::error_code_t>(operation_state_.code()); }
+
+    // Integration with muppet_state sequence tracking
+    bool check_and_clear_completion( uint32_t expected_sequence ) {
+        uint32_t word = operation_state_.load();
+
+        if (!muppet_state_word::is(word, muppet_state_word::k_completed) ||
+            muppet_state_word::sequence_of(word) != expected_sequence) {
+            return false;
+        }
+
+        // Clear completion state for next operation, the result code stays readable
+        return operation_state_.transition(muppet_state_word::k_completed, 0, 0, muppet_state_word::k_phase_mask);
+    }
+
+    void reset_operation_state() { operation_state_.retire(); }
+
+    // Error handling and recovery
+    bool has_operation_error() const {
+        return operation_state_.code() != static_cast<uint8_t>(dma_i2c_hal::error_code_t::SUCCESS);
+    }
+
+    // For error recovery
+    void force_operation_completion() {
+        if (async_driver_) {
+            async_driver_->abort_async_operation();
+        }
+        reset_operation_state();
+    }
+};
+
+} // namespace drivers
@@ -5,6 +5,8 @@
 #include <Arduino.h>
 #include <Wire.h>
 #include "TeensyThreads.h"
+#include "deadline_timer.h"
+#include "dr_teeth.h"
 
 // Teensy 4.1 compatibility layer for DMA I2C
 // Note: This is a simplified implementation for Arduino/Teensy environment
@@ -12,6 +14,8 @@
 
 namespace drivers {
 
+class i2c_fault_injector;
+
 /**
  * @brief DMA I2C Hardware Abstraction Layer for IMXRT1062
  * 
@@ -97,6 +101,10 @@ private:
         volatile bool async_operation_complete;
         dma_i2c_transfer_t pending_transfer;
         
+        // Hardware deadline for the in-flight transfer
+        deadline_timer::handle_t deadline;
+        volatile bool deadline_fired;
+        
         dma_i2c_handle_t() :
             callback( nullptr ),
             state( transfer_state_t::IDLE ),
@@ -104,21 +112,34 @@ private:
             user_data( nullptr ),
             transfer_start_time( 0 ),
             async_operation_pending( false ),
-            async_operation_complete( false )
+            async_operation_complete( false ),
+            deadline( deadline_timer::k_invalid_handle ),
+            deadline_fired( false )
         {}
     };
     
     dma_i2c_handle_t handle_;
     bool initialized_;
     
-    // Async operation simulation thread
+    // Optional fault injection (nullptr in normal operation)
+    i2c_fault_injector* fault_injector_;
+    uint8_t fault_bus_index_;
+    
+    // Async operation simulation thread, on a stack that lives with the HAL; set by init(),
+    // cleared by the worker on its way out (thread ids are reused, this flag is not)
     static void async_worker_thread( void* user_data );
+    volatile bool worker_running_;
+    alignas(THREADS_STACK_ALIGN) uint8_t worker_stack_[ dr_teeth::k_hal_worker_stack_bytes ];
     
     // Perform actual I2C transfer
     error_code_t perform_i2c_transfer( const dma_i2c_transfer_t& transfer );
+    error_code_t perform_faulty_transfer( uint8_t fault, const dma_i2c_transfer_t& transfer );
+    static transfer_state_t error_to_state( error_code_t error );
     
     // Timeout checking
     bool is_transfer_timeout();
+    static void deadline_expired( void* context );
+    bool disarm_deadline();
 
 public:
     dma_i2c_hal();
@@ -138,9 +159,12 @@ public:
     transfer_state_t get_transfer_state() const { return handle_.state; }
     error_code_t get_last_error() const { return handle_.last_error; }
     bool is_transfer_complete() const;
-    error_code_t wait_for_completion( uint32_t timeout_ms = 0 ); // 0 = use configured timeout
+    error_code_t wait_for_completion( uint32_t timeout_ms = 0 ); // 0 = rely on the armed deadline
     error_code_t abort_transfer();
     
+    // Fault injection between the transfer queue and TwoWire
+    void set_fault_injector( i2c_fault_injector* injector, uint8_t bus_index );
+    
     // Utility functions
     static const char* state_to_string( transfer_state_t state );
     static const char* error_to_string( error_code_t error );
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <cstdint>
+
+class TwoWire;
+
+namespace drivers {
+
+////////////////////////////////////////////////////////////////////////////////
+// i2c_bus_recovery
+// Frees a bus held by a slave that lost sync mid-byte: clock SCL until the
+// slave lets go of SDA (9 clocks at most), then issue a STOP.
+//
+// The sequence only talks to the bus through line_driver_t, which provides:
+//   void release_sda( ), release_scl( )     - let the pull-up take the line high
+//   void drive_sda_low( ), drive_scl_low( ) - pull the line low
+//   bool read_sda( ), read_scl( )           - sample the line
+//   void half_period( )                     - wait half an SCL period
+// so it runs the same against the Teensy pins or a simulated slave on the host.
+////////////////////////////////////////////////////////////////////////////////
+
+template < typename line_driver_t >
+class i2c_bus_recovery {
+public:
+    enum class result_t : uint8_t {
+        BUS_FREE = 0,   // SDA was already high, nothing to do
+        RECOVERED,      // Slave released SDA after clocking
+        SDA_STUCK,      // SDA still low after 9 clocks (slave is dead or shorted)
+        SCL_STUCK       // SCL held low, clocking can't help
+    };
+
+    const static uint8_t  k_recovery_clocks     = 9;
+    const static uint16_t k_stretch_wait_cycles = 100;
+
+    static result_t recover( line_driver_t& lines ) {
+        lines.release_sda( );
+        lines.release_scl( );
+        lines.half_period( );
+
+        if ( !wait_for_scl( lines ) ) {
+            return result_t::SCL_STUCK;
+        }
+
+        if ( lines.read_sda( ) ) {
+            return result_t::BUS_FREE;
+        }
+
+        for ( uint8_t clock = 0; clock < k_recovery_clocks && !lines.read_sda( ); ++clock ) {
+            lines.drive_scl_low( );
+            lines.half_period( );
+            lines.release_scl( );
+            lines.half_period( );
+
+            if ( !wait_for_scl( lines ) ) {
+                return result_t::SCL_STUCK;
+            }
+        }
+
+        if ( !lines.read_sda( ) ) {
+            return result_t::SDA_STUCK;
+        }
+
+        // STOP: SDA rising while SCL is high
+        lines.drive_scl_low( );
+        lines.half_period( );
+        lines.drive_sda_low( );
+        lines.half_period( );
+        lines.release_scl( );
+        lines.half_period( );
+        lines.release_sda( );
+        lines.half_period( );
+
+        return lines.read_sda( ) ? result_t::RECOVERED : result_t::SDA_STUCK;
+    }
+
+protected:
+    // slaves may stretch the clock, give them a bounded chance to release it
+    static bool wait_for_scl( line_driver_t& lines ) {
+        for ( uint16_t cycle = 0; cycle < k_stretch_wait_cycles; ++cycle ) {
+            if ( lines.read_scl( ) ) {
+                return true;
+            }
+            lines.half_period( );
+        }
+        return false;
+    }
+};
+
+////////////////////////////////////////////////////////////////////////////////
+// teensy_i2c_lines
+// Line driver on the Teensy 4.1 pins of a TwoWire port, open drain emulated by
+// switching between OUTPUT LOW and INPUT_PULLUP.
+////////////////////////////////////////////////////////////////////////////////
+
+class teensy_i2c_lines {
+public:
+    const static uint8_t k_half_period_micros = 5; // 100kHz bit-bang
+
+    teensy_i2c_lines( uint8_t the_sda_pin, uint8_t the_scl_pin ) :
+        sda_pin( the_sda_pin ),
+        scl_pin( the_scl_pin )
+    { }
+
+    void release_sda( void );
+    void release_scl( void );
+    void drive_sda_low( void );
+    void drive_scl_low( void );
+    bool read_sda( void );
+    bool read_scl( void );
+    void half_period( void );
+
+    static bool pins_for( TwoWire* wire, uint8_t& sda_pin, uint8_t& scl_pin );
+
+protected:
+    uint8_t sda_pin;
+    uint8_t scl_pin;
+};
+
+// Bit-bangs the port's pins free and soft resets the LPI2C (Wire::begin resets
+// the controller and muxes the pins back). True if the bus ended up idle.
+bool recover_i2c_bus( TwoWire* wire, uint32_t wire_clock );
+
+} // namespace drivers
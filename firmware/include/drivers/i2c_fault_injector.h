@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include "drivers/dma_i2c_hal.h"
+#include "TeensyThreads.h"
+
+namespace drivers {
+
+/**
+ * @brief Fault-injection shim for the I2C transport
+ *
+ * Sits between the drivers and the bus: dma_i2c_hal::perform_i2c_transfer and the
+ * synchronous frame writes of electric_mayhem_dma ask it for a fault before touching TwoWire. Faults are either scheduled (after N transfers, optionally
+ * repeating) or probabilistic (parts per million per transfer). Time-to-detect and
+ * time-to-recover are accumulated per fault type and per recovery strategy, so the cost of
+ * each fault in milliseconds of frozen CV can be read back.
+ */
+class i2c_fault_injector {
+public:
+    static const uint8_t k_max_buses      = 4;
+    static const uint8_t k_strategy_slots = 6;  // One per dma_error_handler::recovery_strategy_t
+
+    // Fault types the shim can produce
+    enum class fault_t : uint8_t {
+        NONE = 0,
+        NAK,                // Slave does not acknowledge
+        TIMEOUT,            // Transfer hangs until the configured timeout expires
+        ARBITRATION_LOST,   // Another master won the bus
+        STUCK_SDA,          // Slave holds SDA low; persists until release_stuck_bus()
+        PARTIAL_TRANSFER,   // Only part of the payload is clocked out before a NAK
+        FAULT_COUNT
+    };
+
+    static const uint8_t k_fault_types = static_cast< uint8_t >( fault_t::FAULT_COUNT );
+
+    // Per-bus injection plan
+    struct fault_plan_t {
+        fault_t fault;                  // Fault produced by this plan
+        uint32_t after_transfers;       // Scheduled: fire on this transfer count (0 = not scheduled)
+        uint32_t repeat_every;          // Scheduled: re-arm every N transfers (0 = one shot)
+        uint32_t probability_ppm;       // Probabilistic: chance per transfer in parts per million
+
+        fault_plan_t() :
+            fault( fault_t::NONE ),
+            after_transfers( 0 ),
+            repeat_every( 0 ),
+            probability_ppm( 0 )
+        {}
+    };
+
+    // Latency of completed fault windows for one (fault, recovery strategy) pair
+    struct latency_statistics_t {
+        uint32_t samples;               // Faults detected and recovered under this strategy
+        uint32_t average_detect_us;     // Injection to first failed transfer
+        uint32_t max_detect_us;
+        uint32_t average_recover_us;    // First failed transfer to first good transfer
+        uint32_t max_recover_us;
+
+        latency_statistics_t() :
+            samples( 0 ),
+            average_detect_us( 0 ), max_detect_us( 0 ),
+            average_recover_us( 0 ), max_recover_us( 0 ) {}
+    };
+
+private:
+    // Injection and latency tracking state for one bus
+    struct bus_state_t {
+        fault_plan_t plan;
+        uint32_t transfer_count;
+        uint32_t next_scheduled_transfer;
+        fault_t tracked_fault;          // Fault whose latency is being measured
+        uint8_t strategy_slot;          // Recovery strategy chosen for the tracked fault
+        uint32_t injected_at_us;
+        uint32_t detected_at_us;
+        bool strategy_tagged;
+        bool awaiting_detection;
+        bool awaiting_recovery;
+        volatile bool sda_stuck;
+        volatile fault_t armed_fault;   // One-shot fault for the next transfer
+
+        bus_state_t() :
+            transfer_count( 0 ),
+            next_scheduled_transfer( 0 ),
+            tracked_fault( fault_t::NONE ),
+            strategy_slot( 0 ),
+            injected_at_us( 0 ),
+            detected_at_us( 0 ),
+            strategy_tagged( false ),
+            awaiting_detection( false ),
+            awaiting_recovery( false ),
+            sda_stuck( false ),
+            armed_fault( fault_t::NONE )
+        {}
+    };
+
+    bus_state_t buses_[k_max_buses];
+    latency_statistics_t latency_[k_fault_types][k_strategy_slots];
+    uint32_t injected_[k_fault_types];
+    uint32_t random_state_;
+    volatile bool enabled_;
+
+    Threads::Mutex injector_mutex_;
+
+    uint32_t next_random();
+    bool roll_probability( uint32_t probability_ppm );
+    void start_tracking( bus_state_t& bus, fault_t fault );
+    void close_window( bus_state_t& bus, uint32_t now_us );
+    static void accumulate( uint32_t sample_us, uint32_t count, uint32_t& average_us, uint32_t& max_us );
+
+public:
+    i2c_fault_injector( uint32_t seed = 0x5EED1234 );
+
+    // Control
+    void enable() { enabled_ = true; }
+    void disable() { enabled_ = false; }
+    bool is_enabled() const { return enabled_; }
+
+    // Fault planning
+    void set_plan( uint8_t bus_index, const fault_plan_t& plan );
+    void clear_plan( uint8_t bus_index );
+    void arm_single_fault( uint8_t bus_index, fault_t fault );
+
+    // Transport hooks (called by dma_i2c_hal and the synchronous writes)
+    fault_t next_fault( uint8_t bus_index );
+    void on_transfer_result( uint8_t bus_index, dma_i2c_hal::error_code_t result );
+
+    // Recovery hooks (called by dma_error_handler and bus recovery)
+    void on_recovery_strategy( uint8_t bus_index, uint8_t strategy_slot );
+    void release_stuck_bus( uint8_t bus_index );
+    bool is_bus_stuck( uint8_t bus_index ) const;
+
+    // Statistics
+    const latency_statistics_t& get_latency_statistics( fault_t fault, uint8_t strategy_slot ) const;
+    uint32_t get_injected_count( fault_t fault ) const;
+    uint32_t get_transfer_count( uint8_t bus_index ) const;
+    void reset_statistics();
+
+    // What the transport reports for the fault
+    static dma_i2c_hal::error_code_t error_for( fault_t fault );
+    static const char* fault_to_string( fault_t fault );
+};
+
+} // namespace drivers
@@ -4,6 +4,7 @@
 #include <AD5593R.h>
 
 #include "dr_teeth.h"
+#include "drivers/shadowed_ad5593r.h"
 
 class TwoWire;
 
@@ -14,6 +15,7 @@ public:
     const static uint32_t k_wire_clock = 400000L;
     const static uint16_t k_max_val    = 4095;
     const static uint8_t  k_channels   = 8;
+    const static uint8_t  k_dac_pins   = 0xFF & ~( dr_teeth::k_gate_mask | dr_teeth::k_cv_input_mask );
 
     typedef uint16_t value_t;
 
@@ -27,23 +29,46 @@ public:
         uint8_t  a0_port;
     };
 
-    rob_tillaart_ad_5993r( void ) : wire( 0 ), ad5593r( 0x10 ) { }
+    rob_tillaart_ad_5993r( void ) : wire( 0 ), ad5593r( 0x10 ), gates( 0 ) { }
     
-    void initialize( const initialization_struct_t& initialization_struct );
+    // attach() and then bring_up() until it answers; initialize() is both, blocking, and zeroes the outputs
+    bool initialize( const initialization_struct_t& initialization_struct );
+    void attach( const initialization_struct_t& initialization_struct );
+    bool bring_up( void );
+    void reinitialize( void );
+    bool recover_bus( void );
+    bool probe( void );
 
     void enable( void );
     void disable( void );
 
     void set_channel_value( uint8_t channel_index, value_t value );
     void set_all_channels_same_value( value_t value_for_all_channels );
-    void set_values( value_t values[ k_channels ] );
+    bool set_values( value_t values[ k_channels ] );
+
+    // one GPIO output register write for every gate pin (dr_teeth::k_gate_mask)
+    bool    set_gates( uint8_t gate_bits );
+    uint8_t what_gates( void ) const { return gates; }
+
+    // next conversion of the running CV input sequence (dr_teeth::k_cv_input_mask)
+    bool read_cv_input( uint8_t& channel_index, value_t& value );
+
+    // read every config write back (costs a transaction per write, for bring-up)
+    void verify_config_writes( bool enabled ) { ad5593r.verify_writes( enabled ); }
+    const shadowed_ad5593r& registers( void ) const { return ad5593r; }
 
 protected:
-    TwoWire* wire;
-    uint8_t  a0_port;
-    AD5593R  ad5593r;
+    TwoWire*         wire;
+    uint8_t          a0_port;
+    shadowed_ad5593r ad5593r;
+    uint8_t          gates;
+
+    static inline bool is_dac( uint8_t channel_index ) { return ( k_dac_pins & ( 1 << channel_index ) ) != 0; }
+
+    void configure_device( void );
 
     inline value_t dac_value_rescale( value_t value ) { return static_cast< value_t >( static_cast< uint32_t >( value ) * k_max_val / dr_teeth::k_max_value ); }
+    inline value_t adc_value_rescale( value_t value ) { return static_cast< value_t >( static_cast< uint32_t >( value ) * dr_teeth::k_max_value / k_max_val ); }
 };
 
 } // namespace drivers
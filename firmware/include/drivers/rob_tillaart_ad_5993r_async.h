@@ -2,6 +2,7 @@
 
 #include "drivers/rob_tillaart_ad_5993r.h"
 #include "drivers/dma_i2c_hal.h"
+#include "drivers/async_dac.h"
 #include "TeensyThreads.h"
 
 namespace drivers {
@@ -15,7 +16,7 @@ namespace drivers {
 class rob_tillaart_ad_5993r_async : public rob_tillaart_ad_5993r {
 public:
     // Async operation completion callback type
-    typedef void (*async_completion_callback_t)( bool success, dma_i2c_hal::error_code_t error, void* user_data );
+    typedef drivers::async_completion_callback_t async_completion_callback_t;
     
     // Async operation status
     enum class async_status_t : uint8_t {
@@ -65,15 +66,15 @@ private:
     
     // Helper functions
     void update_statistics( bool success, dma_i2c_hal::error_code_t error, uint32_t duration_us );
-    bool prepare_dac_write_buffer( const value_t values[], uint8_t num_channels );
+    uint8_t prepare_dac_write_buffer( const value_t values[], uint8_t num_channels );
     void set_async_status( async_status_t status );
 
 public:
     rob_tillaart_ad_5993r_async();
     virtual ~rob_tillaart_ad_5993r_async();
     
-    // Enhanced initialization with DMA support
-    void initialize_async( const initialization_struct_t& initialization_struct, 
+    // DMA on top of an attach()ed driver; no bus traffic, bring_up() stays with the worker
+    bool initialize_async( const initialization_struct_t& initialization_struct, 
                          uint8_t dma_channel = 0 );
     
     // Asynchronous operations (non-blocking)
@@ -81,6 +82,12 @@ public:
                                                async_completion_callback_t callback, 
                                                void* user_data = nullptr );
     
+    // DAC values and the gate pins in the same transfer
+    dma_i2c_hal::error_code_t set_frame_async( const value_t values[],
+                                              uint8_t gate_bits,
+                                              async_completion_callback_t callback,
+                                              void* user_data = nullptr );
+    
     dma_i2c_hal::error_code_t set_channel_value_async( uint8_t channel_index, 
                                                       value_t value,
                                                       async_completion_callback_t callback, 
@@ -90,6 +97,15 @@ public:
                                                                 async_completion_callback_t callback,
                                                                 void* user_data = nullptr );
     
+#ifdef MUPPET_COROUTINES
+    typedef async_frame_transfer< rob_tillaart_ad_5993r_async > frame_transfer;
+    
+    // co_await write_frame( values, gates, executor ) - DAC values and gates in one transfer
+    frame_transfer write_frame( const value_t values[], uint8_t gate_bits, muppet_executor& executor ) {
+        return frame_transfer( *this, values, gate_bits, executor );
+    }
+#endif
+    
     // Status and monitoring operations
     async_status_t get_async_status() const;
     bool is_async_operation_complete() const;
@@ -111,61 +127,12 @@ public:
     void disable_async_mode() { /* Falls back to sync operations */ }
     bool is_async_mode_available() const;
     
+    // Fault injection on this device's bus
+    void attach_fault_injector( i2c_fault_injector* injector, uint8_t bus_index ) { dma_hal_.set_fault_injector( injector, bus_index ); }
+    
     // Thread safety utilities
     bool try_lock_async_operation( uint32_t timeout_ms = 10 );
     void unlock_async_operation();
 };
 
-/**
- * @brief Thread-safe async operation manager for integration with electric_mayhem
- * 
- * Provides a higher-level interface for managing async DAC operations within
- * the Master of Muppets threading architecture.
- */
-class async_dac_manager {
-public:
-    // Operation completion state for thread communication
-    struct operation_state_t {
-        volatile bool operation_pending;
-        volatile bool operation_completed;
-        volatile dma_i2c_hal::error_code_t last_error;
-        volatile uint32_t completion_sequence;
-        Threads::Mutex state_mutex;
-        
-        operation_state_t() :
-            operation_pending( false ),
-            operation_completed( false ),
-            last_error( dma_i2c_hal::error_code_t::SUCCESS ),
-            completion_sequence( 0 )
-        {}
-    };
-
-private:
-    rob_tillaart_ad_5993r_async* async_driver_;
-    operation_state_t operation_state_;
-    uint32_t next_operation_sequence_;
-    
-    // Static callback for async driver completion
-    static void async_operation_callback( bool success, dma_i2c_hal::error_code_t error, void* user_data );
-    
-public:
-    async_dac_manager( rob_tillaart_ad_5993r_async* driver );
-    ~async_dac_manager();
-    
-    // High-level async operations for worker threads
-    bool initiate_async_update( const rob_tillaart_ad_5993r::value_t values[] );
-    bool is_operation_pending() const;
-    bool is_operation_completed() const;
-    uint32_t get_completion_sequence() const;
-    dma_i2c_hal::error_code_t get_operation_result();
-    
-    // Integration with muppet_state sequence tracking
-    bool check_and_clear_completion( uint32_t expected_sequence );
-    void reset_operation_state();
-    
-    // Error handling and recovery
-    bool has_operation_error() const;
-    void force_operation_completion(); // For error recovery
-};
-
 } // namespace drivers
\ No newline at end of file
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <cstdint>
+#include <AD5593R.h>
+
+namespace drivers {
+
+////////////////////////////////////////////////////////////////////////////////
+// shadowed_ad5593r
+// AD5593R with a write-through shadow of the config and GPIO registers. The
+// library reads a config register back over I2C before every read-modify-
+// write (write1, setDACRange2x, setExternalReference, ...); here the shadow
+// supplies the old value, so each change costs one write transaction.
+//
+// A register enters the shadow the first time it is written or read, which
+// during init is the device configuration itself. The shadow is dropped
+// whenever the device may have lost its state (reset, brown-out). Verify
+// mode reads every write back and resyncs the shadow on a mismatch.
+//
+// Only the hidden methods below keep the shadow in sync: go through this
+// type, not an AD5593R reference.
+////////////////////////////////////////////////////////////////////////////////
+
+class shadowed_ad5593r : public AD5593R {
+public:
+    const static uint8_t k_reg_adc_seq          = 0x02;
+    const static uint8_t k_reg_gen_ctrl         = 0x03;
+    const static uint8_t k_reg_adc_config       = 0x04;
+    const static uint8_t k_reg_dac_config       = 0x05;
+    const static uint8_t k_reg_pulldown_config  = 0x06;
+    const static uint8_t k_reg_ldac_mode        = 0x07;
+    const static uint8_t k_reg_gpio_config      = 0x08;
+    const static uint8_t k_reg_gpio_output      = 0x09;
+    const static uint8_t k_reg_gpio_input       = 0x0A;
+    const static uint8_t k_reg_powerdown_ref    = 0x0B;
+    const static uint8_t k_reg_opendrain_config = 0x0C;
+    const static uint8_t k_reg_io_ts_config     = 0x0D;
+    const static uint8_t k_shadowed_registers   = 0x10;
+
+    shadowed_ad5593r( const uint8_t device_address, TwoWire* wire = &Wire ) :
+        AD5593R(            device_address, wire ),
+        shadow_valid(       0               ),
+        verify(             false           ),
+        transactions_saved( 0               ),
+        verify_errors(      0               )
+    {
+        for ( uint8_t reg = 0; reg < k_shadowed_registers; ++reg ) {
+            shadow[ reg ] = 0;
+        }
+    }
+
+    // the device may have lost its config, the next access of each register goes to the bus
+    inline void invalidate_shadow( void ) { shadow_valid = 0; }
+
+    // a register written behind the shadow's back (DMA), the next access reads it again
+    inline void invalidate( uint8_t reg ) { if ( reg < k_shadowed_registers ) shadow_valid &= ~( 1 << reg ); }
+
+    inline void     verify_writes( bool enabled )              { verify = enabled;          }
+    inline bool     verifies_writes( void ) const              { return verify;             }
+    inline uint32_t how_many_transactions_saved( void ) const  { return transactions_saved; }
+    inline uint32_t how_many_verify_errors( void ) const       { return verify_errors;      }
+
+    // shadow aware versions of everything in AD5593R that touches a config register
+    int      setMode( const char config[ 9 ] );
+    int      setADCmode( uint8_t bitMask );
+    int      setDACmode( uint8_t bitMask );
+    int      setINPUTmode( uint8_t bitMask );
+    int      setOUTPUTmode( uint8_t bitMask );
+    int      setTHREESTATEmode( uint8_t bitMask );
+    int      setPULLDOWNmode( uint8_t bitMask );
+    int      setLDACmode( uint8_t mode );
+    int      setOpenDrainMode( uint8_t bitMask );
+
+    uint16_t write1( uint8_t pin, uint8_t value );
+    uint16_t write8( uint8_t bitMask );
+
+    int      setExternalReference( bool flag, float Vref );
+    int      setADCRange2x( bool flag );
+    int      setDACRange2x( bool flag );
+    int      enableADCBufferPreCharge( bool flag );
+    int      enableADCBuffer( bool flag );
+    int      enableIOLock( bool flag );
+    int      writeAllDacs( bool flag );
+
+    uint16_t readADC( uint8_t pin );
+    float    readTemperature( void );
+
+    // repeating ADC sequence over bitMask, each read_sequence() returns the next pin's conversion
+    int      start_sequence( uint8_t bitMask );
+    bool     read_sequence( uint8_t& pin, uint16_t& value );
+
+    int      powerDown( void );
+    int      wakeUp( void );
+    int      powerDownDac( uint8_t pin );
+    int      wakeUpDac( uint8_t pin );
+    int      reset( void );
+
+    int      writeRegister( uint8_t reg, uint16_t data );
+    uint16_t readConfigRegister( uint8_t reg );
+
+protected:
+    uint16_t shadow[ k_shadowed_registers ];
+    uint16_t shadow_valid;                      // one bit per register
+    bool     verify;
+    uint32_t transactions_saved;
+    uint32_t verify_errors;
+
+    inline bool shadowed( uint8_t reg ) const { return reg < k_shadowed_registers && ( shadow_valid & ( 1 << reg ) ); }
+
+    int update_bits( uint8_t reg, uint16_t set_mask, uint16_t clear_mask );
+};
+
+} // namespace drivers
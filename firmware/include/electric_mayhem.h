@@ -1,6 +1,10 @@
 #pragma once
 
 #include "dr_teeth.h"
+#include "muppet_health.h"
+#include "muppet_cv_input.h"
+#include "muppet_state_word.h"
+#include "muppet_latency_probe.h"
 #include "TeensyThreads.h"
 
 template < typename dac_driver_t > 
@@ -24,36 +28,48 @@ public:
     
     void put_muppet_to_work( uint8_t muppet_index );
 
+    // one pass of the muppet's worker, for the run-to-completion loop (no worker threads there)
+    void do_your_thing( uint8_t muppet_index ) { muppet_work( muppet_orientation_guides[ muppet_index ] ); }
+
+    const muppet_health&   how_are_you( uint8_t muppet_index ) const          { return muppet_states[ muppet_index ].health;   }
+    const muppet_cv_input& how_well_do_you_hear( uint8_t muppet_index ) const { return muppet_states[ muppet_index ].cv_input; }
+
 protected:
     /**
      * @brief Thread-safe state management for DAC workers
      */
     struct muppet_state {
-        volatile bool     update_requested;
-        volatile bool     update_in_progress;
-        volatile uint32_t update_sequence;
-        Threads::Mutex    state_mutex;
-        
-        muppet_state() : 
-            update_requested(  false ),
-            update_in_progress( false ),
-            update_sequence(   0     )
-        {}
+        muppet_state_word word;     // requested sequence + worker phase
+        muppet_health     health;
+        muppet_cv_input   cv_input;
     };
 
+    // everything a worker needs, and what it keeps from one pass to the next
     struct orientation_guide {
-        orientation_guide( void ) : muppet( 0 ), lock( 0 ), state( 0 ), output_buffer( 0 ) {}
-        orientation_guide( dac_driver_t& the_muppet, Threads::Mutex& the_lock, muppet_state& the_state, uint16_t* the_buffer ) :
-            muppet(        &the_muppet ),
-            lock(          &the_lock   ),
-            state(         &the_state  ),
-            output_buffer( the_buffer  )
+        orientation_guide( void ) : muppet( 0 ), lock( 0 ), state( 0 ), output_buffer( 0 ), output_gates( 0 ), cv_input( 0 ), muppet_index( 0 ), personal_gates_copy( 0 ), last_processed_sequence( 0 ) {}
+        orientation_guide( dac_driver_t& the_muppet, Threads::Mutex& the_lock, muppet_state& the_state, uint16_t* the_buffer, uint8_t* the_gates, volatile uint16_t* the_cv_input, uint8_t the_muppet_index ) :
+            muppet(                  &the_muppet       ),
+            lock(                    &the_lock         ),
+            state(                   &the_state        ),
+            output_buffer(           the_buffer        ),
+            output_gates(            the_gates         ),
+            cv_input(                the_cv_input      ),
+            muppet_index(            the_muppet_index  ),
+            personal_gates_copy(     0                 ),
+            last_processed_sequence( 0                 )
         { }
 
-        dac_driver_t*    muppet;
-        Threads::Mutex*  lock;
-        muppet_state*    state;
-        uint16_t*        output_buffer;
+        dac_driver_t*      muppet;
+        Threads::Mutex*    lock;
+        muppet_state*      state;
+        uint16_t*          output_buffer;
+        uint8_t*           output_gates;
+        volatile uint16_t* cv_input;
+        uint8_t            muppet_index;
+
+        uint16_t           personal_buffer_copy[ k_channels_per_dac ];
+        uint8_t            personal_gates_copy;
+        uint32_t           last_processed_sequence;
     };
 
 
@@ -62,55 +78,91 @@ protected:
     Threads::Mutex    muppet_lock[ dr_teeth::k_dac_count ];
     muppet_state      muppet_states[ dr_teeth::k_dac_count ];
 
+    // thread stacks live with the muppets, static instead of on the heap
+    alignas( THREADS_STACK_ALIGN ) uint8_t worker_stacks[ dr_teeth::k_dac_count ][ dr_teeth::k_worker_stack_bytes ];
+    alignas( THREADS_STACK_ALIGN ) uint8_t party_pooper_stack[ dr_teeth::k_party_pooper_stack_bytes ];
+
     inline bool valid_dac(     uint8_t muppet_index  ) { return muppet_index  < dr_teeth::k_dac_count; }
     inline bool valid_channel( uint8_t channel_index ) { return channel_index < k_channels_per_dac;    }
 
-    
+    static bool write_frame( dac_driver_t& me, uint16_t* frame, uint8_t gates, muppet_health& health ) {
+        me.enable( );
+        bool written = me.set_values( frame ) && me.set_gates( gates );
+        me.disable( );
 
-    static void muppet_worker( void* hidden_orientation_guide ) {
-        orientation_guide& muppet_orientation_guide = *reinterpret_cast< orientation_guide* >( hidden_orientation_guide );
-        
-        dac_driver_t&    me               = *muppet_orientation_guide.muppet;
-        Threads::Mutex&  my_lock          = *muppet_orientation_guide.lock;
-        muppet_state&    my_state         = *muppet_orientation_guide.state;
-        uint16_t*        my_output_buffer =  muppet_orientation_guide.output_buffer;
+        if ( written ) {
+            health.success( );
+        } else {
+            health.failure( millis( ) );
+        }
+        return written;
+    }
 
-        uint16_t         my_personal_buffer_copy[ k_channels_per_dac ];
-        uint32_t         last_processed_sequence = 0;
+    // one pass of a muppet's worker: re-probe, the newest frame, one CV input conversion
+    static void muppet_work( orientation_guide& muppet_orientation_guide ) {
+        dac_driver_t&      me                      = *muppet_orientation_guide.muppet;
+        Threads::Mutex&    my_lock                 = *muppet_orientation_guide.lock;
+        muppet_state&      my_state                = *muppet_orientation_guide.state;
+        uint16_t*          my_output_buffer        =  muppet_orientation_guide.output_buffer;
+        uint8_t*           my_output_gates         =  muppet_orientation_guide.output_gates;
+        volatile uint16_t* my_cv_input             =  muppet_orientation_guide.cv_input;
+        uint16_t*          my_personal_buffer_copy =  muppet_orientation_guide.personal_buffer_copy;
+        uint8_t&           my_personal_gates_copy  =  muppet_orientation_guide.personal_gates_copy;
+        uint32_t&          last_processed_sequence =  muppet_orientation_guide.last_processed_sequence;
+
+        // Booting or open circuit: the only bus traffic is an occasional probe, on this muppet's own
+        // worker; a device that answers gets the current frame straight away
+        uint32_t now_millis = millis( );
+        if ( my_state.health.bring_up( me, now_millis ) || my_state.health.reprobe( me, now_millis ) ) {
+            my_lock.lock();
+            memcpy( my_personal_buffer_copy, my_output_buffer, sizeof( uint16_t ) * k_channels_per_dac );
+            my_personal_gates_copy = *my_output_gates;
+            my_lock.unlock();
+
+            write_frame( me, my_personal_buffer_copy, my_personal_gates_copy, my_state.health );
+        }
+
+        // One CAS takes the newest requested sequence and marks the frame in progress
+        uint32_t current_sequence = 0;
+        bool     should_update    = my_state.word.try_begin( last_processed_sequence, muppet_state_word::k_in_progress, current_sequence );
         
-        while ( 1 ) {
-            // Check if update is requested using thread-safe synchronization
-            my_state.state_mutex.lock();
-            uint32_t current_sequence = my_state.update_sequence;
-            bool     should_update    = ( current_sequence != last_processed_sequence ) && 
-                                        !my_state.update_in_progress;
+        if ( should_update && !my_state.health.accepts_frames() ) {
+            // Nobody listening, drop the frame; the re-probe replays the latest one
+            last_processed_sequence = current_sequence;
+            should_update           = false;
+            my_state.word.retire( );
+        }
+        
+        if ( should_update ) {
+            // Copy data safely to local buffer
+            my_lock.lock();
+            memcpy( my_personal_buffer_copy, my_output_buffer, sizeof( uint16_t ) * k_channels_per_dac );
+            my_personal_gates_copy = *my_output_gates;
+            muppet_latency_probe::taken( muppet_orientation_guide.muppet_index );
+            my_lock.unlock();
             
-            if ( should_update ) {
-                my_state.update_in_progress = true;
-            }
-            my_state.state_mutex.unlock();
+            // Perform DAC operations
+            bool operation_successful = write_frame( me, my_personal_buffer_copy, my_personal_gates_copy, my_state.health );
             
-            if ( should_update ) {
-                // Copy data safely to local buffer
-                my_lock.lock();
-                memcpy( my_personal_buffer_copy, my_output_buffer, sizeof( uint16_t ) * k_channels_per_dac );
-                my_lock.unlock();
-                
-                // Perform DAC operations
-                bool operation_successful = true;
-                me.enable();
-                me.set_values( my_personal_buffer_copy );
-                me.disable();
-                
-                // Clear in-progress flag only after successful completion
-                my_state.state_mutex.lock();
-                if ( operation_successful ) {
-                    last_processed_sequence = current_sequence;
-                }
-                my_state.update_in_progress = false;
-                my_state.state_mutex.unlock();
+            // Clear in-progress flag only after successful completion
+            if ( operation_successful ) {
+                last_processed_sequence = current_sequence;
+                muppet_latency_probe::landed( muppet_orientation_guide.muppet_index );
             }
+            my_state.word.retire( );
+        }
+
+        // the ADC gets the gaps between frames, at most one conversion per pass
+        if ( my_state.health.accepts_frames( ) ) {
+            my_state.cv_input.listen( me, my_cv_input, micros( ), millis( ) );
+        }
+    }
 
+    static void muppet_worker( void* hidden_orientation_guide ) {
+        orientation_guide& muppet_orientation_guide = *reinterpret_cast< orientation_guide* >( hidden_orientation_guide );
+        
+        while ( 1 ) {
+            muppet_work( muppet_orientation_guide );
             threads.yield();
         }
     }
@@ -129,16 +181,22 @@ template < class dac_driver_t >
 void electric_mayhem< dac_driver_t >::initialize( const initialization_struct_t initialization_struct[ dr_teeth::k_dac_count ] ) {
     // Initialize muppet states with initial update request
     for ( uint8_t i = 0; i < dr_teeth::k_dac_count; ++i ) {
-        muppet_states[ i ].update_sequence = 1; // Request initial update
+        muppet_states[ i ].word.request( );
     }
     threads.setSliceMicros( dr_teeth::k_thread_slice_micros );
 
+    // no bus traffic here, the workers bring their devices up side by side
+    uint32_t now_millis = millis( );
     for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
-        muppets[ muppet_index ].initialize( initialization_struct[ muppet_index ] );
+        muppets[ muppet_index ].attach( initialization_struct[ muppet_index ] );
+        muppet_states[ muppet_index ].health.boot( now_millis );
         put_muppet_to_work( muppet_index );
     }
 
-    threads.addThread( party_pooper, this );
+    // run to completion: the event loop refreshes on its own timer
+    if constexpr ( !dr_teeth::k_run_to_completion ) {
+        threads.addThread( party_pooper, this, sizeof( party_pooper_stack ), party_pooper_stack );
+    }
 }
 
 template < class dac_driver_t >
@@ -161,9 +219,7 @@ void electric_mayhem< dac_driver_t >::throw_muppet_in_the_mud( uint8_t muppet_in
     if ( muppet_index >= dr_teeth::k_dac_count ) return;
     
     // Thread-safe update request using sequence increment
-    muppet_states[ muppet_index ].state_mutex.lock();
-    muppet_states[ muppet_index ].update_sequence++;
-    muppet_states[ muppet_index ].state_mutex.unlock();
+    muppet_states[ muppet_index ].word.request( );
 }
 
 template < class dac_driver_t >
@@ -179,8 +235,13 @@ void electric_mayhem< dac_driver_t >::put_muppet_to_work( uint8_t muppet_index )
         muppets[ muppet_index ], 
         muppet_lock[ muppet_index ], 
         muppet_states[ muppet_index ],
-        dr_teeth::output_buffer + muppet_index * k_channels_per_dac 
+        dr_teeth::output_buffer + muppet_index * k_channels_per_dac,
+        dr_teeth::output_gates  + muppet_index,
+        dr_teeth::cv_input_buffer + muppet_index * k_channels_per_dac,
+        muppet_index
     );
 
-    threads.addThread( muppet_worker, &muppet_orientation_guides[ muppet_index ] );
+    if constexpr ( !dr_teeth::k_run_to_completion ) {
+        threads.addThread( muppet_worker, &muppet_orientation_guides[ muppet_index ], sizeof( worker_stacks[ muppet_index ] ), worker_stacks[ muppet_index ] );
+    }
 }
\ No newline at end of file
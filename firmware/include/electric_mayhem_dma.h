@@ -1,9 +1,16 @@
 #pragma once
 
 #include "dr_teeth.h"
+#include "muppet_health.h"
+#include "muppet_cv_input.h"
+#include "transport_arbiter.h"
+#include "muppet_state_word.h"
+#include "muppet_coroutine.h"
+#include "muppet_latency_probe.h"
 #include "TeensyThreads.h"
-#include "drivers/rob_tillaart_ad_5993r_async.h"
-#include "drivers/rob_tillaart_ad_5993r.h"
+#include "drivers/async_dac.h"
+#include "drivers/i2c_fault_injector.h"
+#include "dma_error_handler.h"
 
 /**
  * @brief Enhanced electric_mayhem controller with DMA support
@@ -11,11 +18,16 @@
  * Extends the original electric_mayhem template class to support both synchronous
  * and asynchronous DMA-based DAC operations. Maintains backward compatibility
  * while providing significant performance improvements.
+ * 
+ * dac_driver_t is an async driver (rob_tillaart_ad_5993r_async, adafruit_mcp_4728_async):
+ * its synchronous base writes the frames until its DMA is up, and whenever the arbiter
+ * falls back; drivers/async_dac.h lists what else it has to provide.
  */
 template < typename dac_driver_t > 
 class electric_mayhem_dma {
 public:
     static const uint8_t k_channels_per_dac = dac_driver_t::k_channels;
+    static const uint8_t k_retry_count_cap  = 16;     // consecutive failed frames report_dma_result counts
     
     typedef typename dac_driver_t::value_t                  value_t;
     typedef typename dac_driver_t::initialization_struct_t  initialization_struct_t;
@@ -58,79 +70,132 @@ public:
     
     void put_muppet_to_work( uint8_t muppet_index );
     
+    // One pass of the muppet's worker, for the run-to-completion loop (no worker threads there)
+    void do_your_thing( uint8_t muppet_index ) { muppet_work_dma( muppet_orientation_guides_[ muppet_index ] ); }
+    
     // DMA-specific operations
     void set_dma_mode(dma_mode_t mode) { dma_mode_ = mode; }
     dma_mode_t get_dma_mode() const { return dma_mode_; }
     bool is_dma_available() const;
     
+    // False when the DMA frame coroutine does not fit a pool frame (-O0, a grown frame):
+    // every DMA frame then goes out synchronously
+    bool do_frames_fit() const { return frames_fit_; }
+    
     // Statistics and monitoring
     const dma_statistics_t& get_dma_statistics() const { return dma_stats_; }
     void reset_dma_statistics();
+    
+    // Error handling and fault injection
+    void attach_error_handler( dma_diagnostics::dma_error_handler* error_handler );
+    void attach_fault_injector( drivers::i2c_fault_injector* injector );
+    
+    // Frees the bus, re-inits the device and replays the current frame
+    bool recover_muppet( uint8_t muppet_index );
+    
+    // Per-device circuit breaker state
+    const muppet_health& how_are_you( uint8_t muppet_index ) const { return muppet_states_[ muppet_index ].health; }
+    
+    // Per-device CV input sampler and the rate it achieves
+    const muppet_cv_input& how_well_do_you_hear( uint8_t muppet_index ) const { return muppet_states_[ muppet_index ].cv_input; }
+    
+    // Per-device transport (DMA or sync) and its switch statistics
+    const transport_arbiter& which_transport( uint8_t muppet_index ) const { return muppet_states_[ muppet_index ].transport; }
 
 protected:
     /**
      * @brief Enhanced thread-safe state management with DMA support
      */
     struct muppet_state_dma {
-        // Original synchronization fields
-        volatile bool     update_requested;
-        volatile bool     update_in_progress;
-        volatile uint32_t update_sequence;
-        Threads::Mutex    state_mutex;
-        
-        // DMA-specific fields
-        volatile bool     dma_operation_pending;
-        volatile bool     dma_operation_completed;
-        volatile uint32_t dma_completion_sequence;
+        // Requested sequence plus the worker's phase (in progress / DMA pending)
+        muppet_state_word word;
+        
+        // DMA statistics, written by the worker only
         volatile uint32_t dma_error_count;
         volatile uint32_t last_dma_duration_us;
         
         // Async DAC manager for high-level DMA operations
-        drivers::async_dac_manager* async_manager;
+        drivers::async_dac_manager< dac_driver_t >* async_manager;
+        
+#ifdef MUPPET_COROUTINES
+        // Resumes this muppet's DMA frame once its transfer completed, on the worker's thread
+        muppet_executor   executor;
+#endif
+        
+        // Circuit breaker, only touched by the muppet's worker thread
+        muppet_health     health;
+        
+        // CV input sampler, fed between frames by the worker
+        muppet_cv_input   cv_input;
+        
+        // Which transport carries the frames, and which frame may still be committed
+        transport_arbiter transport;
         
         muppet_state_dma() : 
-            update_requested(false),
-            update_in_progress(false),
-            update_sequence(0),
-            dma_operation_pending(false),
-            dma_operation_completed(false),
-            dma_completion_sequence(0),
             dma_error_count(0),
             last_dma_duration_us(0),
             async_manager(nullptr)
         {}
     };
 
+    /**
+     * @brief Everything a worker needs, and what it keeps from one pass to the next
+     */
     struct orientation_guide_dma {
         orientation_guide_dma( void ) : 
-            muppet(nullptr), lock(nullptr), state(nullptr), output_buffer(nullptr), 
-            async_driver(nullptr), manager_instance(nullptr) {}
+            muppet(nullptr), lock(nullptr), state(nullptr), output_buffer(nullptr), output_gates(nullptr),
+            async_driver(nullptr), manager_instance(nullptr), muppet_index(0),
+            personal_gates_copy(0), last_processed_sequence(0), retry_count(0)
+#ifndef MUPPET_COROUTINES
+            , dma_sequence(0), operation_start_time(0)
+#endif
+        {}
             
         orientation_guide_dma( dac_driver_t& the_muppet, 
                               Threads::Mutex& the_lock, 
                               muppet_state_dma& the_state, 
                               uint16_t* the_buffer,
-                              drivers::rob_tillaart_ad_5993r_async* the_async_driver = nullptr ) :
+                              uint8_t* the_gates,
+                              dac_driver_t* the_async_driver = nullptr ) :
             muppet(&the_muppet),
             lock(&the_lock),
             state(&the_state),
             output_buffer(the_buffer),
+            output_gates(the_gates),
             async_driver(the_async_driver),
-            manager_instance(nullptr)
+            manager_instance(nullptr),
+            muppet_index(0),
+            personal_gates_copy(0),
+            last_processed_sequence(0),
+            retry_count(0)
+#ifndef MUPPET_COROUTINES
+            , dma_sequence(0), operation_start_time(0)
+#endif
         { }
 
         dac_driver_t*                                  muppet;
         Threads::Mutex*                               lock;
         muppet_state_dma*                             state;
         uint16_t*                                     output_buffer;
-        drivers::rob_tillaart_ad_5993r_async*         async_driver;
+        uint8_t*                                      output_gates;
+        dac_driver_t*                                 async_driver;       // the muppet itself, once its DMA is up
         electric_mayhem_dma<dac_driver_t>*            manager_instance;
+        uint8_t                                       muppet_index;
+        
+        uint16_t                                      personal_buffer_copy[ k_channels_per_dac ];
+        uint8_t                                       personal_gates_copy;
+        uint32_t                                      last_processed_sequence;
+        uint8_t                                       retry_count;
+#ifndef MUPPET_COROUTINES
+        uint32_t                                      dma_sequence;
+        uint32_t                                      operation_start_time;
+#endif
     };
 
     // Member variables
     dac_driver_t                                     muppets_[ dr_teeth::k_dac_count ];
-    drivers::rob_tillaart_ad_5993r_async*           async_muppets_[ dr_teeth::k_dac_count ];
-    drivers::async_dac_manager*                     async_managers_[ dr_teeth::k_dac_count ];
+    dac_driver_t*                                   async_muppets_[ dr_teeth::k_dac_count ];    // muppets_ with DMA up, else nullptr
+    drivers::async_dac_manager< dac_driver_t >      async_managers_[ dr_teeth::k_dac_count ];
     orientation_guide_dma                           muppet_orientation_guides_[ dr_teeth::k_dac_count ];
     Threads::Mutex                                  muppet_lock_[ dr_teeth::k_dac_count ];
     muppet_state_dma                                muppet_states_[ dr_teeth::k_dac_count ];
@@ -138,155 +203,352 @@ protected:
     dma_mode_t                                      dma_mode_;
     dma_statistics_t                                dma_stats_;
     Threads::Mutex                                  stats_mutex_;
+    dma_diagnostics::dma_error_handler*             error_handler_;
+    drivers::i2c_fault_injector*                    fault_injector_;    // also fails the synchronous writes
+    bool                                            frames_fit_;
+    
+    // Thread stacks live with the muppets, static instead of on the heap
+    alignas(THREADS_STACK_ALIGN) uint8_t            worker_stacks_[ dr_teeth::k_dac_count ][ dr_teeth::k_worker_stack_bytes ];
+    alignas(THREADS_STACK_ALIGN) uint8_t            party_pooper_stack_[ dr_teeth::k_party_pooper_stack_bytes ];
 
     inline bool valid_dac(     uint8_t muppet_index  ) { return muppet_index  < dr_teeth::k_dac_count; }
     inline bool valid_channel( uint8_t channel_index ) { return channel_index < k_channels_per_dac;    }
 
-    // Enhanced worker thread with DMA support
-    static void muppet_worker_dma( void* hidden_orientation_guide ) {
-        orientation_guide_dma& guide = *reinterpret_cast< orientation_guide_dma* >( hidden_orientation_guide );
+    static bool write_frame( orientation_guide_dma& guide, uint16_t* frame, uint8_t gates ) {
+        dac_driver_t&                       me      = *guide.muppet;
+        muppet_health&                      health  = guide.state->health;
+        electric_mayhem_dma<dac_driver_t>*  manager = guide.manager_instance;
+        drivers::i2c_fault_injector*        injector = manager ? manager->fault_injector_ : nullptr;
+        
+        // The synchronous writes get their share of the faults, not only the DMA transfers
+        drivers::i2c_fault_injector::fault_t fault = injector ? injector->next_fault(guide.muppet_index)
+                                                              : drivers::i2c_fault_injector::fault_t::NONE;
+        bool written = false;
+        if (fault == drivers::i2c_fault_injector::fault_t::NONE) {
+            me.enable();
+            written = me.set_values(frame) && me.set_gates(gates);
+            me.disable();
+        }
         
+        if (written) {
+            health.success();
+        } else {
+            health.failure(millis());
+        }
+        
+        if (injector) {
+            injector->on_transfer_result(guide.muppet_index, written ? drivers::dma_i2c_hal::error_code_t::SUCCESS
+                                                                     : drivers::dma_i2c_hal::error_code_t::DMA_ERROR);
+            if (fault != drivers::i2c_fault_injector::fault_t::NONE) {
+                // Recovered like the DMA ones; a stuck bus is only released by the peripheral reset
+                guide.retry_count = manager->report_dma_result(guide.muppet_index,
+                                                               drivers::i2c_fault_injector::error_for(fault),
+                                                               guide.retry_count);
+            }
+        }
+        return written;
+    }
+    
+    // One pass of a worker with DMA support: re-probe, completions, the newest frame, one CV input conversion
+    static void muppet_work_dma( orientation_guide_dma& guide ) {
         dac_driver_t&                                  me = *guide.muppet;
         Threads::Mutex&                               my_lock = *guide.lock;
         muppet_state_dma&                             my_state = *guide.state;
         uint16_t*                                     my_output_buffer = guide.output_buffer;
-        drivers::rob_tillaart_ad_5993r_async*         async_me = guide.async_driver;
+        uint8_t*                                      my_output_gates = guide.output_gates;
+        volatile uint16_t*                            my_cv_input = dr_teeth::cv_input_buffer + guide.muppet_index * k_channels_per_dac;
+        dac_driver_t*                                 async_me = guide.async_driver;
         electric_mayhem_dma<dac_driver_t>*            manager = guide.manager_instance;
-
-        uint16_t                                      my_personal_buffer_copy[ k_channels_per_dac ];
-        uint32_t                                      last_processed_sequence = 0;
-        uint32_t                                      operation_start_time = 0;
+        const uint8_t                                 my_index = guide.muppet_index;
+
+        uint16_t*                                     my_personal_buffer_copy = guide.personal_buffer_copy;
+        uint8_t&                                      my_personal_gates_copy = guide.personal_gates_copy;
+        uint32_t&                                     last_processed_sequence = guide.last_processed_sequence;
+        uint8_t&                                      retry_count = guide.retry_count;
+#ifndef MUPPET_COROUTINES
+        uint32_t&                                     dma_sequence = guide.dma_sequence;
+        uint32_t&                                     operation_start_time = guide.operation_start_time;
+#endif
         bool                                          use_dma = false;
         
-        while ( 1 ) {
-            // Check for pending DMA completion first
-            if (my_state.dma_operation_pending && async_me && my_state.async_manager) {
-                if (my_state.async_manager->is_operation_completed()) {
-                    // Handle DMA completion
-                    uint32_t completion_time = micros();
-                    uint32_t operation_duration = completion_time - operation_start_time;
-                    
-                    my_state.state_mutex.lock();
-                    my_state.dma_operation_pending = false;
-                    my_state.dma_operation_completed = true;
-                    my_state.last_dma_duration_us = operation_duration;
-                    my_state.update_in_progress = false;
-                    
-                    bool success = !my_state.async_manager->has_operation_error();
-                    if (success) {
-                        last_processed_sequence = my_state.update_sequence;
-                        my_state.dma_completion_sequence = last_processed_sequence;
-                    } else {
-                        my_state.dma_error_count++;
+        // Booting or open circuit: the only bus traffic is an occasional probe, on this muppet's own
+        // worker; a device that answers gets the current frame straight away
+        uint32_t now_millis = millis();
+        if (!my_state.word.is(muppet_state_word::k_pending) &&
+            (my_state.health.bring_up(me, now_millis) || my_state.health.reprobe(me, now_millis))) {
+            uint32_t probe_sequence = my_state.word.sequence();
+            
+            my_lock.lock();
+            memcpy(my_personal_buffer_copy, my_output_buffer, sizeof(uint16_t) * k_channels_per_dac);
+            my_personal_gates_copy = *my_output_gates;
+            my_lock.unlock();
+            
+            if (my_state.transport.claim(probe_sequence) && write_frame(guide, my_personal_buffer_copy, my_personal_gates_copy)) {
+                my_state.transport.commit(probe_sequence);
+            }
+        }
+        
+#ifdef MUPPET_COROUTINES
+        // A completed transfer resumes its frame right here, no completion flags to poll
+        my_state.executor.run();
+#else
+        // Check for pending DMA completion first
+        if (my_state.word.is(muppet_state_word::k_pending) && async_me && my_state.async_manager) {
+            if (my_state.async_manager->is_operation_completed()) {
+                // Handle DMA completion
+                uint32_t completion_time = micros();
+                uint32_t operation_duration = completion_time - operation_start_time;
+                my_state.last_dma_duration_us = operation_duration;
+                
+                bool success = !my_state.async_manager->has_operation_error();
+                if (success) {
+                    // Acknowledge the frame that was on the wire, not whatever arrived since;
+                    // a stale commit leaves the newer sequence pending, so it gets replayed
+                    my_state.transport.commit(dma_sequence);
+                    last_processed_sequence = dma_sequence;
+                    muppet_latency_probe::landed(my_index);
+                    my_state.health.success();
+                } else {
+                    my_state.dma_error_count = my_state.dma_error_count + 1;
+                    my_state.health.failure(millis());
+                }
+                
+                my_state.word.retire();
+                
+                // Update statistics
+                if (manager) {
+                    manager->update_dma_statistics(success, operation_duration);
+                    retry_count = manager->report_dma_result(my_index, my_state.async_manager->get_operation_result(), retry_count);
+                }
+                
+                // Clear the completion state for next operation
+                my_state.async_manager->reset_operation_state();
+            }
+        }
+#endif
+        
+        // A failed transfer's backoff holds the frames back; the requested sequence stays for later
+        bool backing_off = manager && manager->error_handler_ && !manager->error_handler_->may_retry(my_index, millis());
+        
+        // One CAS takes the newest requested sequence, unless a frame is still in flight
+        uint32_t current_sequence = 0;
+        bool should_update = !backing_off && my_state.word.try_begin(last_processed_sequence,
+                                                     muppet_state_word::k_in_progress | muppet_state_word::k_pending,
+                                                     current_sequence);
+        
+        if (should_update && !my_state.health.accepts_frames()) {
+            // Nobody listening, drop the frame; the re-probe replays the latest one
+            last_processed_sequence = current_sequence;
+            should_update = false;
+            my_state.word.retire();
+        }
+        
+        if (should_update && !my_state.transport.claim(current_sequence)) {
+            // A newer frame already went out on the other transport (recovery replay)
+            last_processed_sequence = current_sequence;
+            should_update = false;
+            my_state.word.retire();
+        }
+        
+        if (should_update) {
+            // The arbiter carries the error handler's fallback decision
+            use_dma = my_state.transport.uses_dma() &&
+#ifndef MUPPET_COROUTINES
+                     my_state.async_manager &&
+#endif
+                     async_me && 
+                     (manager && manager->get_dma_mode() != dma_mode_t::DISABLED) &&
+                     async_me->is_async_mode_available();
+            
+            // Copy data safely to local buffer (this part remains the same)
+            my_lock.lock();
+            memcpy(my_personal_buffer_copy, my_output_buffer, sizeof(uint16_t) * k_channels_per_dac);
+            my_personal_gates_copy = *my_output_gates;
+            muppet_latency_probe::taken(my_index);
+            my_lock.unlock();
+            
+#ifdef MUPPET_COROUTINES
+            if (use_dma) {
+                // Pending until the frame coroutine retires it
+                my_state.word.transition(muppet_state_word::k_in_progress, 0, muppet_state_word::k_pending, 0);
+                
+                if (!write_frame_dma(guide, my_personal_buffer_copy, my_personal_gates_copy, current_sequence,
+                                     last_processed_sequence, retry_count).started()) {
+                    // No coroutine frame to run it in (pool empty, or the frame outgrew it, see
+                    // do_frames_fit()): retrying would fail the same way, write it synchronously
+                    if (write_frame(guide, my_personal_buffer_copy, my_personal_gates_copy)) {
+                        my_state.transport.commit(current_sequence);
+                        last_processed_sequence = current_sequence;
+                        muppet_latency_probe::landed(my_index);
                     }
+                    my_state.word.retire();
                     
-                    my_state.state_mutex.unlock();
-                    
-                    // Update statistics
                     if (manager) {
-                        manager->update_dma_statistics(success, operation_duration);
+                        manager->increment_sync_fallback_count();
+                    }
+                }
+            } else {
+                bool operation_successful = write_frame(guide, my_personal_buffer_copy, my_personal_gates_copy);
+                
+                if (operation_successful) {
+                    my_state.transport.commit(current_sequence);
+                    last_processed_sequence = current_sequence;
+                    muppet_latency_probe::landed(my_index);
+                }
+                my_state.word.retire();
+                
+                if (manager) {
+                    manager->increment_sync_fallback_count();
+                    if (manager->error_handler_ && operation_successful) {
+                        manager->error_handler_->notify_success(my_index);
                     }
-                    
-                    // Clear the completion state for next operation
-                    my_state.async_manager->reset_operation_state();
                 }
             }
+#else
+            operation_start_time = micros();
+            bool operation_successful = false;
             
-            // Check if new update is requested using thread-safe synchronization
-            my_state.state_mutex.lock();
-            uint32_t current_sequence = my_state.update_sequence;
-            bool should_update = (current_sequence != last_processed_sequence) && 
-                                !my_state.update_in_progress &&
-                                !my_state.dma_operation_pending;
-            
-            if (should_update) {
-                my_state.update_in_progress = true;
-                // Determine if we should use DMA based on availability and mode
-                use_dma = async_me && my_state.async_manager && 
-                         (manager && manager->get_dma_mode() != dma_mode_t::DISABLED) &&
-                         async_me->is_async_mode_available();
-            }
-            my_state.state_mutex.unlock();
-            
-            if (should_update) {
-                // Copy data safely to local buffer (this part remains the same)
-                my_lock.lock();
-                memcpy(my_personal_buffer_copy, my_output_buffer, sizeof(uint16_t) * k_channels_per_dac);
-                my_lock.unlock();
+            if (use_dma) {
+                // Attempt DMA operation
+                me.enable();
                 
-                operation_start_time = micros();
-                bool operation_successful = false;
+                // Convert to value_t array for async driver
+                typename dac_driver_t::value_t async_values[k_channels_per_dac];
+                for (uint8_t i = 0; i < k_channels_per_dac; ++i) {
+                    async_values[i] = static_cast<typename dac_driver_t::value_t>(my_personal_buffer_copy[i]);
+                }
                 
-                if (use_dma) {
-                    // Attempt DMA operation
-                    me.enable();
-                    
-                    // Convert to value_t array for async driver
-                    typename dac_driver_t::value_t async_values[k_channels_per_dac];
-                    for (uint8_t i = 0; i < k_channels_per_dac; ++i) {
-                        async_values[i] = static_cast<typename dac_driver_t::value_t>(my_personal_buffer_copy[i]);
-                    }
-                    
-                    // Initiate async operation
-                    bool async_started = my_state.async_manager->initiate_async_update(async_values);
-                    
-                    if (async_started) {
-                        // DMA operation started successfully
-                        my_state.state_mutex.lock();
-                        my_state.dma_operation_pending = true;
-                        my_state.dma_operation_completed = false;
-                        my_state.state_mutex.unlock();
-                        
-                        operation_successful = true; // Will be validated on completion
-                        
-                        // Update statistics for DMA attempt
-                        if (manager) {
-                            manager->increment_dma_operation_count();
-                        }
-                    } else {
-                        // DMA failed to start, fall back to synchronous operation
-                        me.set_values(my_personal_buffer_copy);
-                        me.disable();
-                        operation_successful = true;
-                        
-                        // Update statistics for fallback
-                        if (manager) {
-                            manager->increment_sync_fallback_count();
-                        }
-                        
-                        // Clear in-progress flag immediately for sync operation
-                        my_state.state_mutex.lock();
-                        my_state.update_in_progress = false;
-                        last_processed_sequence = current_sequence;
-                        my_state.state_mutex.unlock();
-                    }
+                // Pending before the transfer starts, so its completion can't be missed
+                dma_sequence = current_sequence;
+                my_state.word.transition(muppet_state_word::k_in_progress, 0, muppet_state_word::k_pending, 0);
+                
+                // Initiate async operation
+                bool async_started = my_state.async_manager->initiate_async_update(async_values, my_personal_gates_copy);
+                
+                if (async_started) {
+                    operation_successful = true; // Will be validated and counted on completion
                 } else {
-                    // Use synchronous operation (original behavior)
-                    me.enable();
-                    me.set_values(my_personal_buffer_copy);
+                    // DMA failed to start, fall back to synchronous operation
                     me.disable();
-                    operation_successful = true;
+                    operation_successful = write_frame(guide, my_personal_buffer_copy, my_personal_gates_copy);
+                    
+                    // Update statistics for fallback
+                    if (manager) {
+                        manager->increment_sync_fallback_count();
+                    }
                     
-                    // Clear in-progress flag for sync operation
-                    my_state.state_mutex.lock();
                     if (operation_successful) {
+                        my_state.transport.commit(current_sequence);
                         last_processed_sequence = current_sequence;
+                        muppet_latency_probe::landed(my_index);
                     }
-                    my_state.update_in_progress = false;
-                    my_state.state_mutex.unlock();
-                    
-                    // Update statistics
-                    if (manager) {
-                        uint32_t sync_duration = micros() - operation_start_time;
-                        manager->increment_sync_fallback_count();
+                    my_state.word.retire();
+                }
+            } else {
+                // Use synchronous operation (original behavior)
+                operation_successful = write_frame(guide, my_personal_buffer_copy, my_personal_gates_copy);
+                
+                if (operation_successful) {
+                    my_state.transport.commit(current_sequence);
+                    last_processed_sequence = current_sequence;
+                    muppet_latency_probe::landed(my_index);
+                }
+                my_state.word.retire();
+                
+                // Update statistics
+                if (manager) {
+                    manager->increment_sync_fallback_count();
+                    if (manager->error_handler_ && operation_successful) {
+                        manager->error_handler_->notify_success(my_index);
                     }
                 }
             }
-
+#endif
+        }
+        
+        // The ADC shares the bus with the frames: one conversion at most, never under a DMA transfer
+        if (!my_state.word.is(muppet_state_word::k_pending) && my_state.health.accepts_frames()) {
+            my_state.cv_input.listen(me, my_cv_input, micros(), millis());
+        }
+    }
+    
+    static void muppet_worker_dma( void* hidden_orientation_guide ) {
+        orientation_guide_dma& guide = *reinterpret_cast< orientation_guide_dma* >( hidden_orientation_guide );
+        
+        while ( 1 ) {
+            muppet_work_dma( guide );
             threads.yield();
         }
     }
 
+#ifdef MUPPET_COROUTINES
+    /**
+     * @brief One DMA frame, start to completion, as straight-line code
+     *
+     * Started by the worker with the state word already pending; suspends for the
+     * transfer and is resumed by the worker's executor. The guide's fields it updates
+     * outlive it (guides live as long as the muppets), and values is only read before the first
+     * suspension, when the transfer copies it into the DMA buffer.
+     *
+     * Its frame size is only known to the compiler, so no static_assert can hold it against
+     * muppet_frame_pool::k_frame_bytes; initialize() probes it once instead (do_frames_fit()).
+     */
+    static muppet_task write_frame_dma( orientation_guide_dma& guide, uint16_t* values, uint8_t gates, uint32_t sequence,
+                                        uint32_t& last_processed_sequence, uint8_t& retry_count, bool probe = false ) {
+        // Boot check: the very same frame, allocated and freed, nothing else
+        if (probe) {
+            co_return;
+        }
+        
+        dac_driver_t&                       me       = *guide.muppet;
+        muppet_state_dma&                   my_state = *guide.state;
+        electric_mayhem_dma<dac_driver_t>*  manager  = guide.manager_instance;
+        uint32_t                            operation_start_time = micros();
+        
+        me.enable();
+        auto transfer = guide.async_driver->write_frame(values, gates, my_state.executor);
+        drivers::dma_i2c_hal::error_code_t result = co_await transfer;
+        me.disable();
+        
+        if (!transfer.started()) {
+            // DMA could not take it, write it synchronously instead
+            if (write_frame(guide, values, gates)) {
+                my_state.transport.commit(sequence);
+                last_processed_sequence = sequence;
+                muppet_latency_probe::landed(guide.muppet_index);
+            }
+            my_state.word.retire();
+            
+            if (manager) {
+                manager->increment_sync_fallback_count();
+            }
+            co_return;
+        }
+        
+        uint32_t operation_duration = micros() - operation_start_time;
+        my_state.last_dma_duration_us = operation_duration;
+        
+        bool success = (result == drivers::dma_i2c_hal::error_code_t::SUCCESS);
+        if (success) {
+            // A stale commit leaves the newer sequence pending, so it gets replayed
+            my_state.transport.commit(sequence);
+            last_processed_sequence = sequence;
+            muppet_latency_probe::landed(guide.muppet_index);
+            my_state.health.success();
+        } else {
+            my_state.dma_error_count = my_state.dma_error_count + 1;
+            my_state.health.failure(millis());
+        }
+        
+        my_state.word.retire();
+        
+        if (manager) {
+            manager->update_dma_statistics(success, operation_duration);
+            retry_count = manager->report_dma_result(guide.muppet_index, result, retry_count);
+        }
+    }
+#endif
+
     static void party_pooper( void* the_electric_mayhem_in_disguise ) {
         electric_mayhem_dma< dac_driver_t >& the_electric_mayhem = 
             *reinterpret_cast< electric_mayhem_dma< dac_driver_t >* >( the_electric_mayhem_in_disguise );
@@ -297,12 +559,16 @@ protected:
         }
     }
     
+    static bool peripheral_reset_callback( uint8_t muppet_index, void* the_electric_mayhem_in_disguise ) {
+        return reinterpret_cast< electric_mayhem_dma< dac_driver_t >* >( the_electric_mayhem_in_disguise )->recover_muppet( muppet_index );
+    }
+    
     // Statistics update methods
     void update_dma_statistics(bool success, uint32_t duration_us);
-    void increment_dma_operation_count();
+    uint8_t report_dma_result(uint8_t muppet_index, drivers::dma_i2c_hal::error_code_t result, uint8_t retry_count);
     void increment_sync_fallback_count();
     
-    // Template specialization for async driver initialization
+    // DMA for an attach()ed muppet, no bus traffic
     void initialize_async_driver(uint8_t muppet_index, const initialization_struct_t& init_struct, uint8_t dma_channel);
 };
 
@@ -310,12 +576,14 @@ protected:
 
 template < class dac_driver_t >
 electric_mayhem_dma< dac_driver_t >::electric_mayhem_dma(dma_mode_t mode) :
-    dma_mode_(mode)
+    dma_mode_(mode),
+    error_handler_(nullptr),
+    fault_injector_(nullptr),
+    frames_fit_(true)
 {
     // Initialize async driver pointers
     for (uint8_t i = 0; i < dr_teeth::k_dac_count; ++i) {
         async_muppets_[i] = nullptr;
-        async_managers_[i] = nullptr;
     }
 }
 
@@ -324,13 +592,21 @@ void electric_mayhem_dma< dac_driver_t >::initialize( const initialization_struc
                                                       const uint8_t dma_channels[ dr_teeth::k_dac_count ] ) {
     // Initialize muppet states with initial update request
     for ( uint8_t i = 0; i < dr_teeth::k_dac_count; ++i ) {
-        muppet_states_[ i ].update_sequence = 1; // Request initial update
+        muppet_states_[ i ].word.request();
     }
     threads.setSliceMicros( dr_teeth::k_thread_slice_micros );
 
+#ifdef MUPPET_COROUTINES
+    // Before any worker holds a frame, so only the size can make it fail
+    orientation_guide_dma& probe_guide = muppet_orientation_guides_[ 0 ];
+    frames_fit_ = write_frame_dma( probe_guide, nullptr, 0, 0, probe_guide.last_processed_sequence, probe_guide.retry_count, true ).started();
+#endif
+
+    // No bus traffic here, the workers bring their devices up side by side
+    uint32_t now_millis = millis();
     for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
-        // Initialize base synchronous driver
-        muppets_[ muppet_index ].initialize( initialization_struct[ muppet_index ] );
+        muppets_[ muppet_index ].attach( initialization_struct[ muppet_index ] );
+        muppet_states_[ muppet_index ].health.boot( now_millis );
         
         // Initialize DMA driver if requested and available
         if (dma_mode_ != dma_mode_t::DISABLED && dma_channels) {
@@ -340,7 +616,10 @@ void electric_mayhem_dma< dac_driver_t >::initialize( const initialization_struc
         put_muppet_to_work( muppet_index );
     }
 
-    threads.addThread( party_pooper, this );
+    // Run to completion: the event loop refreshes on its own timer
+    if constexpr ( !dr_teeth::k_run_to_completion ) {
+        threads.addThread( party_pooper, this, sizeof(party_pooper_stack_), party_pooper_stack_ );
+    }
 }
 
 template < class dac_driver_t >
@@ -363,9 +642,7 @@ void electric_mayhem_dma< dac_driver_t >::throw_muppet_in_the_mud( uint8_t muppe
     if ( muppet_index >= dr_teeth::k_dac_count ) return;
     
     // Thread-safe update request using sequence increment
-    muppet_states_[ muppet_index ].state_mutex.lock();
-    muppet_states_[ muppet_index ].update_sequence++;
-    muppet_states_[ muppet_index ].state_mutex.unlock();
+    muppet_states_[ muppet_index ].word.request();
 }
 
 template < class dac_driver_t >
@@ -382,12 +659,17 @@ void electric_mayhem_dma< dac_driver_t >::put_muppet_to_work( uint8_t muppet_ind
         muppet_lock_[ muppet_index ], 
         muppet_states_[ muppet_index ],
         dr_teeth::output_buffer + muppet_index * k_channels_per_dac,
+        dr_teeth::output_gates  + muppet_index,
         async_muppets_[ muppet_index ]
     );
     
     muppet_orientation_guides_[ muppet_index ].manager_instance = this;
+    muppet_orientation_guides_[ muppet_index ].muppet_index     = muppet_index;
 
-    threads.addThread( muppet_worker_dma, &muppet_orientation_guides_[ muppet_index ] );
+    if constexpr ( !dr_teeth::k_run_to_completion ) {
+        threads.addThread( muppet_worker_dma, &muppet_orientation_guides_[ muppet_index ],
+                           sizeof(worker_stacks_[ muppet_index ]), worker_stacks_[ muppet_index ] );
+    }
 }
 
 template < class dac_driver_t >
@@ -441,45 +723,126 @@ void electric_mayhem_dma< dac_driver_t >::update_dma_statistics(bool success, ui
 }
 
 template < class dac_driver_t >
-void electric_mayhem_dma< dac_driver_t >::increment_dma_operation_count() {
-    stats_mutex_.lock();
-    dma_stats_.total_dma_operations++;
-    stats_mutex_.unlock();
+uint8_t electric_mayhem_dma< dac_driver_t >::report_dma_result(uint8_t muppet_index,
+                                                               drivers::dma_i2c_hal::error_code_t result,
+                                                               uint8_t retry_count) {
+    if (!error_handler_) {
+        return 0;
+    }
+    
+    if (result == drivers::dma_i2c_hal::error_code_t::SUCCESS) {
+        error_handler_->notify_success(muppet_index);
+        return 0;
+    }
+    
+    // Failed frames are not acknowledged, so the worker picks the same sequence up again;
+    // the strategy only decides how long to back off or whether to drop to sync writes
+    dma_diagnostics::dma_error_handler::error_event_t event;
+    event.timestamp_us = micros();
+    event.error_code = result;
+    event.dac_index = muppet_index;
+    event.retry_count = retry_count;
+    event.recovery = error_handler_->handle_error(result, muppet_index, retry_count);
+    bool recovered = error_handler_->execute_recovery(event);
+    
+    if (recovered && event.recovery == dma_diagnostics::dma_error_handler::recovery_strategy_t::RESET_PERIPHERAL) {
+        return 0;
+    }
+    
+    // Capped: the strategies have escalated long before, and the backoff has hit its maximum
+    return (retry_count < k_retry_count_cap) ? retry_count + 1 : retry_count;
 }
 
 template < class dac_driver_t >
-void electric_mayhem_dma< dac_driver_t >::increment_sync_fallback_count() {
-    stats_mutex_.lock();
-    dma_stats_.fallback_to_sync_operations++;
-    stats_mutex_.unlock();
+void electric_mayhem_dma< dac_driver_t >::attach_error_handler(dma_diagnostics::dma_error_handler* error_handler) {
+    if (error_handler_ && error_handler_ != error_handler) {
+        error_handler_->set_peripheral_reset_callback(nullptr, nullptr);
+        for (uint8_t i = 0; i < dr_teeth::k_dac_count; ++i) {
+            error_handler_->attach_transport_arbiter(i, nullptr);
+        }
+    }
+    
+    error_handler_ = error_handler;
+    
+    if (error_handler_) {
+        error_handler_->set_peripheral_reset_callback(peripheral_reset_callback, this);
+        for (uint8_t i = 0; i < dr_teeth::k_dac_count; ++i) {
+            error_handler_->attach_transport_arbiter(i, &muppet_states_[i].transport);
+        }
+    }
 }
 
-// Template specialization for rob_tillaart_ad_5993r driver
-template<>
-void electric_mayhem_dma<drivers::rob_tillaart_ad_5993r>::initialize_async_driver(
-    uint8_t muppet_index, 
-    const drivers::rob_tillaart_ad_5993r::initialization_struct_t& init_struct, 
-    uint8_t dma_channel) {
+template < class dac_driver_t >
+bool electric_mayhem_dma< dac_driver_t >::recover_muppet(uint8_t muppet_index) {
+    if (!valid_dac(muppet_index)) {
+        return false;
+    }
+    
+    dac_driver_t& muppet = muppets_[ muppet_index ];
+    
+    if (!muppet.recover_bus()) {
+        return false;
+    }
+    
+    muppet.reinitialize();
     
-    // Create and initialize async version of rob_tillaart_ad_5993r
-    async_muppets_[muppet_index] = new drivers::rob_tillaart_ad_5993r_async();
-    async_muppets_[muppet_index]->initialize_async(init_struct, dma_channel);
+    // Replay the current frame so the outputs don't sit at whatever the glitch left.
+    // This runs on the DAC's own worker (report_dma_result picked RESET_PERIPHERAL for
+    // its failed frame), between frames, and still goes through the arbiter like any write
+    muppet_state_dma& state = muppet_states_[ muppet_index ];
+    uint32_t sequence = state.word.sequence();
     
-    // Create async manager
-    async_managers_[muppet_index] = new drivers::async_dac_manager(async_muppets_[muppet_index]);
-    muppet_states_[muppet_index].async_manager = async_managers_[muppet_index];
+    value_t frame[ k_channels_per_dac ];
+    muppet_lock_[ muppet_index ].lock();
+    memcpy(frame, dr_teeth::output_buffer + muppet_index * k_channels_per_dac, sizeof(value_t) * k_channels_per_dac);
+    uint8_t gates = dr_teeth::output_gates[ muppet_index ];
+    muppet_lock_[ muppet_index ].unlock();
+    
+    if (!state.transport.claim(sequence)) {
+        // The worker already has a newer frame out
+        return true;
+    }
+    
+    muppet.enable();
+    bool replayed = muppet.set_values(frame) && muppet.set_gates(gates);
+    muppet.disable();
+    
+    if (replayed) {
+        state.transport.commit(sequence);
+    }
+    return replayed;
+}
+
+template < class dac_driver_t >
+void electric_mayhem_dma< dac_driver_t >::attach_fault_injector(drivers::i2c_fault_injector* injector) {
+    fault_injector_ = injector;
+    for (uint8_t i = 0; i < dr_teeth::k_dac_count; ++i) {
+        if (async_muppets_[i]) {
+            async_muppets_[i]->attach_fault_injector(injector, i);
+        }
+    }
+}
+
+template < class dac_driver_t >
+void electric_mayhem_dma< dac_driver_t >::increment_sync_fallback_count() {
+    stats_mutex_.lock();
+    dma_stats_.fallback_to_sync_operations++;
+    stats_mutex_.unlock();
 }
 
-// Generic template implementation for drivers without async support
 template < class dac_driver_t >
 void electric_mayhem_dma< dac_driver_t >::initialize_async_driver(
     uint8_t muppet_index, 
-    const typename dac_driver_t::initialization_struct_t& init_struct, 
+    const initialization_struct_t& init_struct, 
     uint8_t dma_channel) {
     
-    // No async support available for this driver type
-    // DMA operations will automatically fall back to sync operations
-    async_muppets_[muppet_index] = nullptr;
-    async_managers_[muppet_index] = nullptr;
-    muppet_states_[muppet_index].async_manager = nullptr;
-}
\ No newline at end of file
+    // The muppet is its own async driver; without DMA it keeps writing synchronously
+    dac_driver_t& muppet = muppets_[muppet_index];
+    if (!muppet.initialize_async(init_struct, dma_channel)) {
+        return;
+    }
+    
+    async_muppets_[muppet_index] = &muppet;
+    async_managers_[muppet_index].attach(&muppet);
+    muppet_states_[muppet_index].async_manager = &async_managers_[muppet_index];
+}
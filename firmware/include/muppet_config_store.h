@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dr_teeth.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_config_store
+// Persistent key / value configuration, log structured in its own EEPROM
+// partition (the EEPROM emulation lives in program flash).
+//
+// The partition is two segments. The active one starts with a header (magic,
+// schema version, generation, CRC) followed by appended records; a record is
+// one key / value with its own CRC, and the last record of a transaction
+// carries k_flag_last. Boot replays the active segment into a RAM index and
+// applies only transactions that are complete and intact, so a commit torn by
+// a power cut simply never happened; get() is an array lookup from then on.
+//
+// When a transaction no longer fits, or the schema moved on, the index and
+// the transaction are written to the other segment as one image, its header
+// last: until that header is intact the old segment is the store.
+//
+// Updates never touch EEPROM in the caller's context: set() and commit() only
+// stage (any thread, a few instructions with interrupts off), and keep(), on
+// the idle thread, writes at most k_config_bytes_per_pass bytes per call, so
+// in the run-to-completion model keep() never holds the event loop for long.
+// The flash underneath is still programmed, and now and then erased, with
+// interrupts off (see muppet_frame_journal): while keep() writes, every
+// thread and timer can stall for that long, the real-time ones included.
+//
+// set() refuses values the board does not have (a bus, pin or DMA channel
+// past its last one), so a bad SysEx never makes it to the next boot.
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_config_store {
+public:
+    // schema: every key is one uint32_t, the per-device ones k_dac_count apart
+    static constexpr uint8_t  k_key_bus              = 0;                                   // 0 Wire, 1 Wire1, 2 Wire2
+    static constexpr uint8_t  k_key_select_pin       = k_key_bus        + dr_teeth::k_dac_count;
+    static constexpr uint8_t  k_key_dma_channel      = k_key_select_pin + dr_teeth::k_dac_count;
+    static constexpr uint8_t  k_key_count            = k_key_dma_channel + dr_teeth::k_dac_count;
+    static constexpr uint16_t k_schema_version       = 1;
+    static_assert( k_key_count <= 32, "staged keys are one 32 bit mask" );
+
+    // what the board has
+    static constexpr uint32_t k_bus_count            = 3;       // Wire, Wire1, Wire2
+    static constexpr uint32_t k_pin_count            = 55;      // Teensy 4.1, pins 0 .. 54
+    static constexpr uint32_t k_dma_channel_count    = 32;
+
+    muppet_config_store( void );
+
+    // boot: replays the active segment into the index, migrating an older schema
+    void load( void );
+
+    // index lookup, fallback when the key was never set
+    uint32_t get( uint8_t key, uint32_t fallback ) const;
+    bool     has( uint8_t key ) const { return key < k_key_count && ( present & ( 1UL << key ) ); }
+
+    static bool is_valid( uint8_t key, uint32_t value );
+
+    // any context: stage a change, false for an unknown key or a value the board does not have;
+    // commit() hands everything staged to keep() as one transaction, false while the previous one
+    // is still being written
+    bool set( uint8_t key, uint32_t value );
+    bool commit( void );
+
+    // idle thread: moves a committed transaction to EEPROM, a few bytes per call
+    void keep( void );
+
+    inline bool     is_writing( void ) const           { return span_count != 0;   }
+    inline uint32_t how_many_commits( void ) const     { return commits;           }
+    inline uint32_t how_many_compactions( void ) const { return compactions;       }
+    inline uint32_t what_generation( void ) const      { return generation;        }
+
+protected:
+    static constexpr uint32_t k_magic                = 0x4D4F4D43;     // "MOMC"
+    static constexpr uint8_t  k_flag_last            = 0x01;
+    static constexpr uint8_t  k_blank                = 0xFF;
+
+    struct header_t {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t reserved;
+        uint32_t generation;
+        uint32_t crc;
+    };
+
+    struct record_t {
+        uint8_t  key;
+        uint8_t  flags;
+        uint16_t transaction;   // records of one commit share it
+        uint32_t value;
+        uint32_t crc;
+    };
+
+    // what keep() is writing: an address range and its bytes, nullptr for blank
+    struct span_t {
+        int            address;
+        uint16_t       length;
+        const uint8_t* data;
+    };
+
+    static constexpr int k_segment_bytes = ( dr_teeth::k_config_eeprom_end - dr_teeth::k_config_eeprom_base ) / 2;
+    static constexpr int k_image_bytes   = sizeof( header_t ) + k_key_count * sizeof( record_t );
+    static_assert( dr_teeth::k_config_eeprom_base >= dr_teeth::k_journal_eeprom_end, "the config store overlaps the frame journal" );
+    static_assert( k_segment_bytes >= 2 * k_image_bytes, "a segment must hold a compacted image and a transaction" );
+
+    // the index
+    uint32_t          values[ k_key_count ];
+    uint32_t          present;
+
+    // staged by set(), committed by commit(), written by keep()
+    uint32_t          staged_values[ k_key_count ];
+    volatile uint32_t staged;
+    uint32_t          outbox_values[ k_key_count ];
+    volatile uint32_t outbox;
+
+    // the log
+    uint8_t           active_segment;
+    bool              has_header;
+    uint16_t          version;
+    uint32_t          generation;
+    int               write_offset;     // inside the active segment
+    uint16_t          transaction;      // last one in the active segment
+
+    // the write in progress
+    uint8_t           image[ k_image_bytes ];
+    span_t            spans[ 4 ];
+    uint8_t           span_count;
+    uint8_t           span_index;
+    uint16_t          span_offset;
+    bool              compacting;
+    uint8_t           image_records;
+
+    uint32_t          commits;
+    uint32_t          compactions;
+
+    void start_append( void );
+    void start_compaction( void );
+    void finish( void );
+    void migrate( uint16_t from_version );
+
+    bool read_segment( uint8_t segment, header_t& header ) const;
+    void replay( uint8_t segment );
+
+    static int      segment_address( uint8_t segment ) { return dr_teeth::k_config_eeprom_base + segment * k_segment_bytes; }
+    static uint32_t crc_of( const header_t& header );
+    static uint32_t crc_of( const record_t& record );
+    static void     read_bytes( int address, void* destination, int length );
+};
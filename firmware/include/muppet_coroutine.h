@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "dr_teeth.h"
+
+/**
+ * @brief Coroutine support for the asynchronous DAC path
+ *
+ * Available when the compiler implements C++20 coroutines (-std=gnu++20 -fcoroutines),
+ * unless MUPPET_NO_COROUTINES is defined; MUPPET_COROUTINES tells the rest of the tree.
+ * Without it the workers keep the callback / completion-flag path.
+ *
+ * Nothing here touches the hardware, so the same executor drives coroutines on the host.
+ */
+#if defined(__cpp_impl_coroutine) && !defined(MUPPET_NO_COROUTINES)
+#define MUPPET_COROUTINES
+#endif
+
+#ifdef MUPPET_COROUTINES
+
+#include <coroutine>
+
+/**
+ * @brief Single-threaded executor, one per worker
+ *
+ * Completion handlers (an interrupt, the HAL worker) only schedule() the coroutine they
+ * finished; the owning thread resumes it from run(). Coroutine bodies therefore never run
+ * in interrupt context, and a completion that fires before the coroutine has finished
+ * suspending is harmless: it is not resumed before the owner's next run().
+ *
+ * The ready set is a handful of atomic slots, claimed with a compare-and-swap, so
+ * schedule() is lock-free and safe from any context.
+ */
+class muppet_executor {
+public:
+    static const uint8_t k_capacity = 4;    // in-flight operations per owner, a worker has one
+
+    muppet_executor() : overflows_(0) {
+        for (uint8_t i = 0; i < k_capacity; ++i) {
+            ready_[i].store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    // Any context: hand a suspended coroutine to the owner. False (and counted) when full
+    bool schedule(std::coroutine_handle<> handle) {
+        void* address = handle.address();
+        for (uint8_t i = 0; i < k_capacity; ++i) {
+            void* expected = nullptr;
+            if (ready_[i].compare_exchange_strong(expected, address, std::memory_order_acq_rel)) {
+                return true;
+            }
+        }
+        overflows_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    // Owner only: resumes whatever became ready; returns how many ran
+    uint8_t run() {
+        uint8_t resumed = 0;
+        for (uint8_t i = 0; i < k_capacity; ++i) {
+            void* address = ready_[i].exchange(nullptr, std::memory_order_acq_rel);
+            if (address) {
+                std::coroutine_handle<>::from_address(address).resume();
+                ++resumed;
+            }
+        }
+        return resumed;
+    }
+
+    // Host side: resume until nothing is left ready (tests, simulations)
+    uint32_t run_until_idle() {
+        uint32_t total = 0;
+        for (uint8_t resumed = run(); resumed; resumed = run()) {
+            total += resumed;
+        }
+        return total;
+    }
+
+    uint32_t get_overflows() const { return overflows_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<void*>    ready_[k_capacity];
+    std::atomic<uint32_t> overflows_;
+};
+
+/**
+ * @brief Fixed pool for coroutine frames, so no coroutine ever touches the heap
+ *
+ * One frame per device is enough: a worker has at most one transfer in flight.
+ * A request that does not fit, or finds the pool empty, gets nullptr and the coroutine
+ * is simply not created (see muppet_task::started()).
+ */
+class muppet_frame_pool {
+public:
+    static const std::size_t k_frame_bytes = 256;
+    static const uint8_t     k_frames      = dr_teeth::k_dac_count;
+    static_assert(k_frames <= 32, "the pool bitmap is 32 bits");
+
+    static void* allocate(std::size_t size) noexcept {
+        if (size > k_frame_bytes) {
+            return nullptr;
+        }
+
+        uint32_t used = used_.load(std::memory_order_relaxed);
+        uint8_t  frame;
+        do {
+            uint32_t free_frames = ~used & k_all_frames;
+            if (!free_frames) {
+                return nullptr;
+            }
+            frame = __builtin_ctz(free_frames);
+        } while (!used_.compare_exchange_weak(used, used | (1UL << frame), std::memory_order_acq_rel));
+
+        return frames_[frame];
+    }
+
+    static void release(void* address) noexcept {
+        uint8_t frame = (static_cast<uint8_t*>(address) - &frames_[0][0]) / k_frame_bytes;
+        used_.fetch_and(~(1UL << frame), std::memory_order_acq_rel);
+    }
+
+private:
+    static const uint32_t k_all_frames = (k_frames == 32) ? 0xFFFFFFFF : ((1UL << k_frames) - 1);
+
+    alignas(8) static inline uint8_t      frames_[k_frames][k_frame_bytes];
+    static inline std::atomic<uint32_t>   used_{0};
+};
+
+/**
+ * @brief Fire-and-forget coroutine with a pooled frame
+ *
+ * Runs eagerly up to its first suspension and frees its frame when the body returns;
+ * whoever resumes it (the executor) does not need to keep a handle.
+ */
+class muppet_task {
+public:
+    struct promise_type {
+        static void* operator new(std::size_t size) noexcept { return muppet_frame_pool::allocate(size); }
+        static void  operator delete(void* frame) noexcept  { muppet_frame_pool::release(frame); }
+        static muppet_task get_return_object_on_allocation_failure() noexcept { return muppet_task(false); }
+
+        muppet_task get_return_object() noexcept { return muppet_task(true); }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept {}  // built without exceptions
+    };
+
+    // False when there was no frame for it: the body never ran
+    bool started() const { return started_; }
+
+private:
+    explicit muppet_task(bool started) : started_(started) {}
+
+    bool started_;
+};
+
+#endif // MUPPET_COROUTINES
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_crc
+// CRC-32 (IEEE 802.3, reflected) for whatever goes to non-volatile memory.
+// A nibble table keeps it at 64 bytes; records are small and rarely checked,
+// two table lookups per byte are plenty. Chain calls by passing the previous
+// result back in as crc.
+////////////////////////////////////////////////////////////////////////////////
+
+struct muppet_crc {
+    static uint32_t crc32( const void* data, size_t length, uint32_t crc = 0 ) {
+        static constexpr uint32_t k_nibble_table[ 16 ] = {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+
+        const uint8_t* bytes = static_cast< const uint8_t* >( data );
+
+        crc = ~crc;
+        for ( size_t index = 0; index < length; ++index ) {
+            crc = k_nibble_table[ ( crc ^ bytes[ index ]        ) & 0x0F ] ^ ( crc >> 4 );
+            crc = k_nibble_table[ ( crc ^ ( bytes[ index ] >> 4 ) ) & 0x0F ] ^ ( crc >> 4 );
+        }
+        return ~crc;
+    }
+};
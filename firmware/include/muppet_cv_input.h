@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dr_teeth.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_cv_input
+// Per-device CV input sampler, run by the muppet's worker between frames so
+// the ADC shares the bus schedule with the outputs instead of competing for
+// it. Each call takes at most one conversion of the device's running ADC
+// sequence, and only once k_cv_input_every_micros have passed since the last
+// one; the achieved rate is measured over one second windows.
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_cv_input {
+public:
+    static constexpr uint32_t k_rate_window_millis = 1000;
+
+    muppet_cv_input( void ) :
+        next_sample_micros(  0 ),
+        window_start_millis( 0 ),
+        window_samples(      0 ),
+        samples_per_second(  0 ),
+        samples(             0 ),
+        errors(              0 )
+    { }
+
+    inline uint32_t how_many_samples_per_second( void ) const { return samples_per_second; }
+    inline uint32_t how_many_samples( void ) const            { return samples;            }
+    inline uint32_t how_many_errors( void ) const             { return errors;             }
+
+    // true when a conversion landed in cv_input (the device's slice of dr_teeth::cv_input_buffer)
+    template < typename dac_driver_t >
+    bool listen( dac_driver_t& muppet, volatile uint16_t* cv_input, uint32_t now_micros, uint32_t now_millis ) {
+        if ( !dr_teeth::k_cv_input_mask || static_cast< int32_t >( now_micros - next_sample_micros ) < 0 ) {
+            return false;
+        }
+        next_sample_micros = now_micros + dr_teeth::k_cv_input_every_micros;
+
+        uint8_t                          channel_index = 0;
+        typename dac_driver_t::value_t   value         = 0;
+
+        muppet.enable( );
+        bool sampled = muppet.read_cv_input( channel_index, value );
+        muppet.disable( );
+
+        if ( sampled ) {
+            cv_input[ channel_index ] = value;
+            ++window_samples;
+            ++samples;
+        } else {
+            ++errors;
+        }
+
+        uint32_t window_millis = now_millis - window_start_millis;
+        if ( window_millis >= k_rate_window_millis ) {
+            samples_per_second  = window_samples * 1000 / window_millis;
+            window_samples      = 0;
+            window_start_millis = now_millis;
+        }
+
+        return sampled;
+    }
+
+protected:
+    uint32_t          next_sample_micros;
+    uint32_t          window_start_millis;
+    uint32_t          window_samples;
+    volatile uint32_t samples_per_second;
+    uint32_t          samples;
+    uint32_t          errors;
+};
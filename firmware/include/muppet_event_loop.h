@@ -0,0 +1,121 @@
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_event_loop
+// Run-to-completion alternative to the threads (dr_teeth::k_run_to_completion).
+// An event is a handler and its priority, which is its number: 0 goes first.
+// Interrupts, timers and other handlers post() events; run() takes the most
+// urgent pending one and runs it to the end before looking again, so handlers
+// never preempt each other and need no locks between themselves. Periodic
+// events post themselves from run(), off micros().
+//
+// The loop counts the cycles spent in handlers over one second windows, which
+// gives its CPU use, and the longest run of every event, which bounds how long
+// a more urgent one can be kept waiting.
+////////////////////////////////////////////////////////////////////////////////
+
+template < uint8_t k_events >
+class muppet_event_loop {
+public:
+    typedef void ( *handler_t )( void* context );
+    static_assert( k_events <= 32, "pending events are one 32 bit word" );
+
+    muppet_event_loop( void ) :
+        pending(             0 ),
+        window_start_cycles( 0 ),
+        window_busy_cycles(  0 ),
+        busy_permille(       0 )
+    { }
+
+    // every_micros 0: the event only runs when posted
+    void on( uint8_t event, handler_t handler, void* context, uint32_t every_micros = 0 ) {
+        if ( event >= k_events ) {
+            return;
+        }
+
+        events[ event ].handler      = handler;
+        events[ event ].context      = context;
+        events[ event ].every_micros = every_micros;
+        events[ event ].due_micros   = micros( ) + every_micros;
+    }
+
+    // any context, interrupts included
+    inline void post( uint8_t event ) { pending.fetch_or( 1UL << event, std::memory_order_release ); }
+
+    // runs the most urgent pending event, false when there was nothing to do
+    bool run( void ) {
+        uint32_t now_micros = micros( );
+        for ( uint8_t event = 0; event < k_events; ++event ) {
+            event_t& periodic = events[ event ];
+            if ( !periodic.every_micros || static_cast< int32_t >( now_micros - periodic.due_micros ) < 0 ) {
+                continue;
+            }
+
+            // a late loop skips the missed periods instead of running them back to back
+            periodic.due_micros += periodic.every_micros;
+            if ( static_cast< int32_t >( now_micros - periodic.due_micros ) >= 0 ) {
+                periodic.due_micros = now_micros + periodic.every_micros;
+            }
+            post( event );
+        }
+
+        uint32_t ready = pending.load( std::memory_order_acquire );
+        if ( !ready ) {
+            account( ARM_DWT_CYCCNT, 0 );
+            return false;
+        }
+
+        uint8_t event = __builtin_ctz( ready );
+        pending.fetch_and( ~( 1UL << event ), std::memory_order_acq_rel );
+
+        uint32_t start_cycles = ARM_DWT_CYCCNT;
+        if ( events[ event ].handler ) {
+            events[ event ].handler( events[ event ].context );
+        }
+        uint32_t run_cycles = ARM_DWT_CYCCNT - start_cycles;
+
+        if ( run_cycles > events[ event ].max_cycles ) {
+            events[ event ].max_cycles = run_cycles;
+        }
+        ++events[ event ].runs;
+        account( start_cycles + run_cycles, run_cycles );
+        return true;
+    }
+
+    inline uint16_t how_busy_permille( void ) const          { return busy_permille;              }
+    inline uint32_t how_many_runs( uint8_t event ) const     { return events[ event ].runs;       }
+    inline uint32_t how_long_at_most( uint8_t event ) const  { return events[ event ].max_cycles; }
+
+protected:
+    struct event_t {
+        event_t( void ) : handler( nullptr ), context( nullptr ), every_micros( 0 ), due_micros( 0 ), runs( 0 ), max_cycles( 0 ) {}
+
+        handler_t handler;
+        void*     context;
+        uint32_t  every_micros;
+        uint32_t  due_micros;
+        uint32_t  runs;
+        uint32_t  max_cycles;
+    };
+
+    event_t                 events[ k_events ];
+    std::atomic< uint32_t > pending;
+    uint32_t                window_start_cycles;
+    uint32_t                window_busy_cycles;
+    volatile uint16_t       busy_permille;
+
+    void account( uint32_t now_cycles, uint32_t busy_cycles ) {
+        window_busy_cycles += busy_cycles;
+
+        uint32_t window_cycles = now_cycles - window_start_cycles;
+        if ( window_cycles >= F_CPU_ACTUAL ) {     // one second, at whatever clock we run
+            busy_permille       = static_cast< uint16_t >( static_cast< uint64_t >( window_busy_cycles ) * 1000 / window_cycles );
+            window_busy_cycles  = 0;
+            window_start_cycles = now_cycles;
+        }
+    }
+};
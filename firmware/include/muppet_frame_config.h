@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "dr_teeth.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_frame_config
+// Everything the show reads to turn the input into the devices' frames, per
+// output channel: which input it follows (routing), the quantizer step it is
+// rounded to (0 passes through) and its calibration, gain then offset. It
+// also holds the modulator settings muppet_modulation evaluates: the routes,
+// as a packed struct of arrays, and the LFOs', envelopes' and random sources'
+// parameters.
+//
+// Instances are the snapshots of a muppet_snapshot_exchange: once published
+// they are never written again, so build() reads them without locks. The
+// writer calls settle() on its draft before publishing, which is what lets
+// the identity configuration keep the plain copy.
+////////////////////////////////////////////////////////////////////////////////
+
+struct muppet_frame_config {
+    static constexpr int32_t k_unity_gain = 1 << 16;     // gains are 16.16 fixed point
+
+    // modulation sources, by route source index
+    static constexpr uint8_t k_midi_source      = 0;                                                // + channel, the host's value
+    static constexpr uint8_t k_cv_input_source  = k_midi_source     + dr_teeth::k_total_channels;   // + channel
+    static constexpr uint8_t k_lfo_source       = k_cv_input_source + dr_teeth::k_total_channels;   // + LFO
+    static constexpr uint8_t k_envelope_source  = k_lfo_source      + dr_teeth::k_lfo_count;        // + envelope
+    static constexpr uint8_t k_random_source    = k_envelope_source + dr_teeth::k_envelope_count;   // + random
+    static constexpr uint8_t k_source_count     = k_random_source   + dr_teeth::k_random_count;
+
+    enum lfo_shape : uint8_t {
+        k_lfo_sine = 0,
+        k_lfo_triangle,
+        k_lfo_square,
+        k_lfo_sawtooth,
+        k_lfo_shape_count
+    };
+
+    enum random_mode : uint8_t {
+        k_random_white = 0,
+        k_random_sample_and_hold,                           // clocked by note on, or every random_hold_millis
+        k_random_walk,                                      // smoothed
+        k_random_pink,
+        k_random_brown,
+        k_random_mode_count
+    };
+
+    uint8_t  routing[       dr_teeth::k_total_channels ];   // output channel <- input channel
+    uint16_t quantize_step[ dr_teeth::k_total_channels ];   // framework units
+    int32_t  gain[          dr_teeth::k_total_channels ];
+    int32_t  offset[        dr_teeth::k_total_channels ];   // framework units, after the gain
+    bool     identity;
+
+    // routes [ 0, modulation_route_count ), one (source, destination) pair each
+    uint8_t  modulation_sources[      dr_teeth::k_modulation_routes ];
+    uint8_t  modulation_destinations[ dr_teeth::k_modulation_routes ];
+    int16_t  modulation_depths[       dr_teeth::k_modulation_routes ];  // Q15, full depth swings full scale
+    uint8_t  modulation_route_count;
+
+    uint16_t lfo_centihertz[          dr_teeth::k_lfo_count ];
+    uint8_t  lfo_shapes[              dr_teeth::k_lfo_count ];
+    uint16_t envelope_attack_millis[  dr_teeth::k_envelope_count ];
+    uint16_t envelope_release_millis[ dr_teeth::k_envelope_count ];
+    uint8_t  random_modes[            dr_teeth::k_random_count ];
+    uint16_t random_hold_millis[      dr_teeth::k_random_count ];       // 0 holds until the next note on
+
+    muppet_frame_config( void ) {
+        for ( uint8_t channel_index = 0; channel_index < dr_teeth::k_total_channels; ++channel_index ) {
+            routing[       channel_index ] = channel_index;
+            quantize_step[ channel_index ] = 0;
+            gain[          channel_index ] = k_unity_gain;
+            offset[        channel_index ] = 0;
+        }
+        identity = true;
+
+        modulation_route_count = 0;
+        for ( uint8_t lfo_index = 0; lfo_index < dr_teeth::k_lfo_count; ++lfo_index ) {
+            lfo_centihertz[ lfo_index ] = 100;
+            lfo_shapes[     lfo_index ] = k_lfo_sine;
+        }
+        for ( uint8_t envelope_index = 0; envelope_index < dr_teeth::k_envelope_count; ++envelope_index ) {
+            envelope_attack_millis[  envelope_index ] = 10;
+            envelope_release_millis[ envelope_index ] = 200;
+        }
+        for ( uint8_t random_index = 0; random_index < dr_teeth::k_random_count; ++random_index ) {
+            random_modes[       random_index ] = k_random_sample_and_hold;
+            random_hold_millis[ random_index ] = 0;
+        }
+    }
+
+    // writer side: adds, changes or (depth 0) removes the route, false when it does not fit
+    bool set_route( uint8_t source, uint8_t destination, int16_t depth ) {
+        if ( source >= k_source_count || destination >= dr_teeth::k_total_channels ) {
+            return false;
+        }
+
+        uint8_t route = 0;
+        while ( route < modulation_route_count && ( modulation_sources[ route ] != source || modulation_destinations[ route ] != destination ) ) {
+            ++route;
+        }
+
+        if ( depth == 0 ) {
+            // the last route fills the gap, the arrays stay packed
+            if ( route < modulation_route_count ) {
+                --modulation_route_count;
+                modulation_sources[      route ] = modulation_sources[      modulation_route_count ];
+                modulation_destinations[ route ] = modulation_destinations[ modulation_route_count ];
+                modulation_depths[       route ] = modulation_depths[       modulation_route_count ];
+            }
+            return true;
+        }
+
+        if ( route == modulation_route_count ) {
+            if ( modulation_route_count == dr_teeth::k_modulation_routes ) {
+                return false;
+            }
+            ++modulation_route_count;
+        }
+
+        modulation_sources[      route ] = source;
+        modulation_destinations[ route ] = destination;
+        modulation_depths[       route ] = depth;
+        return true;
+    }
+
+    // writer side, after the last edit
+    void settle( void ) {
+        identity = true;
+        for ( uint8_t channel_index = 0; channel_index < dr_teeth::k_total_channels; ++channel_index ) {
+            identity = identity &&
+                routing[       channel_index ] == channel_index &&
+                quantize_step[ channel_index ] == 0 &&
+                gain[          channel_index ] == k_unity_gain &&
+                offset[        channel_index ] == 0;
+        }
+    }
+
+    // the output channels starting_channel .. starting_channel + count from the whole input, plus
+    // the modulation (muppet_modulation::what_offsets, nullptr for none) before the quantizer
+    void build( uint16_t* output, const uint16_t* input, const int32_t* modulation, uint8_t starting_channel, uint8_t count ) const {
+        if ( identity && !modulation ) {
+            memcpy( output, &input[ starting_channel ], sizeof( uint16_t ) * count );
+            return;
+        }
+
+        for ( uint8_t index = 0; index < count; ++index ) {
+            uint8_t channel_index = starting_channel + index;
+            int32_t value         = input[ routing[ channel_index ] ];
+
+            if ( modulation ) {
+                value += modulation[ channel_index ];
+                value  = value < 0 ? 0 : value > dr_teeth::k_max_value ? dr_teeth::k_max_value : value;
+            }
+
+            uint16_t step = quantize_step[ channel_index ];
+            if ( step ) {
+                value = ( value + step / 2 ) / step * step;
+            }
+
+            int64_t calibrated = ( static_cast< int64_t >( value ) * gain[ channel_index ] >> 16 ) + offset[ channel_index ];
+            output[ index ] = calibrated < 0 ? 0 : calibrated > dr_teeth::k_max_value ? dr_teeth::k_max_value : static_cast< uint16_t >( calibrated );
+        }
+    }
+};
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "dr_teeth.h"
+#include "muppet_frame_config.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_frame_journal
+// Keeps the last output frame across power cycles, so the CVs come back where
+// they were instead of at 0 V until the host sends every channel again.
+//
+// The frame goes to a ring of k_journal_slots EEPROM records, each with its
+// own sequence number and CRC; every write takes the next slot, so the wear
+// spreads over the ring (on top of the EEPROM emulation's own) and a write
+// cut short by a brown-out only loses that record. restore() picks the
+// intact record with the highest sequence.
+//
+// Writes are batched and rate limited: a changed frame is written once it
+// held still for k_journal_settle_millis, or kept changing for
+// k_journal_max_lag_millis, and never twice within k_journal_every_millis.
+// An EEPROM write is a flash program, and now and then a sector erase, run
+// from RAM with interrupts off: for as long as it takes every thread stops,
+// the PIT deadlines (triggers, the event loop's timers) fire late and so does
+// the DMA completion ISR. A word program is microseconds, an erase tens of
+// milliseconds. keep() belongs to the idle thread (loop()) so the wait for it
+// is nobody else's, but the stall itself is everyone's; how_long_at_most()
+// is the longest single EEPROM write keep() has seen, in cycles, which bounds
+// the interrupts-off time from above.
+//
+// Gates are not journaled: notes are the host's business, and a gate stuck
+// open after a power cycle is worse than one closed.
+//
+// The journal also keeps the frame config's routing, quantizer and
+// calibration, the part of it that is wiring rather than patch: the writer
+// hands over every config it publishes and keep() writes it at its next
+// check, alternating between two slots of its own partition the same way.
+// restore_calibration() puts the newest one into the show's first snapshot.
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_frame_journal {
+public:
+    static constexpr uint8_t  k_slots      = dr_teeth::k_journal_slots;
+    static constexpr uint32_t k_version    = 1;     // bump when the record changes meaning
+
+    muppet_frame_journal( void );
+
+    // boot, before the muppets start: the newest intact frame becomes the input and the output
+    bool restore( void );
+
+    // boot, before the show starts: the newest intact routing and calibration into config (the
+    // first snapshot's draft), false when none was ever kept
+    bool restore_calibration( muppet_frame_config& config );
+
+    // frame config writer, after a publish: config's routing and calibration, written by keep()
+    void keep_calibration( const muppet_frame_config& config );
+
+    // idle thread: looks at the frame the workers are writing and journals it when due
+    template < typename T >
+    void keep( T& muppets, uint32_t now_millis ) {
+        if ( now_millis - checked_at_millis < dr_teeth::k_journal_check_every_millis ) {
+            return;
+        }
+        checked_at_millis = now_millis;
+
+        uint16_t frame[ dr_teeth::k_total_channels ];
+        for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
+            uint8_t starting_channel = muppet_index * dr_teeth::k_channels_per_dac;
+
+            muppets.hey_you( muppet_index );
+            memcpy( &frame[ starting_channel ], &dr_teeth::output_buffer[ starting_channel ], sizeof( uint16_t ) * dr_teeth::k_channels_per_dac );
+            muppets.thanks( muppet_index );
+        }
+
+        consider( frame, now_millis );
+        write_calibration( );
+    }
+
+    inline uint32_t how_many_writes( void ) const    { return writes;   }
+    inline uint32_t what_sequence( void ) const      { return sequence; }
+    inline bool     was_restored( void ) const       { return restored; }
+    inline uint32_t how_long_at_most( void ) const   { return max_update_cycles; }
+    inline uint32_t how_many_calibration_writes( void ) const { return calibration_writes; }
+
+protected:
+    struct record_t {
+        uint32_t sequence;
+        uint16_t frame[ dr_teeth::k_total_channels ];
+        uint32_t crc;                                   // over everything above, seeded with k_version
+    };
+
+    struct calibration_record_t {
+        uint32_t sequence;
+        uint8_t  routing[       dr_teeth::k_total_channels ];
+        uint16_t quantize_step[ dr_teeth::k_total_channels ];
+        int32_t  gain[          dr_teeth::k_total_channels ];
+        int32_t  offset[        dr_teeth::k_total_channels ];
+        uint32_t crc;                                   // over everything above, seeded with k_version
+    };
+
+    static constexpr int k_record_bytes = sizeof( record_t );
+    static_assert( dr_teeth::k_journal_eeprom_base + k_slots * k_record_bytes <= dr_teeth::k_journal_eeprom_end, "the journal outgrew its EEPROM partition" );
+
+    static constexpr uint8_t k_calibration_slots        = 2;
+    static constexpr int     k_calibration_record_bytes = sizeof( calibration_record_t );
+    static_assert( dr_teeth::k_calibration_eeprom_base >= dr_teeth::k_preset_eeprom_end, "the calibration overlaps the presets" );
+    static_assert( dr_teeth::k_calibration_eeprom_base + k_calibration_slots * k_calibration_record_bytes <= dr_teeth::k_calibration_eeprom_end, "the calibration outgrew its EEPROM partition" );
+
+    uint16_t pending[ dr_teeth::k_total_channels ];     // newest frame seen
+    uint16_t saved[   dr_teeth::k_total_channels ];     // what the newest record holds
+    bool     dirty;
+    bool     restored;
+    uint8_t  next_slot;
+    uint32_t sequence;
+    uint32_t checked_at_millis;
+    uint32_t changed_at_millis;
+    uint32_t dirty_since_millis;
+    uint32_t written_at_millis;
+    uint32_t writes;
+    uint32_t max_update_cycles;
+
+    calibration_record_t calibration;                   // staged by keep_calibration(), crc and sequence by keep()
+    bool                 calibration_dirty;             // both only change with interrupts off
+    uint8_t              calibration_slot;
+    uint32_t             calibration_sequence;
+    uint32_t             calibration_writes;
+
+    void consider( const uint16_t* frame, uint32_t now_millis );
+    void write( uint32_t now_millis );
+    void write_calibration( void );
+
+    static bool read_slot(  uint8_t slot, record_t& record );
+    static bool read_slot(  uint8_t slot, calibration_record_t& record );
+    void        write_slot( uint8_t slot, const record_t& record );
+    void        write_slot( uint8_t slot, const calibration_record_t& record );
+    void        write_bytes( int address, const uint8_t* bytes, int length );
+    void        update( int address, uint8_t value );
+    static void read_bytes( int address, uint8_t* bytes, int length );
+    static uint32_t crc_of( const record_t& record );
+    static uint32_t crc_of( const calibration_record_t& record );
+};
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cstdint>
+
+#include "dr_teeth.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_health
+// Per-device circuit breaker. A device that keeps failing stops receiving
+// frames and is only probed every k_reprobe_every_millis until it answers.
+// Boot goes through it too: every device is brought up by its own worker,
+// one attempt every k_boot_probe_delay_millis, so the buses come up in
+// parallel and a missing device only costs its own bus. Whatever is not up
+// k_boot_deadline_millis after boot() is left to the re-probe.
+//
+//   BOOTING  -> HEALTHY   device answered and got its config
+//   BOOTING  -> OPEN      boot deadline passed
+//   HEALTHY  -> DEGRADED  first failure
+//   DEGRADED -> HEALTHY   any success
+//   DEGRADED -> OPEN      k_failures_to_open_circuit failures in a row
+//   OPEN     -> PROBING   re-probe interval expired
+//   PROBING  -> HEALTHY   device answered and took the current frame
+//   PROBING  -> OPEN      still nobody home
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_health {
+public:
+    enum class state_t : uint8_t {
+        HEALTHY = 0,
+        DEGRADED,
+        OPEN,
+        PROBING,
+        BOOTING
+    };
+
+    muppet_health( void ) :
+        state(                state_t::BOOTING ),
+        consecutive_failures( 0                ),
+        opened_at_millis(     0                ),
+        booted_at_millis(     0                ),
+        attempted_at_millis(  0                ),
+        first_frame_micros(   0                ),
+        trips(                0                ),
+        recoveries(           0                )
+    { }
+
+    inline state_t  what_state( void ) const         { return state;      }
+    inline uint32_t how_many_trips( void ) const     { return trips;      }
+    inline uint32_t how_many_comebacks( void ) const { return recoveries; }
+
+    // boot to the first frame on the device, in micros since reset; 0 while there is none
+    inline uint32_t how_long_to_first_frame( void ) const { return first_frame_micros; }
+
+    // cheap check for the frame path, an open device is skipped entirely
+    inline bool accepts_frames( void ) const { return state == state_t::HEALTHY || state == state_t::DEGRADED; }
+
+    bool probe_due( uint32_t now_millis ) {
+        if ( state != state_t::OPEN || now_millis - opened_at_millis < dr_teeth::k_reprobe_every_millis ) {
+            return false;
+        }
+
+        state = state_t::PROBING;
+        return true;
+    }
+
+    // a frame went through
+    void success( void ) {
+        if ( state == state_t::PROBING ) {
+            ++recoveries;
+        }
+
+        if ( !first_frame_micros ) {
+            first_frame_micros = micros( );
+        }
+
+        state                = state_t::HEALTHY;
+        consecutive_failures = 0;
+    }
+
+    void failure( uint32_t now_millis ) {
+        if ( consecutive_failures < UINT8_MAX ) {
+            ++consecutive_failures;
+        }
+
+        if ( state == state_t::PROBING || consecutive_failures >= dr_teeth::k_failures_to_open_circuit ) {
+            trip( now_millis );
+        } else {
+            state = state_t::DEGRADED;
+        }
+    }
+
+    void trip( uint32_t now_millis ) {
+        if ( state != state_t::OPEN && state != state_t::PROBING ) {
+            ++trips;
+        }
+
+        state            = state_t::OPEN;
+        opened_at_millis = now_millis;
+    }
+
+    // the device's bus is set up, the worker brings it up from now on
+    void boot( uint32_t now_millis ) {
+        state               = state_t::BOOTING;
+        booted_at_millis    = now_millis;
+        attempted_at_millis = now_millis - dr_teeth::k_boot_probe_delay_millis;
+    }
+
+    // true when the device just came up; the caller writes the current frame and reports the outcome
+    template < typename dac_driver_t >
+    bool bring_up( dac_driver_t& muppet, uint32_t now_millis ) {
+        if ( state != state_t::BOOTING || now_millis - attempted_at_millis < dr_teeth::k_boot_probe_delay_millis ) {
+            return false;
+        }
+        attempted_at_millis = now_millis;
+
+        if ( muppet.bring_up( ) ) {
+            state = state_t::HEALTHY;
+            return true;
+        }
+
+        if ( now_millis - booted_at_millis >= dr_teeth::k_boot_deadline_millis ) {
+            trip( now_millis );
+        }
+        return false;
+    }
+
+    // true when the device answered the probe and got its config back;
+    // the caller replays the current frame and reports the outcome
+    template < typename dac_driver_t >
+    bool reprobe( dac_driver_t& muppet, uint32_t now_millis ) {
+        if ( !probe_due( now_millis ) ) {
+            return false;
+        }
+
+        if ( !muppet.probe( ) ) {
+            failure( now_millis );
+            return false;
+        }
+
+        muppet.reinitialize( );
+        return true;
+    }
+
+protected:
+    volatile state_t  state;
+    uint8_t           consecutive_failures;
+    uint32_t          opened_at_millis;
+    uint32_t          booted_at_millis;
+    uint32_t          attempted_at_millis;
+    uint32_t          first_frame_micros;
+    uint32_t          trips;
+    uint32_t          recoveries;
+};
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <Arduino.h>
+#include <cmath>
+#include <cstdint>
+
+#include "dr_teeth.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_latency_probe
+// Input-to-DAC latency, the benchmark for the execution models. With
+// dr_teeth::k_latency_probe on, the voice changes channel 0 of every device
+// each k_latency_probe_every_micros (stimulus). The cycle stamp follows the
+// value through the show (copied) and the device's worker (taken), and is
+// measured once the frame carrying it is on the device (landed). A newer
+// stimulus replaces a stamp still on its way, the same as the frame does.
+//
+// Every stage has a single writer per device, so nothing here locks: the
+// worker owns its statistics, report() only asks it to start over.
+// Everything compiles away with the probe off.
+////////////////////////////////////////////////////////////////////////////////
+
+struct muppet_latency_probe {
+    struct statistics_t {
+        statistics_t( void ) : samples( 0 ), min_cycles( UINT32_MAX ), max_cycles( 0 ), sum_cycles( 0 ), sum_squared_cycles( 0 ) {}
+
+        uint32_t samples;
+        uint32_t min_cycles;
+        uint32_t max_cycles;
+        uint64_t sum_cycles;
+        uint64_t sum_squared_cycles;
+    };
+
+    // voice: moves the probe channels when due, true when it did
+    static bool stimulus( uint32_t now_micros ) {
+        if constexpr ( dr_teeth::k_latency_probe ) {
+            if ( static_cast< int32_t >( now_micros - next_stimulus_micros ) < 0 ) {
+                return false;
+            }
+            next_stimulus_micros = now_micros + dr_teeth::k_latency_probe_every_micros;
+
+            // a full scale step, so no frame ever carries the same value twice in a row
+            uint16_t value = dr_teeth::input_buffer[ 0 ] == 0 ? dr_teeth::k_max_value : 0;
+            uint32_t stamp = ARM_DWT_CYCCNT | 1;    // 0 means no stamp
+            for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
+                dr_teeth::input_buffer[ muppet_index * dr_teeth::k_channels_per_dac ] = value;
+                stimulus_stamps[ muppet_index ] = stamp;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    // show: the input went into the device's output buffer
+    static inline void copied( uint8_t muppet_index ) {
+        if constexpr ( dr_teeth::k_latency_probe ) {
+            copied_stamps[ muppet_index ] = stimulus_stamps[ muppet_index ];
+        }
+    }
+
+    // worker: the output buffer went into the frame it is about to write
+    static inline void taken( uint8_t muppet_index ) {
+        if constexpr ( dr_teeth::k_latency_probe ) {
+            if ( copied_stamps[ muppet_index ] != taken_stamps[ muppet_index ] ) {
+                taken_stamps[ muppet_index ]     = copied_stamps[ muppet_index ];
+                in_flight_stamps[ muppet_index ] = copied_stamps[ muppet_index ];
+            }
+        }
+    }
+
+    // worker: that frame is on the device
+    static void landed( uint8_t muppet_index ) {
+        if constexpr ( dr_teeth::k_latency_probe ) {
+            statistics_t& stats = statistics[ muppet_index ];
+            if ( restart[ muppet_index ] ) {
+                stats                    = statistics_t( );
+                restart[ muppet_index ]  = false;
+            }
+
+            uint32_t stamp = in_flight_stamps[ muppet_index ];
+            if ( !stamp ) {
+                return;
+            }
+            in_flight_stamps[ muppet_index ] = 0;
+
+            uint32_t latency_cycles = ARM_DWT_CYCCNT - stamp;
+            ++stats.samples;
+            stats.min_cycles          = min( stats.min_cycles, latency_cycles );
+            stats.max_cycles          = max( stats.max_cycles, latency_cycles );
+            stats.sum_cycles         += latency_cycles;
+            stats.sum_squared_cycles += static_cast< uint64_t >( latency_cycles ) * latency_cycles;
+        }
+    }
+
+    // one line per device: latency min / avg / max, jitter as the standard deviation, all in
+    // microseconds, and the CPU the execution model used over the last second
+    static void report( Print& out, const char* model, uint16_t cpu_permille ) {
+        if constexpr ( dr_teeth::k_latency_probe ) {
+            float cycles_per_micro = F_CPU_ACTUAL / 1000000.0f;
+
+            for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
+                statistics_t stats = statistics[ muppet_index ];
+                restart[ muppet_index ] = true;
+
+                out.print( "latency [" );
+                out.print( model );
+                out.print( "] DAC " );
+                out.print( muppet_index );
+                out.print( ": " );
+                out.print( stats.samples );
+
+                if ( stats.samples ) {
+                    float mean     = static_cast< float >( stats.sum_cycles ) / stats.samples;
+                    float variance = static_cast< float >( stats.sum_squared_cycles ) / stats.samples - mean * mean;
+
+                    out.print( " frames, min/avg/max " );
+                    out.print( stats.min_cycles / cycles_per_micro, 1 );
+                    out.print( " / " );
+                    out.print( mean / cycles_per_micro, 1 );
+                    out.print( " / " );
+                    out.print( stats.max_cycles / cycles_per_micro, 1 );
+                    out.print( " us, jitter " );
+                    out.print( sqrtf( variance > 0.0f ? variance : 0.0f ) / cycles_per_micro, 1 );
+                    out.print( " us" );
+                } else {
+                    out.print( " frames" );
+                }
+
+                out.print( ", cpu " );
+                out.print( cpu_permille / 10.0f, 1 );
+                out.println( "%" );
+            }
+        }
+    }
+
+protected:
+    static uint32_t          next_stimulus_micros;
+    static volatile uint32_t stimulus_stamps[  dr_teeth::k_dac_count ];
+    static volatile uint32_t copied_stamps[    dr_teeth::k_dac_count ];
+    static uint32_t          taken_stamps[     dr_teeth::k_dac_count ];
+    static uint32_t          in_flight_stamps[ dr_teeth::k_dac_count ];
+    static statistics_t      statistics[       dr_teeth::k_dac_count ];
+    static volatile bool     restart[          dr_teeth::k_dac_count ];
+};
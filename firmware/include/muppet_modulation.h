@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dr_teeth.h"
+#include "function_generator.h"
+#include "random_generator.h"
+#include "muppet_frame_config.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_modulation
+// The modulation matrix: every control tick each route of the frame config
+// adds source * depth to its destination's offset, which the show adds to
+// the input before quantizing (muppet_frame_config::build).
+//
+// Sources are Q15: the host's value and the CV inputs unipolar, the LFOs
+// bipolar, the envelopes (attack while the note is held, release after it)
+// unipolar, the random sources bipolar. A tick walks the packed route arrays
+// once and only evaluates the LFOs some route reads, so its cost follows the
+// number of routes, not sources times destinations. The LFOs run on
+// function_generator's integer phase, one add per tick and no fmod; the
+// envelopes advance
+// while they move. The random sources cost the same every tick: one block of
+// k_random_count white samples from random_generator, then each source's
+// mode (white, sample and hold, smoothed walk, pink, brown) over its sample.
+// The cycles per tick are kept for the status report.
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_modulation {
+public:
+    muppet_modulation( void );
+
+    // note on / off on MIDI channel channel_index + 1: the envelope's gate, a note on also clocks
+    // the sample and hold random source with that index
+    void gate( uint8_t channel_index, bool open );
+
+    // one control tick once k_modulation_tick_micros have passed, true when the offsets changed
+    bool tick( const muppet_frame_config& config, const uint16_t* input, const volatile uint16_t* cv_input, uint32_t now_micros );
+
+    // per output channel offsets in framework units, nullptr while no route is live
+    inline const int32_t* what_offsets( void ) const { return live ? offsets : nullptr; }
+
+    inline uint8_t  how_many_routes( void ) const   { return routes;      }
+    inline uint32_t how_many_ticks( void ) const    { return ticks;       }
+    inline uint32_t how_long_last( void ) const     { return last_cycles; }
+    inline uint32_t how_long_at_most( void ) const  { return max_cycles;  }
+
+protected:
+    static constexpr int32_t k_full_scale  = 32767;
+    static constexpr float   k_tick_hertz  = 1000000.0f / dr_teeth::k_modulation_tick_micros;
+
+    int32_t            offsets[ dr_teeth::k_total_channels ];
+    int32_t            sums[    dr_teeth::k_total_channels ];
+    uint32_t           live;                                        // destinations with a route
+
+    function_generator lfos[           dr_teeth::k_lfo_count ];
+    uint16_t           lfo_centihertz[ dr_teeth::k_lfo_count ];     // what lfos are set to
+    uint32_t           lfo_phases[     dr_teeth::k_lfo_count ];     // a full cycle is 2^32
+    uint32_t           lfo_steps[      dr_teeth::k_lfo_count ];     // phase per tick
+    int16_t            lfo_values[     dr_teeth::k_lfo_count ];
+    uint32_t           lfo_ready;                                   // evaluated this tick
+
+    int32_t            envelope_levels[ dr_teeth::k_envelope_count ];
+    uint32_t           envelope_open;
+    uint32_t           envelope_moving;
+
+    random_generator               randoms;
+    int16_t                        random_values[  dr_teeth::k_random_count ];
+    int32_t                        random_walks[   dr_teeth::k_random_count ];
+    random_generator::pink_state   random_pinks[   dr_teeth::k_random_count ];
+    int32_t                        random_browns[  dr_teeth::k_random_count ];
+    uint32_t                       random_held[    dr_teeth::k_random_count ];   // ticks since the last sample
+    uint32_t                       random_clocked;                               // note ons since the last tick
+
+    uint8_t            routes;
+    uint32_t           ticks;
+    uint32_t           last_cycles;
+    uint32_t           max_cycles;
+    uint32_t           next_tick_micros;
+
+    void    advance( const muppet_frame_config& config );
+    void    advance_randoms( const muppet_frame_config& config );
+    int32_t source_value( const muppet_frame_config& config, uint8_t source, const uint16_t* input, const volatile uint16_t* cv_input );
+};
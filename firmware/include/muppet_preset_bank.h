@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dr_teeth.h"
+#include "muppet_frame_config.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_preset_bank
+// k_preset_count patches, each a whole input frame plus the modulation half
+// of the frame config (routes, LFOs, envelopes and random sources; routing
+// and calibration are wiring and stay out). Every patch is an EEPROM record
+// with its own CRC in the presets' partition, all of them cached in RAM by
+// load() at boot. recall() is a pointer into the cache, so a program change
+// costs no flash access at all.
+//
+// store() only updates the cache and marks the preset dirty; keep(), on the
+// idle thread, writes one dirty preset per call. Records are rewritten in
+// place: a write cut short loses that preset (its CRC fails at the next
+// boot), never another one.
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_preset_bank {
+public:
+    static constexpr uint8_t  k_presets = dr_teeth::k_preset_count;
+    static constexpr uint32_t k_version = 2;     // bump when the record changes meaning
+    static_assert( k_presets <= 32, "dirty and stored presets are one 32 bit mask each" );
+
+    struct record_t {
+        uint16_t frame[                   dr_teeth::k_total_channels ];
+        int16_t  modulation_depths[       dr_teeth::k_modulation_routes ];
+        uint16_t lfo_centihertz[          dr_teeth::k_lfo_count ];
+        uint16_t envelope_attack_millis[  dr_teeth::k_envelope_count ];
+        uint16_t envelope_release_millis[ dr_teeth::k_envelope_count ];
+        uint16_t random_hold_millis[      dr_teeth::k_random_count ];
+        uint8_t  modulation_sources[      dr_teeth::k_modulation_routes ];
+        uint8_t  modulation_destinations[ dr_teeth::k_modulation_routes ];
+        uint8_t  modulation_route_count;
+        uint8_t  lfo_shapes[              dr_teeth::k_lfo_count ];
+        uint8_t  random_modes[            dr_teeth::k_random_count ];
+        uint32_t crc;                                   // over everything above, seeded with k_version
+    };
+
+    muppet_preset_bank( void );
+
+    // boot: every intact record into the cache
+    void load( void );
+
+    // the preset, nullptr when it was never stored
+    const record_t* recall( uint8_t preset ) const;
+
+    // voice thread: frame and config's modulation become the preset, in EEPROM once keep() gets to it
+    bool store( uint8_t preset, const uint16_t* frame, const muppet_frame_config& config );
+
+    // the record's modulation over config's (a draft), the rest of config stays
+    static void modulation_into( const record_t& record, muppet_frame_config& config );
+
+    // idle thread: writes one dirty preset
+    void keep( void );
+
+    inline uint32_t how_many_stored( void ) const { return __builtin_popcount( stored ); }
+    inline uint32_t how_many_writes( void ) const { return writes;                      }
+
+protected:
+    static constexpr int k_record_bytes = sizeof( record_t );
+    static_assert( dr_teeth::k_preset_eeprom_base >= dr_teeth::k_config_eeprom_end, "the presets overlap the config store" );
+    static_assert( dr_teeth::k_preset_eeprom_base + k_presets * k_record_bytes <= dr_teeth::k_preset_eeprom_end, "the presets outgrew their EEPROM partition" );
+
+    record_t          records[ k_presets ];
+    uint32_t          stored;
+    volatile uint32_t dirty;
+    uint32_t          writes;
+
+    static int      address_of( uint8_t preset ) { return dr_teeth::k_preset_eeprom_base + preset * k_record_bytes; }
+    static uint32_t crc_of( const record_t& record );
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+
+#include "dr_teeth.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_preset_morph
+// Moves a whole input frame to a target frame in a straight line over a
+// number of control ticks. Every channel is a 16.16 fixed point position
+// plus a step worked out once by start(), so a tick is one add per channel
+// whatever the morph length; the last tick lands on the target exactly.
+//
+// A tick only writes the channels whose DAC code (k_code_max full scale, the
+// driver's resolution) changed since it last wrote them and tells the caller
+// whether there was any, so slow morphs do not wake the show for frames the
+// devices would not notice. A channel the host sets in the middle of a morph
+// is released and stays where the host put it.
+////////////////////////////////////////////////////////////////////////////////
+
+template < uint16_t k_code_max >
+class muppet_preset_morph {
+public:
+    muppet_preset_morph( void ) :
+        ticks_left(       0 ),
+        channels(         0 ),
+        next_tick_micros( 0 )
+    { }
+
+    // from: the frame as it is now, to: where it goes; 0 or 1 ticks jump on the next tick
+    void start( const uint16_t* from, const uint16_t* to, uint32_t ticks ) {
+        ticks = ticks ? ticks : 1;
+
+        for ( uint8_t channel_index = 0; channel_index < dr_teeth::k_total_channels; ++channel_index ) {
+            int64_t distance = static_cast< int64_t >( to[ channel_index ] - from[ channel_index ] ) << 16;
+
+            positions[ channel_index ] = static_cast< uint32_t >( from[ channel_index ] ) << 16;
+            steps[     channel_index ] = ticks > 1 ? static_cast< int32_t >( distance / static_cast< int64_t >( ticks ) ) : 0;
+            targets[   channel_index ] = to[ channel_index ];
+            codes[     channel_index ] = code_of( from[ channel_index ] );
+        }
+
+        channels   = k_all_channels;
+        ticks_left = ticks;
+    }
+
+    // the host took the channel over
+    inline void release( uint8_t channel_index ) {
+        channels &= ~( 1UL << channel_index );
+    }
+
+    inline bool is_running( void ) const { return ticks_left != 0 && channels != 0; }
+
+    // one control tick once k_morph_tick_micros have passed, true when frame changed
+    bool tick( uint16_t* frame, uint32_t now_micros ) {
+        if ( !is_running( ) || static_cast< int32_t >( now_micros - next_tick_micros ) < 0 ) {
+            return false;
+        }
+        next_tick_micros = now_micros + dr_teeth::k_morph_tick_micros;
+
+        bool     last    = --ticks_left == 0;
+        bool     changed = false;
+        uint32_t moving  = channels;
+
+        for ( uint8_t channel_index = 0; moving; ++channel_index, moving >>= 1 ) {
+            if ( !( moving & 1 ) ) {
+                continue;
+            }
+
+            positions[ channel_index ] += steps[ channel_index ];
+
+            uint16_t value = last ? targets[ channel_index ] : static_cast< uint16_t >( positions[ channel_index ] >> 16 );
+            uint16_t code  = code_of( value );
+            if ( code != codes[ channel_index ] || last ) {
+                changed                = changed || frame[ channel_index ] != value;
+                frame[ channel_index ] = value;
+                codes[ channel_index ] = code;
+            }
+        }
+
+        return changed;
+    }
+
+protected:
+    static constexpr uint32_t k_all_channels = dr_teeth::k_total_channels < 32 ? ( 1UL << dr_teeth::k_total_channels ) - 1 : 0xFFFFFFFF;
+    static_assert( dr_teeth::k_total_channels <= 32, "channels are one 32 bit mask" );
+
+    static inline uint16_t code_of( uint16_t value ) {
+        return static_cast< uint16_t >( static_cast< uint32_t >( value ) * k_code_max / dr_teeth::k_max_value );
+    }
+
+    uint32_t positions[ dr_teeth::k_total_channels ];   // 16.16
+    int32_t  steps[     dr_teeth::k_total_channels ];
+    uint16_t targets[   dr_teeth::k_total_channels ];
+    uint16_t codes[     dr_teeth::k_total_channels ];   // last code written per channel
+    uint32_t ticks_left;
+    uint32_t channels;                                  // still morphing
+    uint32_t next_tick_micros;
+};
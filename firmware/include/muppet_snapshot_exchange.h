@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_snapshot_exchange
+// Publishes an immutable T to real-time readers, RCU style. Readers never
+// lock and never wait: enter() is two atomic operations and hands out the
+// current snapshot, which stays valid until the matching leave().
+//
+// The single writer edits a private draft (a copy of the current snapshot in
+// a free slot) and publish() swaps it in with one pointer store. The epoch
+// goes up with every publish; a reader stamps the epoch it entered with and
+// clears the stamp when it leaves, which is its quiescent point. A replaced
+// snapshot is reused for a new draft once no reader entered before it was
+// replaced, so the slots are a fixed pool and nothing is ever allocated.
+//
+// All atomics are sequentially consistent: a writer that finds a reader
+// offline after swapping the pointer knows that reader's next enter() gets
+// the new snapshot.
+////////////////////////////////////////////////////////////////////////////////
+
+template < typename T, uint8_t k_readers, uint8_t k_slots = 3 >
+class muppet_snapshot_exchange {
+public:
+    static_assert( k_slots >= 2, "one slot is always the current snapshot, a draft needs another" );
+
+    muppet_snapshot_exchange( void ) :
+        current(    &slots[ 0 ] ),
+        epoch(      1           ),
+        draft_slot( k_no_slot   ),
+        publishes(  0           )
+    {
+        for ( uint8_t reader = 0; reader < k_readers; ++reader ) {
+            reader_epochs[ reader ].store( k_offline );
+        }
+        for ( uint8_t slot = 0; slot < k_slots; ++slot ) {
+            retired_at[ slot ] = 0;
+        }
+    }
+
+    // reader side: each reader has its own index and does not nest
+    inline const T* enter( uint8_t reader ) {
+        reader_epochs[ reader ].store( epoch.load( ) );
+        return current.load( );
+    }
+
+    inline void leave( uint8_t reader ) {
+        reader_epochs[ reader ].store( k_offline );
+    }
+
+    // writer side: the draft to edit, a copy of the current snapshot at the first call after a
+    // publish; nullptr while readers may still hold every other slot
+    T* draft( void ) {
+        if ( draft_slot == k_no_slot ) {
+            uint8_t slot = reclaimable( );
+            if ( slot == k_no_slot ) {
+                return nullptr;
+            }
+
+            slots[ slot ] = *current.load( );
+            draft_slot    = slot;
+        }
+        return &slots[ draft_slot ];
+    }
+
+    // the draft becomes the snapshot every enter() gets from now on
+    bool publish( void ) {
+        if ( draft_slot == k_no_slot ) {
+            return false;
+        }
+
+        T* previous = current.load( );
+        current.store( &slots[ draft_slot ] );
+        retired_at[ previous - slots ] = epoch.fetch_add( 1 ) + 1;
+
+        draft_slot = k_no_slot;
+        ++publishes;
+        return true;
+    }
+
+    inline void discard( void ) {
+        draft_slot = k_no_slot;
+    }
+
+    inline bool     has_draft( void ) const           { return draft_slot != k_no_slot; }
+    inline const T* peek( void ) const                { return current.load( ); }
+    inline uint32_t how_many_publishes( void ) const  { return publishes;       }
+    inline uint32_t what_epoch( void ) const          { return epoch.load( );   }
+
+protected:
+    static constexpr uint32_t k_offline = 0xFFFFFFFF;
+    static constexpr uint8_t  k_no_slot = 0xFF;
+
+    T                       slots[ k_slots ];
+    uint32_t                retired_at[ k_slots ];          // epoch the slot stopped being current at
+    std::atomic< T* >       current;
+    std::atomic< uint32_t > epoch;
+    std::atomic< uint32_t > reader_epochs[ k_readers ];     // k_offline between enter() and leave()
+    uint8_t                 draft_slot;
+    uint32_t                publishes;
+
+    // a slot nobody can be reading: not current, and replaced before the oldest reader entered
+    uint8_t reclaimable( void ) const {
+        uint32_t oldest = k_offline;
+        for ( uint8_t reader = 0; reader < k_readers; ++reader ) {
+            uint32_t entered = reader_epochs[ reader ].load( );
+            oldest = entered < oldest ? entered : oldest;
+        }
+
+        const T* in_use = current.load( );
+        for ( uint8_t slot = 0; slot < k_slots; ++slot ) {
+            if ( &slots[ slot ] != in_use && retired_at[ slot ] <= oldest ) {
+                return slot;
+            }
+        }
+        return k_no_slot;
+    }
+};
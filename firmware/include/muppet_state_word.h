@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_state_word
+// Everything a worker and its producers need to agree on, packed in one
+// 32 bit word so every check is a single load and every change a single
+// LDREX/STREX compare-and-swap:
+//
+//   31                                8 7      4 3      0
+//  +-----------------------------------+--------+--------+
+//  |             sequence              |  code  | phase  |
+//  +-----------------------------------+--------+--------+
+//
+// The sequence lives in the top bits and moves in steps of k_sequence_one,
+// so it wraps with the whole word and compares like any 32 bit counter.
+// Producers only ever add to the sequence; phase and code belong to the
+// state machine:
+//
+//   idle        --try_begin-->          k_in_progress
+//   in_progress --transition-->         k_in_progress | k_pending   (handed to DMA)
+//   pending     --transition-->         ... | k_completed, code     (transfer done)
+//   any         --transition-->         idle                        (frame retired)
+////////////////////////////////////////////////////////////////////////////////
+
+class muppet_state_word {
+public:
+    const static uint32_t k_in_progress   = 1 << 0;   // a frame is being written
+    const static uint32_t k_pending       = 1 << 1;   // the frame is on an asynchronous transfer
+    const static uint32_t k_completed     = 1 << 2;   // that transfer finished, not collected yet
+    const static uint32_t k_phase_mask    = 0x0000000F;
+
+    const static uint8_t  k_code_shift    = 4;
+    const static uint32_t k_code_mask     = 0x000000F0;
+
+    const static uint32_t k_sequence_one  = 0x00000100;
+    const static uint32_t k_sequence_mask = 0xFFFFFF00;
+
+    muppet_state_word( void ) : word( 0 ) { }
+
+    static inline uint32_t sequence_of( uint32_t the_word )                 { return the_word & k_sequence_mask;                  }
+    static inline uint8_t  code_of(     uint32_t the_word )                 { return ( the_word & k_code_mask ) >> k_code_shift; }
+    static inline bool     is(          uint32_t the_word, uint32_t phase ) { return ( the_word & phase ) != 0;                  }
+    static inline uint32_t with_code(   uint8_t  code )                     { return ( uint32_t( code ) << k_code_shift ) & k_code_mask; }
+
+    inline uint32_t load( void ) const          { return word.load( std::memory_order_acquire ); }
+    inline uint32_t sequence( void ) const      { return sequence_of( load( ) );                 }
+    inline uint8_t  code( void ) const          { return code_of( load( ) );                     }
+    inline bool     is( uint32_t phase ) const  { return is( load( ), phase );                   }
+
+    // producer side: a new frame is waiting, phase and code untouched
+    inline uint32_t request( void ) {
+        return sequence_of( word.fetch_add( k_sequence_one, std::memory_order_acq_rel ) + k_sequence_one );
+    }
+
+    // worker side: takes the newest sequence if it differs from last_sequence and
+    // none of the busy phases is set, marking it k_in_progress
+    bool try_begin( uint32_t last_sequence, uint32_t busy_phases, uint32_t& sequence ) {
+        uint32_t expected = load( );
+
+        do {
+            if ( sequence_of( expected ) == last_sequence || is( expected, busy_phases ) ) {
+                return false;
+            }
+        } while ( !word.compare_exchange_weak( expected, expected | k_in_progress, std::memory_order_acq_rel ) );
+
+        sequence = sequence_of( expected );
+        return true;
+    }
+
+    // numbered operations: bumps the sequence and enters the given phase with a
+    // clean code, unless one of the busy phases is set
+    bool try_start( uint32_t busy_phases, uint32_t phase, uint32_t& sequence ) {
+        uint32_t expected = load( );
+        uint32_t desired;
+
+        do {
+            if ( is( expected, busy_phases ) ) {
+                return false;
+            }
+            desired = sequence_of( expected + k_sequence_one ) | ( phase & k_phase_mask );
+        } while ( !word.compare_exchange_weak( expected, desired, std::memory_order_acq_rel ) );
+
+        sequence = sequence_of( desired );
+        return true;
+    }
+
+    // clears then sets phase/code bits, only if every required bit is set and no
+    // forbidden one is; the sequence is never touched
+    bool transition( uint32_t required, uint32_t forbidden, uint32_t set, uint32_t clear ) {
+        uint32_t expected = load( );
+
+        set   &= ~k_sequence_mask;
+        clear &= ~k_sequence_mask;
+
+        do {
+            if ( ( expected & required ) != required || is( expected, forbidden ) ) {
+                return false;
+            }
+        } while ( !word.compare_exchange_weak( expected, ( expected & ~clear ) | set, std::memory_order_acq_rel ) );
+
+        return true;
+    }
+
+    // back to idle, keeping the sequence
+    inline void retire( void ) { transition( 0, 0, 0, k_phase_mask | k_code_mask ); }
+
+protected:
+    std::atomic< uint32_t > word;
+};
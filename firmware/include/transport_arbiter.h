@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <Arduino.h>
+
+/**
+ * @brief Per-device arbiter between the DMA and synchronous transports
+ *
+ * Every frame carries the update sequence it was copied under. A transport must claim the
+ * sequence before touching the bus, which fails for anything older than a frame already
+ * claimed, and reports back with commit() once the bytes are on the wire. If a newer frame
+ * was claimed while an older one was still in flight, commit() returns false and the
+ * caller has to replay the newest frame, so the DAC never ends up on a stale frame whichever
+ * transport got there last.
+ *
+ * The active transport is a single atomic byte, switched with a compare-and-swap; the cost
+ * of each switch is measured in DWT cycles.
+ */
+class transport_arbiter {
+public:
+    enum class transport_t : uint8_t {
+        DMA = 0,
+        SYNC
+    };
+
+    struct switch_statistics_t {
+        uint32_t switches_to_sync;
+        uint32_t switches_to_dma;
+        uint32_t last_switch_cycles;
+        uint32_t max_switch_cycles;
+        uint32_t stale_claims;          // Frames refused because a newer one was already claimed
+        uint32_t stale_commits;         // Frames that landed after a newer one
+
+        switch_statistics_t() :
+            switches_to_sync( 0 ), switches_to_dma( 0 ),
+            last_switch_cycles( 0 ), max_switch_cycles( 0 ),
+            stale_claims( 0 ), stale_commits( 0 ) {}
+    };
+
+    transport_arbiter() :
+        transport_( static_cast<uint8_t>( transport_t::DMA ) ),
+        claimed_sequence_( 0 ),
+        committed_sequence_( 0 )
+    {}
+
+    transport_t current() const { return static_cast<transport_t>( transport_.load( std::memory_order_acquire ) ); }
+    bool uses_dma() const { return current() == transport_t::DMA; }
+
+    // Lock-free transport switch; true when this call changed it
+    bool select( transport_t transport ) {
+        uint32_t start_cycles = cycle_count();
+        uint8_t expected = transport_.load( std::memory_order_relaxed );
+
+        do {
+            if ( expected == static_cast<uint8_t>( transport ) ) {
+                return false;
+            }
+        } while ( !transport_.compare_exchange_weak( expected, static_cast<uint8_t>( transport ), std::memory_order_acq_rel ) );
+
+        uint32_t cycles = cycle_count() - start_cycles;
+        statistics_.last_switch_cycles = cycles;
+        if ( cycles > statistics_.max_switch_cycles ) {
+            statistics_.max_switch_cycles = cycles;
+        }
+
+        if ( transport == transport_t::SYNC ) {
+            statistics_.switches_to_sync++;
+        } else {
+            statistics_.switches_to_dma++;
+        }
+        return true;
+    }
+
+    // True when the frame may go out: it is not older than anything claimed so far
+    // (the same sequence may be claimed again to retry it)
+    bool claim( uint32_t sequence ) {
+        uint32_t claimed = claimed_sequence_.load( std::memory_order_relaxed );
+
+        do {
+            if ( newer( claimed, sequence ) ) {
+                statistics_.stale_claims++;
+                return false;
+            }
+        } while ( !claimed_sequence_.compare_exchange_weak( claimed, sequence, std::memory_order_acq_rel ) );
+
+        return true;
+    }
+
+    // The claimed frame reached the device. False when a newer frame was claimed in the
+    // meantime: it may have hit the wire first, so the newest frame must be replayed
+    bool commit( uint32_t sequence ) {
+        uint32_t committed = committed_sequence_.load( std::memory_order_relaxed );
+
+        while ( !newer( committed, sequence ) &&
+                !committed_sequence_.compare_exchange_weak( committed, sequence, std::memory_order_acq_rel ) ) {
+        }
+
+        if ( newer( claimed_sequence_.load( std::memory_order_acquire ), sequence ) ) {
+            statistics_.stale_commits++;
+            return false;
+        }
+        return true;
+    }
+
+    uint32_t get_committed_sequence() const { return committed_sequence_.load( std::memory_order_acquire ); }
+    const switch_statistics_t& get_statistics() const { return statistics_; }
+    void reset_statistics() { statistics_ = switch_statistics_t(); }
+
+private:
+    std::atomic<uint8_t>  transport_;
+    std::atomic<uint32_t> claimed_sequence_;
+    std::atomic<uint32_t> committed_sequence_;
+    switch_statistics_t   statistics_;
+
+    // Wrap-safe: true when a is strictly newer than b
+    static inline bool newer( uint32_t a, uint32_t b ) { return static_cast<int32_t>( a - b ) > 0; }
+
+    static inline uint32_t cycle_count() {
+#ifdef ARM_DWT_CYCCNT
+        return ARM_DWT_CYCCNT;
+#else
+        return 0;
+#endif
+    }
+};
@@ -129,97 +129,31 @@ float function_generator::zero()
 
 float function_generator::sawtooth(float t, uint8_t mode)
 {
-  float rv;
-  t += _phase;
-  if (t >= 0.0)
-  {
-    t = (float)fmod(t, _period);
-    if (mode == 1) t = _period - t;
-    rv = _amplitude * (-1.0f + t *_freq2);
-  }
-  else
-  {
-    t = -t;
-    t = (float)fmod(t, _period);
-    if (mode == 1) t = _period - t;
-    rv = _amplitude * ( 1.0f - t * _freq2);
-  }
-  rv += _yShift;
-  return rv;
+  return _sawtooth(t, _shape(), mode);
 }
 
 
 float function_generator::triangle(float t)
 {
-  float rv;
-  t += _phase;
-  if (t < 0.0)
-  {
-    t = -t;
-  }
-  t = (float)fmod(t, _period);
-  if (t < (_period * _dutyCycle))
-  {
-    rv = _amplitude * (-1.0f + t * _freq2 / _dutyCycle);
-  }
-  else
-  {
-    //  mirror math
-    t = _period - t;
-    rv = _amplitude * (-1.0f + t * _freq2 /(1 - _dutyCycle));
-  }
-  rv += _yShift;
-  return rv;
+  return _triangle(t, _shape());
 }
 
 
 float function_generator::square(float t)
 {
-  float rv;
-  t += _phase;
-  if (t >= 0)
-  {
-    t = (float)fmod(t, _period);
-    if (t < (_period * _dutyCycle)) rv = _amplitude;
-    else rv = -_amplitude;
-  }
-  else
-  {
-    t = -t;
-    t = (float)fmod(t, _period);
-    if (t < (_period * _dutyCycle)) rv = -_amplitude;
-    else rv = _amplitude;
-  }
-  rv += _yShift;
-  return rv;
+  return _square(t, _shape());
 }
 
 
 float function_generator::sinus(float t)
 {
-  float rv;
-  t += _phase;
-  rv = _amplitude * (float)sin(t * _freq0);
-  rv += _yShift;
-  return rv;
+  return _sinus(t, _shape());
 }
 
 
 float function_generator::stair(float t, uint16_t steps, uint8_t mode)
 {
-  t += _phase;
-  if (t >= 0)
-  {
-    t = (float)fmod(t, _period);
-    if (mode == 1) t = _period - t;
-    int level = static_cast< int >(steps * t / _period);
-    return _yShift + _amplitude * (-1.0f + 2.0f * level / (steps - 1));
-  }
-  t = -t;
-  t = (float)fmod(t, _period);
-  if (mode == 1) t = _period - t;
-  int level = static_cast<int>(steps * t / _period);
-  return _yShift + _amplitude * (1.0f - 2.0f * level / (steps - 1));
+  return _stair(t, _shape(), steps, mode);
 }
 
 
@@ -277,65 +211,389 @@ float function_generator::sinusRectified(float t)
 
 float function_generator::trapezium1(float t)
 {
-  t += _phase + _period * _dutyCycle / 4;  //  zero point for t = 0
+  return _trapezium1(t, _shape());
+}
+
+
+float function_generator::trapezium2(float t)
+{
+  return _trapezium2(t, _shape());
+}
+
+
+
+//
+//  EXPERIMENTAL HEARTBEAT  
+//  => setFrequency(72.0 / 60.0);  //  BPM/60 = BPS.
+float function_generator::heartBeat( float time_normalized )
+{
+  return _heartBeat( time_normalized );
+}
+
+
+/////////////////////////////////////////////////////////////
+//
+//  BLOCKS
+//
+//  the shape is a local, out cannot alias it: the loop keeps it in registers
+void function_generator::sawtooth(const float * t, float * out, uint16_t count, uint8_t mode)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _sawtooth(t[i], s, mode);
+}
+
+
+void function_generator::triangle(const float * t, float * out, uint16_t count)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _triangle(t[i], s);
+}
+
+
+void function_generator::square(const float * t, float * out, uint16_t count)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _square(t[i], s);
+}
+
+
+void function_generator::sinus(const float * t, float * out, uint16_t count)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _sinus(t[i], s);
+}
+
+
+void function_generator::stair(const float * t, float * out, uint16_t count, uint16_t steps, uint8_t mode)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _stair(t[i], s, steps, mode);
+}
+
+
+void function_generator::trapezium1(const float * t, float * out, uint16_t count)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _trapezium1(t[i], s);
+}
+
+
+void function_generator::trapezium2(const float * t, float * out, uint16_t count)
+{
+  const shape_t s = _shape();
+  for (uint16_t i = 0; i < count; i++) out[i] = _trapezium2(t[i], s);
+}
+
+
+void function_generator::heartBeat(const float * t, float * out, uint16_t count)
+{
+  for (uint16_t i = 0; i < count; i++) out[i] = _heartBeat(t[i]);
+}
+
+
+/////////////////////////////////////////////////////////////
+//
+//  INTEGER PHASE
+//
+const int16_t function_generator::SINUS_LUT[ SINUS_LUT_SIZE + 1 ] = {
+         0,    804,   1608,   2410,   3212,   4011,   4808,   5602,
+      6393,   7179,   7962,   8739,   9512,  10278,  11039,  11793,
+     12539,  13279,  14010,  14732,  15446,  16151,  16846,  17530,
+     18204,  18868,  19519,  20159,  20787,  21403,  22005,  22594,
+     23170,  23731,  24279,  24811,  25329,  25832,  26319,  26790,
+     27245,  27683,  28105,  28510,  28898,  29268,  29621,  29956,
+     30273,  30571,  30852,  31113,  31356,  31580,  31785,  31971,
+     32137,  32285,  32412,  32521,  32609,  32678,  32728,  32757,
+     32767,  32757,  32728,  32678,  32609,  32521,  32412,  32285,
+     32137,  31971,  31785,  31580,  31356,  31113,  30852,  30571,
+     30273,  29956,  29621,  29268,  28898,  28510,  28105,  27683,
+     27245,  26790,  26319,  25832,  25329,  24811,  24279,  23731,
+     23170,  22594,  22005,  21403,  20787,  20159,  19519,  18868,
+     18204,  17530,  16846,  16151,  15446,  14732,  14010,  13279,
+     12539,  11793,  11039,  10278,   9512,   8739,   7962,   7179,
+      6393,   5602,   4808,   4011,   3212,   2410,   1608,    804,
+         0,   -804,  -1608,  -2410,  -3212,  -4011,  -4808,  -5602,
+     -6393,  -7179,  -7962,  -8739,  -9512, -10278, -11039, -11793,
+    -12539, -13279, -14010, -14732, -15446, -16151, -16846, -17530,
+    -18204, -18868, -19519, -20159, -20787, -21403, -22005, -22594,
+    -23170, -23731, -24279, -24811, -25329, -25832, -26319, -26790,
+    -27245, -27683, -28105, -28510, -28898, -29268, -29621, -29956,
+    -30273, -30571, -30852, -31113, -31356, -31580, -31785, -31971,
+    -32137, -32285, -32412, -32521, -32609, -32678, -32728, -32757,
+    -32767, -32757, -32728, -32678, -32609, -32521, -32412, -32285,
+    -32137, -31971, -31785, -31580, -31356, -31113, -30852, -30571,
+    -30273, -29956, -29621, -29268, -28898, -28510, -28105, -27683,
+    -27245, -26790, -26319, -25832, -25329, -24811, -24279, -23731,
+    -23170, -22594, -22005, -21403, -20787, -20159, -19519, -18868,
+    -18204, -17530, -16846, -16151, -15446, -14732, -14010, -13279,
+    -12539, -11793, -11039, -10278,  -9512,  -8739,  -7962,  -7179,
+     -6393,  -5602,  -4808,  -4011,  -3212,  -2410,  -1608,   -804,
+         0
+};
+
+
+//  config time, double keeps the 32 bits a float would lose
+uint32_t function_generator::phaseStep(float sampleRate)
+{
+  double cycles = (double)_freq1 / sampleRate;
+  cycles -= floor(cycles);
+  return (uint32_t)(cycles * 4294967296.0);
+}
+
+
+uint32_t function_generator::phaseOffset()
+{
+  double cycles = (double)_phase * _freq1;
+  cycles -= floor(cycles);
+  return (uint32_t)(cycles * 4294967296.0);
+}
+
+
+//  phase 0 is the bottom, like sawtooth(0)
+uint32_t function_generator::sawtooth_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count, uint8_t mode)
+{
+  const uint32_t flip = (mode == 1) ? 0x7FFFFFFF : 0x80000000;
+  for (uint16_t i = 0; i < count; i++)
+  {
+    out[i] = (int16_t)((int32_t)(phase ^ flip) >> 16);
+    phase += step;
+  }
+  return phase;
+}
+
+
+//  16 bit phase against the duty cycle, the slopes hoisted as 16.16 multipliers
+uint32_t function_generator::triangle_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count)
+{
+  const uint32_t duty    = _dutyPhase() >> 16;
+  const uint32_t riseMul = duty ? (65535UL << 16) / duty : 0;
+  const uint32_t fallMul = (65535UL << 16) / (65536UL - duty);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    uint32_t p = phase >> 16;
+    uint32_t v = (p < duty) ? (uint32_t)(((uint64_t)p * riseMul) >> 16)
+                            : (uint32_t)(((uint64_t)(65536UL - p) * fallMul) >> 16);
+    out[i] = (int16_t)((int32_t)v - 32768);
+    phase += step;
+  }
+  return phase;
+}
+
+
+uint32_t function_generator::square_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count)
+{
+  const uint32_t duty = _dutyPhase();
+  for (uint16_t i = 0; i < count; i++)
+  {
+    out[i] = (phase < duty) ? 32767 : -32768;
+    phase += step;
+  }
+  return phase;
+}
+
+
+//  top 8 bits pick the segment, the next 16 interpolate
+uint32_t function_generator::sinus_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count)
+{
+  for (uint16_t i = 0; i < count; i++)
+  {
+    uint32_t index    = phase >> 24;
+    int32_t  fraction = (phase >> 8) & 0xFFFF;
+    int32_t  a        = SINUS_LUT[index];
+    int32_t  b        = SINUS_LUT[index + 1];
+    out[i] = (int16_t)(a + (((b - a) * fraction) >> 16));
+    phase += step;
+  }
+  return phase;
+}
+
+
+uint32_t function_generator::stair_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count, uint16_t steps, uint8_t mode)
+{
+  if (steps < 2) steps = 2;
+  const uint32_t heightMul = (65535UL << 16) / (steps - 1);
+  for (uint16_t i = 0; i < count; i++)
+  {
+    uint32_t level = (uint32_t)(((uint64_t)phase * steps) >> 32);
+    if (mode == 1) level = steps - 1 - level;
+    out[i] = (int16_t)((int32_t)(((uint64_t)level * heightMul) >> 16) - 32768);
+    phase += step;
+  }
+  return phase;
+}
+
+
+/////////////////////////////////////////////////////////////
+//
+//  PRIVATE
+//
+function_generator::shape_t function_generator::_shape() const
+{
+  return { _period, _freq0, _freq2, _amplitude, _phase, _yShift, _dutyCycle };
+}
+
+
+uint32_t function_generator::_dutyPhase() const
+{
+  if (_dutyCycle >= 1.0f) return 0xFFFFFFFF;
+  return (uint32_t)((double)_dutyCycle * 4294967296.0);
+}
+
+
+//  the kernels keep the original expressions, fmod(t, period) is t for 0 <= t < period
+float function_generator::_sawtooth(float t, const shape_t & s, uint8_t mode)
+{
+  float rv;
+  t += s.phase;
+  if (t >= 0.0)
+  {
+    if (t >= s.period) t = (float)fmod(t, s.period);
+    if (mode == 1) t = s.period - t;
+    rv = s.amplitude * (-1.0f + t * s.freq2);
+  }
+  else
+  {
+    t = -t;
+    if (t >= s.period) t = (float)fmod(t, s.period);
+    if (mode == 1) t = s.period - t;
+    rv = s.amplitude * ( 1.0f - t * s.freq2);
+  }
+  rv += s.yShift;
+  return rv;
+}
+
+
+float function_generator::_triangle(float t, const shape_t & s)
+{
+  float rv;
+  t += s.phase;
+  if (t < 0.0)
+  {
+    t = -t;
+  }
+  if (t >= s.period) t = (float)fmod(t, s.period);
+  if (t < (s.period * s.dutyCycle))
+  {
+    rv = s.amplitude * (-1.0f + t * s.freq2 / s.dutyCycle);
+  }
+  else
+  {
+    //  mirror math
+    t = s.period - t;
+    rv = s.amplitude * (-1.0f + t * s.freq2 /(1 - s.dutyCycle));
+  }
+  rv += s.yShift;
+  return rv;
+}
+
+
+float function_generator::_square(float t, const shape_t & s)
+{
+  float rv;
+  t += s.phase;
+  if (t >= 0)
+  {
+    if (t >= s.period) t = (float)fmod(t, s.period);
+    if (t < (s.period * s.dutyCycle)) rv = s.amplitude;
+    else rv = -s.amplitude;
+  }
+  else
+  {
+    t = -t;
+    if (t >= s.period) t = (float)fmod(t, s.period);
+    if (t < (s.period * s.dutyCycle)) rv = -s.amplitude;
+    else rv = s.amplitude;
+  }
+  rv += s.yShift;
+  return rv;
+}
+
+
+float function_generator::_sinus(float t, const shape_t & s)
+{
+  float rv;
+  t += s.phase;
+  rv = s.amplitude * (float)sin(t * s.freq0);
+  rv += s.yShift;
+  return rv;
+}
+
+
+float function_generator::_stair(float t, const shape_t & s, uint16_t steps, uint8_t mode)
+{
+  t += s.phase;
+  if (t >= 0)
+  {
+    if (t >= s.period) t = (float)fmod(t, s.period);
+    if (mode == 1) t = s.period - t;
+    int level = static_cast< int >(steps * t / s.period);
+    return s.yShift + s.amplitude * (-1.0f + 2.0f * level / (steps - 1));
+  }
+  t = -t;
+  if (t >= s.period) t = (float)fmod(t, s.period);
+  if (mode == 1) t = s.period - t;
+  int level = static_cast<int>(steps * t / s.period);
+  return s.yShift + s.amplitude * (1.0f - 2.0f * level / (steps - 1));
+}
+
+
+float function_generator::_trapezium1(float t, const shape_t & s)
+{
+  t += s.phase + s.period * s.dutyCycle / 4;  //  zero point for t = 0
   if (t < 0)
   {
     t = -t;
   }
-  t = (float)fmod(t, _period);
+  if (t >= s.period) t = (float)fmod(t, s.period);
 
-  if (t < _period * 0.5 * _dutyCycle)  //  rising part
+  if (t < s.period * 0.5 * s.dutyCycle)  //  rising part
   {
-    return _yShift + -_amplitude + 2 * _amplitude * (t * 2  / (_period * _dutyCycle));
+    return s.yShift + -s.amplitude + 2 * s.amplitude * (t * 2  / (s.period * s.dutyCycle));
   }
-  else if (t < _period * 0.5)  //  high part
+  else if (t < s.period * 0.5)  //  high part
   {
-    return _yShift + _amplitude;
+    return s.yShift + s.amplitude;
   }
-  else if (t < _period * (0.5 + 0.5 * _dutyCycle))  //  falling part
+  else if (t < s.period * (0.5 + 0.5 * s.dutyCycle))  //  falling part
   {
-    return _yShift + _amplitude - 2 * _amplitude * ( (t * 2 - _period) / (_period * _dutyCycle));
+    return s.yShift + s.amplitude - 2 * s.amplitude * ( (t * 2 - s.period) / (s.period * s.dutyCycle));
   }
   else   //  low part
   {
-    return _yShift + -_amplitude;
+    return s.yShift + -s.amplitude;
   }
 }
 
 
-float function_generator::trapezium2(float t)
+float function_generator::_trapezium2(float t, const shape_t & s)
 {
-  t += _phase + _period * _dutyCycle / 4;  //  zero point for t = 0
+  t += s.phase + s.period * s.dutyCycle / 4;  //  zero point for t = 0
   if (t < 0)
   {
     t = -t;
   }
-  t = (float)fmod(t, _period);
+  if (t >= s.period) t = (float)fmod(t, s.period);
 
-  if (t < _period * 0.25)  //  rising part
+  if (t < s.period * 0.25)  //  rising part
   {
-    return _yShift + -_amplitude + 2 * _amplitude * (t * 4 / _period);
+    return s.yShift + -s.amplitude + 2 * s.amplitude * (t * 4 / s.period);
   }
-  else if (t < _period * (0.25 + 0.5 * _dutyCycle))  //  high part
+  else if (t < s.period * (0.25 + 0.5 * s.dutyCycle))  //  high part
   {
-    return _yShift + _amplitude;
+    return s.yShift + s.amplitude;
   }
-  else if (t < _period * (0.5 + 0.5 * _dutyCycle))  //  falling part
+  else if (t < s.period * (0.5 + 0.5 * s.dutyCycle))  //  falling part
   {
-    return _yShift + _amplitude - 2 * _amplitude * ((t - _period * (0.25f + 0.5f * _dutyCycle)) * 4 / _period);
+    return s.yShift + s.amplitude - 2 * s.amplitude * ((t - s.period * (0.25f + 0.5f * s.dutyCycle)) * 4 / s.period);
   }
   else   //  low part
   {
-    return _yShift + -_amplitude;
+    return s.yShift + -s.amplitude;
   }
 }
 
 
-
-//
-//  EXPERIMENTAL HEARTBEAT  
-//  => setFrequency(72.0 / 60.0);  //  BPM/60 = BPS.
-float function_generator::heartBeat( float time_normalized )
+float function_generator::_heartBeat( float time_normalized )
 {
   // Clamp input to valid range
   if ( time_normalized  < 0.0f ) time_normalized = 0.0f;
@@ -359,14 +617,6 @@ float function_generator::heartBeat( float time_normalized )
 }
 
 
-
-
-
-
-/////////////////////////////////////////////////////////////
-//
-//  PRIVATE
-//
 //  An example of a simple pseudo-random number generator is the
 //  Multiply-with-carry method invented by George Marsaglia.
 //  two initializers (not null)
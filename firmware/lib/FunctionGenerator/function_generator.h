@@ -9,6 +9,18 @@
 // y3i12- NOTE: the library remains the same as coded by Rob Tillaart,
 //    the change makes it compliant with standard C++, making it possible
 //    to be used in non-arduino projects. the class was renamed.
+//
+// y3i12- NOTE: BLOCKS. every wave form also takes a whole block of times.
+//    the scalar call reads the settings through this on every sample, and a
+//    block loop storing floats cannot keep them in registers (out may alias
+//    them), so both copy them into a shape_t first and share one kernel per
+//    wave form: the scalar API gives the very same bits it always did. fmod
+//    is skipped when t already is inside the period, where it is exact anyway.
+//    the _q15 variants run on an integer phase instead of a float time: a
+//    full cycle is 2^32, step is added per sample and the next phase is
+//    returned. they give full scale, -32768 .. 32767, honour the duty cycle
+//    and leave amplitude and yShift to the caller; sinus reads a 257 point
+//    table with linear interpolation, no fmod, no sin, no float at all.
 
 
 #include <cstdint>
@@ -91,7 +103,66 @@ public:
   float heartBeat(float t);  //  72 BPM = 72/60 = 1 setFrequency(1.2)
 
 
+  /////////////////////////////////////////////////////////////
+  //
+  //  BLOCKS, out[i] = f(t[i]) for count samples, bit equal to the scalar calls
+  //
+  void  sawtooth(const float * t, float * out, uint16_t count, uint8_t mode = 0);
+  void  triangle(const float * t, float * out, uint16_t count);
+  void  square(const float * t, float * out, uint16_t count);
+  void  sinus(const float * t, float * out, uint16_t count);
+  void  stair(const float * t, float * out, uint16_t count, uint16_t steps = 8, uint8_t mode = 0);
+  void  trapezium1(const float * t, float * out, uint16_t count);
+  void  trapezium2(const float * t, float * out, uint16_t count);
+  void  heartBeat(const float * t, float * out, uint16_t count);
+
+
+  /////////////////////////////////////////////////////////////
+  //
+  //  INTEGER PHASE, count samples from phase on, returns the phase after them
+  //
+  //  phase increment per sample at the current frequency
+  uint32_t phaseStep(float sampleRate);
+  //  setPhase() as a phase
+  uint32_t phaseOffset();
+
+  uint32_t sawtooth_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count, uint8_t mode = 0);
+  uint32_t triangle_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count);
+  uint32_t square_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count);
+  uint32_t sinus_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count);
+  uint32_t stair_q15(uint32_t phase, uint32_t step, int16_t * out, uint16_t count, uint16_t steps = 8, uint8_t mode = 0);
+
+
 private:
+  //  the settings a wave form reads, copied out of the object once per call
+  struct shape_t
+  {
+    float period;
+    float freq0;
+    float freq2;
+    float amplitude;
+    float phase;
+    float yShift;
+    float dutyCycle;
+  };
+
+  static constexpr uint16_t SINUS_LUT_SIZE = 256;
+  static const int16_t      SINUS_LUT[ SINUS_LUT_SIZE + 1 ];
+
+  shape_t _shape() const;
+
+  static float _sawtooth(float t, const shape_t & s, uint8_t mode);
+  static float _triangle(float t, const shape_t & s);
+  static float _square(float t, const shape_t & s);
+  static float _sinus(float t, const shape_t & s);
+  static float _stair(float t, const shape_t & s, uint16_t steps, uint8_t mode);
+  static float _trapezium1(float t, const shape_t & s);
+  static float _trapezium2(float t, const shape_t & s);
+  static float _heartBeat(float t);
+
+  //  dutyCycle as a phase, where square and triangle turn
+  uint32_t _dutyPhase() const;
+
     inline long map( long x, long in_min, long in_max, long out_min, long out_max ) {
         return ( x - in_min ) * ( out_max - out_min ) / ( in_max - in_min ) + out_min;
     }
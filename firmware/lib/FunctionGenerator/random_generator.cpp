@@ -0,0 +1,106 @@
+//
+//    FILE: random_generator.cpp
+// PURPOSE: block random numbers and colored noise for function_generator users
+
+
+#include "random_generator.h"
+
+
+random_generator::random_generator(uint32_t seed)
+{
+  setSeed(seed);
+}
+
+
+//  splitmix32 spreads one seed over the lanes, xorshift32 must not start at 0
+void random_generator::setSeed(uint32_t seed)
+{
+  for (uint8_t lane = 0; lane < LANES; lane++)
+  {
+    seed += 0x9E3779B9;
+    uint32_t z = seed;
+    z = (z ^ (z >> 16)) * 0x85EBCA6B;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35;
+    z =  z ^ (z >> 16);
+    _state[lane] = z ? z : 0x6D2B79F5;
+  }
+}
+
+
+/////////////////////////////////////////////////////////////
+//
+//  BLOCKS
+//
+void random_generator::fill(uint32_t * block, uint16_t count)
+{
+  uint32_t s[LANES];
+  for (uint8_t lane = 0; lane < LANES; lane++) s[lane] = _state[lane];
+
+  uint16_t index = 0;
+  while (index < count)
+  {
+    for (uint8_t lane = 0; lane < LANES; lane++)
+    {
+      s[lane] ^= s[lane] << 13;
+      s[lane] ^= s[lane] >> 17;
+      s[lane] ^= s[lane] << 5;
+    }
+    for (uint8_t lane = 0; lane < LANES && index < count; lane++)
+    {
+      block[index++] = s[lane] * 0x9E3779BB;   //  the multiply fixes xorshift's weak low bits
+    }
+  }
+
+  for (uint8_t lane = 0; lane < LANES; lane++) _state[lane] = s[lane];
+}
+
+
+void random_generator::white(int16_t * block, uint16_t count)
+{
+  uint32_t raw[LANES];
+  uint16_t index = 0;
+  while (index < count)
+  {
+    uint16_t n = (count - index) < LANES ? (count - index) : LANES;
+    fill(raw, n);
+    for (uint16_t k = 0; k < n; k++)
+    {
+      block[index++] = (int16_t)(raw[k] >> 16);
+    }
+  }
+}
+
+
+/////////////////////////////////////////////////////////////
+//
+//  FILTERS
+//
+//  b0 = 0.99765 b0 + 0.0990460 w
+//  b1 = 0.96300 b1 + 0.2965164 w
+//  b2 = 0.57000 b2 + 1.0526913 w
+//  out = (b0 + b1 + b2 + 0.1848 w) / 8, all in Q15, about a fifth of full scale rms
+int16_t random_generator::pink(pink_state & state, int16_t white)
+{
+  int32_t w = white;
+  state.b0 = (int32_t)(((int64_t)state.b0 * 32690 + (int64_t)w * 3246 ) >> 15);
+  state.b1 = (int32_t)(((int64_t)state.b1 * 31556 + (int64_t)w * 9716 ) >> 15);
+  state.b2 = (int32_t)(((int64_t)state.b2 * 18678 + (int64_t)w * 34495) >> 15);
+
+  int32_t out = (state.b0 + state.b1 + state.b2 + ((w * 6056) >> 15)) >> 3;
+  if (out >  32767) out =  32767;
+  if (out < -32768) out = -32768;
+  return (int16_t)out;
+}
+
+
+//  y = y - y / 64 + w / 16: leaks back to 0, about a fifth of full scale rms
+int16_t random_generator::brown(int32_t & state, int16_t white)
+{
+  state += (white >> 4) - (state >> 6);
+  if (state >  32767) state =  32767;
+  if (state < -32768) state = -32768;
+  return (int16_t)state;
+}
+
+
+//  -- END OF FILE --
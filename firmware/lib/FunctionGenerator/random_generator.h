@@ -0,0 +1,61 @@
+#pragma once
+//
+//    FILE: random_generator.h
+// PURPOSE: block random numbers and colored noise for function_generator users
+//
+// y3i12- NOTE: function_generator::random() makes one float per call out of
+//    one Marsaglia step. random_generator fills whole blocks instead: LANES
+//    independent xorshift32 streams, each scrambled by a multiply, advanced
+//    side by side so the loop body has no dependency between lanes (the
+//    compiler unrolls or vectorizes it). Colored noise is a filter over the
+//    white block, its state kept by the caller, one per stream.
+
+
+#include <cstdint>
+
+
+class random_generator
+{
+public:
+
+  static constexpr uint8_t LANES = 4;
+
+  //  pink: Paul Kellet's economy filter, three poles, fixed point
+  struct pink_state
+  {
+    int32_t b0 = 0;
+    int32_t b1 = 0;
+    int32_t b2 = 0;
+  };
+
+
+  random_generator(uint32_t seed = 314159265);
+
+  void  setSeed(uint32_t seed);
+
+
+  /////////////////////////////////////////////////////////////
+  //
+  //  BLOCKS
+  //
+  //  count raw 32 bit values
+  void  fill(uint32_t * block, uint16_t count);
+  //  count white noise samples, -32768 .. 32767
+  void  white(int16_t * block, uint16_t count);
+
+
+  /////////////////////////////////////////////////////////////
+  //
+  //  FILTERS, one white sample in, one colored sample out
+  //
+  static int16_t pink(pink_state & state, int16_t white);
+  //  leaky integrator, brown / red noise
+  static int16_t brown(int32_t & state, int16_t white);
+
+
+private:
+  uint32_t _state[LANES];
+};
+
+
+//  -- END OF FILE --
@@ -39,90 +39,71 @@ unsigned int time_end;
 
 #define __flush_cpu() __asm__ volatile("DMB");
 
+// Everything TeensyThreads-asm.S reaches by name. The assembly is a separate
+// object that never goes through LTO, so these have to keep their C names and
+// survive even when LTO sees no C++ caller.
+#define THREADS_ASM_SYMBOL __attribute__((used, externally_visible))
+
 // These variables are used by the assembly context_switch() function.
 // They are copies or pointers to data in Threads and ThreadInfo
 // and put here seperately in order to simplify the code.
 extern "C" {
-  int currentUseSystick;      // using Systick vs PIT/GPT
-  int currentActive;          // state of the system (first, start, stop)
-  int currentCount;
-  ThreadInfo *currentThread;  // the thread currently running
-  void *currentSave;
-  int currentMSP;             // Stack pointers to save
-  void *currentSP;
-  void loadNextThread() {
+  THREADS_ASM_SYMBOL int currentUseSystick;      // using Systick vs PIT/GPT
+  THREADS_ASM_SYMBOL int currentActive;          // state of the system (first, start, stop)
+  THREADS_ASM_SYMBOL int currentCount;
+  THREADS_ASM_SYMBOL ThreadInfo *currentThread;  // the thread currently running
+  THREADS_ASM_SYMBOL void *currentSave;
+  THREADS_ASM_SYMBOL int currentMSP;             // Stack pointers to save
+  THREADS_ASM_SYMBOL void *currentSP;
+  THREADS_ASM_SYMBOL IsrFunction saveSystickIsr; // handlers chained from threads_systick_isr
+  THREADS_ASM_SYMBOL IsrFunction saveSvcallIsr;  // and threads_svcall_isr
+  THREADS_ASM_SYMBOL __attribute__((noinline)) void loadNextThread() {
     threads.getNextThread();
   }
 }
 
+// Constants the assembly has hard-coded
+static_assert(Threads::STARTED == 1, "threads_svcall_isr stores 1 in currentActive");
+static_assert(Threads::SVC_NUMBER == 0x21 && Threads::SVC_NUMBER_ACTIVE == 0x22, "threads_svcall_isr compares the SVC numbers");
+#ifdef __ARM_PCS_VFP
+static_assert(sizeof(software_stack_t) == (9 + 32 + 1) * sizeof(uint32_t), "context_switch saves r4-r11, lr, s0-s31, fpscr");
+#else
+static_assert(sizeof(software_stack_t) == 9 * sizeof(uint32_t), "context_switch saves r4-r11, lr");
+#endif
+
 const int overflow_stack_size = 64;// 8;
 
+#ifdef THREADS_CYCLE_ACCOUNTING
+#ifdef __IMXRT1062__
+#define THREADS_CYCLES_PER_SECOND F_CPU_ACTUAL
+#else
+#define THREADS_CYCLES_PER_SECOND F_CPU
+#endif
+#endif
+
 extern "C" void stack_overflow_default_isr() { 
   currentThread->flags = Threads::ENDED;
 }
 extern "C" void stack_overflow_isr(void)       __attribute__ ((weak, alias("stack_overflow_default_isr")));
 
-extern unsigned long _estack;   // the main thread 0 stack
-
-// static void threads_svcall_isr(void);
-// static void threads_systick_isr(void);
-
-IsrFunction Threads::save_systick_isr;
-IsrFunction Threads::save_svcall_isr;
+#ifdef THREADS_MPU_GUARD
+extern unsigned long _ebss;     // thread 0 (MSP) grows down towards the end of .bss
 
-/*
- * Teensy 3:
- * Replace the SysTick interrupt for our context switching. Note that
- * this function is "naked" meaning it does not save it's registers
- * on the stack. This is so we can preserve the stack of the caller.
- *
- * Interrupts will save r0-r4 in the stack and since this function
- * is short and simple, it should only use those registers. In the
- * future, this should be coded in assembly to make sure.
- */
-extern volatile uint32_t systick_millis_count;
-extern "C" void systick_isr();
-void __attribute((naked, noinline)) threads_systick_isr(void)
-{
-  if (Threads::save_systick_isr) {
-    asm volatile("push {r0-r4,lr}");
-    (*Threads::save_systick_isr)();
-    asm volatile("pop {r0-r4,lr}");
-  }
-
-  // TODO: Teensyduino 1.38 calls MillisTimer::runFromTimer() from SysTick
-  if (currentUseSystick) {
-    // we branch in order to preserve LR and the stack
-    __asm volatile("b context_switch");
+// Used by threads_memmanage_isr(): faults that are not a guard hit go on to
+// the handler that was installed before us
+extern "C" {
+  THREADS_ASM_SYMBOL IsrFunction stackGuardChainIsr;
+  THREADS_ASM_SYMBOL uint32_t threads_stack_guard_fault(uint32_t exc_return) {
+    return threads.stackGuardFault(exc_return);
   }
-  __asm volatile("bx lr");
 }
 
-void __attribute((naked, noinline)) threads_svcall_isr(void)
-{
-  if (Threads::save_svcall_isr) {
-    asm volatile("push {r0-r4,lr}");
-    (*Threads::save_svcall_isr)();
-    asm volatile("pop {r0-r4,lr}");
-  }
+#define STACK_GUARD_RASR (SCB_MPU_RASR_XN | SCB_MPU_RASR_AP(0) | SCB_MPU_RASR_SIZE(__builtin_ctz(STACK_GUARD_SIZE) - 1) | SCB_MPU_RASR_ENABLE)
+#define STACK_GUARD_FPCCR (*(volatile uint32_t *)0xE000EF34)
+#endif
 
-  // Get the right stack so we can extract the PC (next instruction)
-  // and then see the SVC calling instruction number
-  __asm volatile("TST lr, #4 \n"
-                 "ITE EQ \n"
-                 "MRSEQ r0, msp \n"
-                 "MRSNE r0, psp \n");
-  register unsigned int *rsp __asm("r0");
-  unsigned int svc = ((uint8_t*)rsp[6])[-2];
-  if (svc == Threads::SVC_NUMBER) {
-    __asm volatile("b context_switch_direct");
-  }
-  else if (svc == Threads::SVC_NUMBER_ACTIVE) {
-    currentActive = Threads::STARTED;
-    __asm volatile("b context_switch_direct_active");
-  }
-  __asm volatile("bx lr");
-}
+extern unsigned long _estack;   // the main thread 0 stack
+extern volatile uint32_t systick_millis_count;
 
 #ifdef __IMXRT1062__
 
@@ -134,18 +115,6 @@ void __attribute((naked, noinline)) threads_svcall_isr(void)
 
 extern "C" void unused_interrupt_vector(void);
 
-static void __attribute((naked, noinline)) gpt1_isr() {
-  GPT1_SR |= GPT_SR_OF1;  // clear set bit
-  __asm volatile ("dsb"); // see github bug #20 by manitou48
-  __asm volatile("b context_switch");
-}
-
-static void __attribute((naked, noinline)) gpt2_isr() {
-  GPT2_SR |= GPT_SR_OF1;  // clear set bit
-  __asm volatile ("dsb"); // see github bug #20 by manitou48
-  __asm volatile("b context_switch");
-}
-
 bool gtp1_init(unsigned int microseconds)
 {
   // Initialization code derived from @manitou48.
@@ -158,13 +127,13 @@ bool gtp1_init(unsigned int microseconds)
   // not configured yet, so find an inactive GPT timer
   if (gpt_number == 0) {
     if (! NVIC_IS_ENABLED(IRQ_GPT1)) {
-      attachInterruptVector(IRQ_GPT1, &gpt1_isr);
+      attachInterruptVector(IRQ_GPT1, &threads_gpt1_isr);
       NVIC_SET_PRIORITY(IRQ_GPT1, 255);
       NVIC_ENABLE_IRQ(IRQ_GPT1);
       gpt_number = 1;
     }
     else if (! NVIC_IS_ENABLED(IRQ_GPT2)) {
-      attachInterruptVector(IRQ_GPT2, &gpt2_isr);
+      attachInterruptVector(IRQ_GPT2, &threads_gpt2_isr);
       NVIC_SET_PRIORITY(IRQ_GPT2, 255);
       NVIC_ENABLE_IRQ(IRQ_GPT2);
       gpt_number = 2;
@@ -203,7 +172,17 @@ bool gtp1_init(unsigned int microseconds)
 
 #endif
 
-Threads::Threads() : current_thread(0), thread_count(0), thread_error(0) {
+Threads::Threads() : current_thread(0), thread_count(0), thread_error(0), ready_mask(0) {
+#ifdef THREADS_CYCLE_ACCOUNTING
+  window_start = 0;
+  window_length = 0;
+  ten_second_length = 0;
+  last_ten_second_length = 0;
+  window_seconds = 0;
+#endif
+#ifdef THREADS_SWITCH_PROFILING
+  resetSwitchProfile();
+#endif
   // initilize thread slots to empty
   for(int i=1; i<MAX_THREADS; i++) {
     threadp[i] = NULL;
@@ -227,10 +206,28 @@ Threads::Threads() : current_thread(0), thread_count(0), thread_error(0) {
 #ifdef __IMXRT1062__
 
   // commandeer SVCall & use GTP1 Interrupt
-  save_svcall_isr = _VectorsRam[11];
-  if (save_svcall_isr == unused_interrupt_vector) save_svcall_isr = 0;
+  saveSvcallIsr = _VectorsRam[11];
+  if (saveSvcallIsr == unused_interrupt_vector) saveSvcallIsr = 0;
   _VectorsRam[11] = threads_svcall_isr;
 
+#ifdef THREADS_MPU_GUARD
+  // thread 0 and the interrupts share MSP: a fixed guard between it and .bss.
+  // Thread 0 itself leaves the per-thread region off.
+  SCB_MPU_RBAR = ((((uint32_t)&_ebss) + STACK_GUARD_SIZE - 1) & ~(STACK_GUARD_SIZE - 1)) |
+                 SCB_MPU_RBAR_REGION(THREADS_MPU_MAIN_GUARD_REGION) | SCB_MPU_RBAR_VALID;
+  SCB_MPU_RASR = STACK_GUARD_RASR;
+  threadp[0]->guard_rbar = SCB_MPU_RBAR_REGION(THREADS_MPU_GUARD_REGION) | SCB_MPU_RBAR_VALID;
+  threadp[0]->guard_rasr = 0;
+  SCB_MPU_RBAR = threadp[0]->guard_rbar;
+  SCB_MPU_RASR = threadp[0]->guard_rasr;
+
+  // commandeer MemManage to catch guard hits
+  stackGuardChainIsr = _VectorsRam[4];
+  _VectorsRam[4] = threads_memmanage_isr;
+  SCB_SHCSR |= SCB_SHCSR_MEMFAULTENA;
+  __asm volatile("dsb \n isb");
+#endif
+
   currentUseSystick = 0; // disable Systick calls
   gtp1_init(1000);       // tick every millisecond
 
@@ -239,15 +236,15 @@ Threads::Threads() : current_thread(0), thread_count(0), thread_error(0) {
   currentUseSystick = 1;
 
   // commandeer the SVCall & SysTick Exceptions
-  save_svcall_isr = _VectorsRam[11];
-  if (save_svcall_isr == unused_isr) save_svcall_isr = 0;
+  saveSvcallIsr = _VectorsRam[11];
+  if (saveSvcallIsr == unused_isr) saveSvcallIsr = 0;
   _VectorsRam[11] = threads_svcall_isr;
   
-  save_systick_isr = _VectorsRam[15];
-  if (save_systick_isr == unused_isr) save_systick_isr = 0;
+  saveSystickIsr = _VectorsRam[15];
+  if (saveSystickIsr == unused_isr) saveSystickIsr = 0;
   _VectorsRam[15] = threads_systick_isr;
 
-#ifdef DEBUG
+#ifdef THREADS_CYCLE_ACCOUNTING
 #if defined(__MK20DX256__) || defined(__MK20DX128__)
   ARM_DEMCR |= ARM_DEMCR_TRCENA; // Make ssure Cycle Counter active
   ARM_DWT_CTRL |= ARM_DWT_CTRL_CYCCNTENA;
@@ -290,22 +287,35 @@ int Threads::stop() {
  */
 void Threads::getNextThread() {
 
-#ifdef DEBUG
+#ifdef THREADS_SWITCH_PROFILING
+  uint32_t switch_start = ARM_DWT_CYCCNT;
+#endif
+
+#ifdef THREADS_CYCLE_ACCOUNTING
   // Keep track of the number of cycles expended by each thread.
   // See @dfragster: https://forum.pjrc.com/threads/41504-Teensy-3-x-multithreading-library-first-release?p=213086#post213086
-  currentThread->cyclesAccum += ARM_DWT_CYCCNT - currentThread->cyclesStart;
+  uint32_t switch_now = ARM_DWT_CYCCNT;
+  uint32_t run = switch_now - currentThread->cyclesStart;
+  currentThread->cyclesAccum += run;
+  currentThread->windowCycles += run;
+  if (run > currentThread->runMax) currentThread->runMax = run;
+  if (switch_now - window_start >= THREADS_CYCLES_PER_SECOND) rollWindows(switch_now);
 #endif
 
   // First, save the currentSP set by context_switch
   currentThread->sp = currentSP;
 
+#ifndef THREADS_MPU_GUARD
   // did we overflow the stack (don't check thread 0)?
-  // allow an extra 8 bytes for a call to the ISR and one additional call or variable
+  // allow an extra 8 bytes for a call to the ISR and one additional call or variable.
+  // The MPU guard catches this at the access instead
   if (current_thread && ((uint8_t*)currentThread->sp - currentThread->stack <= overflow_stack_size)) {
     stack_overflow_isr();
   }
+#endif
 
   // Find the next running thread
+#ifdef THREADS_LINEAR_SCAN
   while(1) {
     current_thread++;
     if (current_thread >= MAX_THREADS) {
@@ -314,6 +324,21 @@ void Threads::getNextThread() {
     }
     if (threadp[current_thread] && threadp[current_thread]->flags == RUNNING) break;
   }
+#else
+  // Lowest ready id after the current one keeps the round-robin order;
+  // none left means the round ends on thread 0 (MSP, always active).
+  // A stale bit costs one extra pass, after which it is gone.
+  while(1) {
+    uint32_t later = ready_mask & ~((2UL << current_thread) - 1);
+    if (!later) {
+      current_thread = 0;
+      break;
+    }
+    current_thread = __builtin_ctz(later);
+    if (threadp[current_thread]->flags == RUNNING) break;
+    markNotReady(current_thread);
+  }
+#endif
   currentCount = threadp[current_thread]->ticks;
 
   currentThread = threadp[current_thread];
@@ -321,9 +346,76 @@ void Threads::getNextThread() {
   currentMSP = (current_thread==0?1:0);
   currentSP = threadp[current_thread]->sp;
 
-#ifdef DEBUG
-  currentThread->cyclesStart = ARM_DWT_CYCCNT;
+#ifdef THREADS_MPU_GUARD
+  // arm the incoming thread's guard; the exception return completes the update
+  SCB_MPU_RBAR = currentThread->guard_rbar;
+  SCB_MPU_RASR = currentThread->guard_rasr;
+  __asm volatile("dsb");
+#endif
+
+#ifdef THREADS_CYCLE_ACCOUNTING
+  // the switch itself is charged to the incoming thread, so the windows add up to wall time
+  currentThread->cyclesStart = switch_now;
+#endif
+
+#ifdef THREADS_SWITCH_PROFILING
+  uint32_t switch_cost = ARM_DWT_CYCCNT - switch_start;
+  switch_cycles += switch_cost;
+  if (switch_cost > switch_cycles_max) switch_cycles_max = switch_cost;
+  switch_count++;
+#endif
+}
+
+#ifdef THREADS_CYCLE_ACCOUNTING
+/*
+ * rollWindows() - Close the 1 s window (and every tenth one, the 10 s window)
+ *
+ * Runs from getNextThread() about once a second, the only O(threads) step.
+ */
+void Threads::rollWindows(uint32_t now) {
+  window_length = now - window_start;
+  ten_second_length += window_length;
+  window_start = now;
+
+  bool ten_seconds = ++window_seconds >= 10;
+  if (ten_seconds) {
+    last_ten_second_length = ten_second_length;
+    ten_second_length = 0;
+    window_seconds = 0;
+  }
+
+  for (int i = 0; i < MAX_THREADS; i++) {
+    ThreadInfo *tp = threadp[i];
+    if (tp == NULL) continue;
+    tp->lastSecond = tp->windowCycles;
+    tp->tenSecondCycles += tp->windowCycles;
+    tp->windowCycles = 0;
+    if (ten_seconds) {
+      tp->lastTenSeconds = tp->tenSecondCycles;
+      tp->tenSecondCycles = 0;
+    }
+  }
+}
+#endif
+
+#ifdef THREADS_SWITCH_PROFILING
+void Threads::resetSwitchProfile() {
+  __disable_irq();
+  switch_cycles = 0;
+  switch_cycles_max = 0;
+  switch_count = 0;
+  __enable_irq();
+}
 #endif
+
+/*
+ * setFlags() - Change a thread's state and keep the ready queue in step
+ */
+void Threads::setFlags(int id, int state) {
+  threadp[id]->flags = state;
+  if (id == 0) return;
+  if (state == RUNNING) markReady(id);
+  else markNotReady(id);
 }
 
 /*
@@ -334,7 +426,9 @@ void Threads::getNextThread() {
 /*
  * Store the PIT timer flag register for use in assembly
  */
-volatile uint32_t *context_timer_flag;
+extern "C" {
+  THREADS_ASM_SYMBOL volatile uint32_t *context_timer_flag;
+}
 
 /*
  * Defined in assembly code
@@ -427,6 +521,7 @@ void Threads::del_process(void)
   // }
   threads.thread_count--;
   me->flags = ENDED; //clear the flags so thread can stop and be reused
+  threads.markNotReady(threads.current_thread);
   threads.start(old_state);
   while(1); // just in case, keep working until context change when execution will not return to this thread
 }
@@ -443,6 +538,18 @@ void Threads::setStackMarker(void *stack)
   *m = thread_marker;
 }
 
+/*
+ * A thread's marker is its stack's first word, or with the MPU guard the
+ * first word above the guard
+ */
+uint32_t *Threads::stackMarker(int id)
+{
+#ifdef THREADS_MPU_GUARD
+  if (id) return (uint32_t*)stackGuardEnd(threadp[id]);
+#endif
+  return (uint32_t*)threadp[id]->stack;
+}
+
 /*
  * Users call this function to see if stack has been corrupted
  */
@@ -451,7 +558,7 @@ int Threads::testStackMarkers(int *threadid)
   for (int i=0; i < MAX_THREADS; i++) {
     if (threadp[i] == NULL) continue;
     if (threadp[i]->flags == RUNNING) {
-      uint32_t *m = (uint32_t*)threadp[i]->stack;
+      uint32_t *m = stackMarker(i);
       if (*m != thread_marker) {
         if (threadid) *threadid = i;
         return -1;
@@ -461,6 +568,52 @@ int Threads::testStackMarkers(int *threadid)
   return 0;
 }
 
+#ifdef THREADS_MPU_GUARD
+/*
+ * Place the guard on the first aligned block of the stack; the marker goes
+ * right above it, so testStackMarkers() never reads inside it
+ */
+void Threads::setStackGuard(ThreadInfo *tp)
+{
+  uint32_t guard = ((uint32_t)tp->stack + STACK_GUARD_SIZE - 1) & ~(STACK_GUARD_SIZE - 1);
+  tp->guard_rbar = guard | SCB_MPU_RBAR_REGION(THREADS_MPU_GUARD_REGION) | SCB_MPU_RBAR_VALID;
+  tp->guard_rasr = STACK_GUARD_RASR;
+}
+
+/*
+ * stackGuardFault() - MemManage fault while the guards are armed
+ *
+ * A thread (thread mode, PSP) that touched its guard, or could not push an
+ * exception frame because of it, is reported to stack_overflow_isr() and
+ * ended: it resumes on a fresh frame at the top of its stack that runs
+ * del_process(). Returns the EXC_RETURN for that, or 0 for any other fault.
+ * An overflow with interrupts disabled escalates to HardFault instead.
+ */
+uint32_t Threads::stackGuardFault(uint32_t exc_return)
+{
+  const uint32_t MMFSR_MSTKERR = 1 << 4;    // stacking on exception entry
+  const uint32_t MMFSR_MLSPERR = 1 << 5;    // lazy FP stacking
+  const uint32_t MMFSR_MMARVALID = 1 << 7;  // MMFAR holds the address
+
+  if ((exc_return & 0xF) != 0xD || current_thread == 0) return 0;
+
+  ThreadInfo *tp = threadp[current_thread];
+  uint32_t mmfsr = SCB_CFSR & 0xFF;
+  uint32_t guard = (uint32_t)stackGuardEnd(tp) - STACK_GUARD_SIZE;
+  bool hit = (mmfsr & (MMFSR_MSTKERR | MMFSR_MLSPERR)) ||
+             ((mmfsr & MMFSR_MMARVALID) && SCB_MMFAR - guard < STACK_GUARD_SIZE);
+  if (!hit) return 0;
+
+  SCB_CFSR = mmfsr;                 // write one to clear
+  STACK_GUARD_FPCCR &= ~1UL;        // drop a lazy FP save aimed at the dead stack
+  stack_overflow_isr();
+
+  void *psp = loadstack((ThreadFunction)del_process, 0, tp->stack, tp->stack_size);
+  __asm volatile("MSR psp, %0" : : "r" (psp));
+  return 0xFFFFFFFD;                // thread mode, PSP, no FP state
+}
+#endif
+
 /*
  * Initializes a thread's stack. Called when thread is created
  */
@@ -511,24 +664,39 @@ int Threads::addThread(ThreadFunction p, void * arg, int stack_size, void *stack
         delete[] tp->stack;
       }
       if (stack==0) {
+#ifdef THREADS_MPU_GUARD
+        // new only aligns to 8: room for the guard and its padding on top
+        stack_size += 2 * STACK_GUARD_SIZE;
+#endif
         stack = new uint8_t[stack_size];
         tp->my_stack = 1;
       }
       else {
         tp->my_stack = 0;
       }
-      setStackMarker(stack);
+#ifdef THREADS_STACK_PROFILING
+      paintStack(stack, stack_size);
+#endif
       tp->stack = (uint8_t*)stack;
       tp->stack_size = stack_size;
+#ifdef THREADS_MPU_GUARD
+      setStackGuard(tp);
+#endif
+      setStackMarker(stackMarker(i));
       void *psp = loadstack(p, arg, tp->stack, tp->stack_size);
       tp->sp = psp;
       tp->ticks = DEFAULT_TICKS;
-      tp->flags = RUNNING;
       tp->save.lr = 0xFFFFFFF9;
+      setFlags(i, RUNNING);
 
-#ifdef DEBUG
+#ifdef THREADS_CYCLE_ACCOUNTING
       tp->cyclesStart = ARM_DWT_CYCCNT;
       tp->cyclesAccum = 0;
+      tp->runMax = 0;
+      tp->windowCycles = 0;
+      tp->lastSecond = 0;
+      tp->tenSecondCycles = 0;
+      tp->lastTenSeconds = 0;
 #endif
 
       currentActive = old_state;
@@ -548,7 +716,7 @@ int Threads::getState(int id)
 
 int Threads::setState(int id, int state)
 {
-  threadp[id]->flags = state;
+  setFlags(id, state);
   return state;
 }
 
@@ -569,19 +737,19 @@ int Threads::wait(int id, unsigned int timeout_ms)
 
 int Threads::kill(int id)
 {
-  threadp[id]->flags = ENDED;
+  setFlags(id, ENDED);
   return id;
 }
 
 int Threads::suspend(int id)
 {
-  threadp[id]->flags = SUSPENDED;
+  setFlags(id, SUSPENDED);
   return id;
 }
 
 int Threads::restart(int id)
 {
-  threadp[id]->flags = RUNNING;
+  setFlags(id, RUNNING);
   return id;
 }
 
@@ -712,13 +880,69 @@ int Threads::getStackRemaining(int id) {
   return (uint8_t*)threadp[id]->sp - threadp[id]->stack;
 }
 
-#ifdef DEBUG
+int Threads::getStackSize(int id) {
+  return threadp[id]->stack_size;
+}
+
+#ifdef THREADS_STACK_PROFILING
+/*
+ * Fill a whole stack with the marker, before the thread ever touches it
+ */
+void Threads::paintStack(void *stack, int stack_size)
+{
+  uint32_t *m = (uint32_t*)stack;
+  for (int i = 0; i < stack_size / (int)sizeof(uint32_t); i++) {
+    m[i] = thread_marker;
+  }
+}
+
+/*
+ * Stacks grow down, so the first overwritten word from the bottom is the
+ * deepest the thread has been. Thread 0's stack is not painted.
+ */
+int Threads::getStackHighWater(int id) {
+  if (id <= 0 || id >= MAX_THREADS || threadp[id] == NULL || threadp[id]->stack == NULL) return -1;
+  uint32_t *m = (uint32_t*)threadp[id]->stack;
+  int words = threadp[id]->stack_size / sizeof(uint32_t);
+  int untouched = 0;
+#ifdef THREADS_MPU_GUARD
+  // nothing gets past the guard (and its own thread may not even read it)
+  untouched = (stackGuardEnd(threadp[id]) - threadp[id]->stack) / sizeof(uint32_t);
+#endif
+  while (untouched < words && m[untouched] == thread_marker) untouched++;
+  return threadp[id]->stack_size - untouched * sizeof(uint32_t);
+}
+#endif
+
+#ifdef THREADS_CYCLE_ACCOUNTING
 unsigned long Threads::getCyclesUsed(int id) {
   stop();
   unsigned long ret = threadp[id]->cyclesAccum;
   start();
   return ret;
 }
+
+uint32_t Threads::getRunMax(int id, bool reset) {
+  if (id < 0 || id >= MAX_THREADS || threadp[id] == NULL) return 0;
+  int old_state = stop();
+  uint32_t ret = threadp[id]->runMax;
+  if (reset) threadp[id]->runMax = 0;
+  start(old_state);
+  return ret;
+}
+
+uint16_t Threads::getLoadPermille(int id, bool ten_seconds) {
+  if (id < 0 || id >= MAX_THREADS || threadp[id] == NULL) return 0;
+
+  // the windows only change inside getNextThread, so stopping switches keeps them consistent
+  int old_state = stop();
+  uint64_t used = ten_seconds ? threadp[id]->lastTenSeconds : threadp[id]->lastSecond;
+  uint64_t length = ten_seconds ? last_ten_second_length : window_length;
+  start(old_state);
+
+  if (length == 0) return 0;
+  return (uint16_t)(used * 1000 / length);
+}
 #endif
 
 /*
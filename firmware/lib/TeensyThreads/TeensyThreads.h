@@ -77,6 +77,74 @@
  */
 // #define DEBUG
 
+/* Per-thread cycle accounting, on unless THREADS_NO_CYCLE_ACCOUNTING is
+ * defined. Every switch charges the outgoing thread's run to it from the DWT
+ * cycle counter (a few cycles); once a second the totals roll into 1 s and
+ * 10 s windows. Gives:
+ *   getCyclesUsed(), getRunMax(), getLoadPermille()
+ */
+#if !defined(THREADS_NO_CYCLE_ACCOUNTING) || defined(DEBUG)
+#define THREADS_CYCLE_ACCOUNTING
+#endif
+
+/* Maximum number of threads, including thread 0. The ready queue is a
+ * 32 bit bitmap, so this can go up to 32.
+ */
+#ifndef THREADS_MAX_THREADS
+#define THREADS_MAX_THREADS 16
+#endif
+
+/* Measure the scheduler's share of every context switch in DWT cycles:
+ *   getSwitchCycles(), getSwitchCyclesMax(), getSwitchCount()
+ * Define THREADS_LINEAR_SCAN as well to measure the original linear search
+ * for comparison.
+ */
+// #define THREADS_SWITCH_PROFILING
+// #define THREADS_LINEAR_SCAN
+
+/* Paint every new stack with the marker pattern so the deepest use can be
+ * read back later:
+ *   getStackHighWater()
+ */
+// #define THREADS_STACK_PROFILING
+
+/* On Teensy 4 every thread stack starts with a THREADS_MPU_GUARD_SIZE byte
+ * no-access MPU region, its marker word right above it, so an overflow
+ * faults at the offending access instead of being found at the next switch
+ * (if at all). Only the running thread's guard is armed, reprogrammed on each
+ * switch; thread 0 runs on MSP and keeps a fixed guard at the end of .bss. A
+ * thread that hits its guard is reported to stack_overflow_isr() and ended.
+ *
+ * The guard replaces the scheduler's check of the saved stack pointer, so it
+ * has to be wider than anything a thread moves its stack pointer by in one
+ * go: the 64 bytes of slack that check allowed plus the largest frame. Build
+ * with -Wframe-larger-than=(THREADS_MPU_GUARD_SIZE - 64) to hold every frame
+ * to that. Stacks handed to addThread() should be THREADS_STACK_ALIGN
+ * aligned, or up to a guard's worth of them goes to padding; the ones
+ * addThread() allocates get room for the guard on top of stack_size.
+ * THREADS_NO_MPU_GUARD brings the scheduler's check back instead.
+ */
+#if defined(__IMXRT1062__) && !defined(THREADS_NO_MPU_GUARD)
+#define THREADS_MPU_GUARD
+#endif
+#ifndef THREADS_MPU_GUARD_SIZE
+#define THREADS_MPU_GUARD_SIZE 512        // a power of two, 32 at least
+#endif
+#ifdef THREADS_MPU_GUARD
+#define THREADS_STACK_ALIGN THREADS_MPU_GUARD_SIZE
+#else
+#define THREADS_STACK_ALIGN 8
+#endif
+#ifndef THREADS_MPU_GUARD_REGION
+#define THREADS_MPU_GUARD_REGION 15       // running thread's guard
+#endif
+#ifndef THREADS_MPU_MAIN_GUARD_REGION
+#define THREADS_MPU_MAIN_GUARD_REGION 14  // thread 0 / MSP guard
+#endif
+
+// Implemented in TeensyThreads-asm.S (kept out of LTO), entered from the
+// vector table or by branching; the globals they use are listed in
+// TeensyThreads.cpp
 extern "C" {
   void context_switch(void);
   void context_switch_direct(void);
@@ -85,6 +153,10 @@ extern "C" {
   void stack_overflow_isr(void);
   void threads_svcall_isr(void);
   void threads_systick_isr(void);
+  void threads_gpt1_isr(void);
+  void threads_gpt2_isr(void);
+  void threads_memmanage_isr(void);
+  uint32_t threads_stack_guard_fault(uint32_t exc_return);
 }
 
 // The stack frame saved by the interrupt
@@ -158,9 +230,18 @@ class ThreadInfo {
     void *sp;
     int ticks;
     volatile int sleep_time_till_end_tick; // Per-task sleep time
-#ifdef DEBUG
+#ifdef THREADS_MPU_GUARD
+    uint32_t guard_rbar;        // MPU base/region word of the stack guard
+    uint32_t guard_rasr;        // and its attributes, 0 leaves the region off
+#endif
+#ifdef THREADS_CYCLE_ACCOUNTING
     unsigned long cyclesStart;  // On T_4 the CycCnt is always active - on T_3.x it currently is not - unless Audio starts it AFAIK
     unsigned long cyclesAccum;
+    uint32_t runMax;            // longest single run, cycles
+    uint32_t windowCycles;      // current 1 s window
+    uint32_t lastSecond;        // last complete 1 s window
+    uint64_t tenSecondCycles;   // current 10 s window
+    uint64_t lastTenSeconds;    // last complete 10 s window
 #endif
 };
 
@@ -179,11 +260,12 @@ typedef void (*IsrFunction)();
  */
 class Threads {
 public:
-  // The maximum number of threads is hard-coded to simplify
-  // the implementation. See notes of ThreadInfo.
+  // The maximum number of threads is fixed at compile time (THREADS_MAX_THREADS)
+  // to simplify the implementation. See notes of ThreadInfo.
   int DEFAULT_TICKS = 10;
   int DEFAULT_STACK_SIZE = 1024;
-  static const int MAX_THREADS = 16;
+  static const int MAX_THREADS = THREADS_MAX_THREADS;
+  static_assert(MAX_THREADS >= 2 && MAX_THREADS <= 32, "the ready bitmap holds 32 threads");
   static const int DEFAULT_STACK0_SIZE = 10240; // estimate for thread 0?
   static const int DEFAULT_TICK_MICROSECONDS = 100;
 
@@ -219,11 +301,32 @@ protected:
   // This used to be allocated statically, as below. Kept for reference in case of bugs.
   // ThreadInfo thread[MAX_THREADS];
 
-  ThreadFunctionSleep enter_sleep_callback = NULL;
+  /*
+   * Ready queue: bit n is set when thread n may be RUNNING. Every change to
+   * RUNNING sets the bit; changes away from it clear the bit where they go
+   * through this class, and getNextThread() drops any bit whose thread turns
+   * out not to be RUNNING (flags written directly). Thread 0 is never in it,
+   * it runs whenever nothing later in the round is ready. Updated with
+   * exclusive load/store, so suspend() and restart() stay safe from ISRs.
+   */
+  volatile uint32_t ready_mask;
+
+#ifdef THREADS_CYCLE_ACCOUNTING
+  uint32_t window_start;            // cycle count the current 1 s window began at
+  uint32_t window_length;           // cycles in the last complete 1 s window
+  uint64_t ten_second_length;       // cycles in the current 10 s window so far
+  uint64_t last_ten_second_length;  // cycles in the last complete 10 s window
+  uint8_t  window_seconds;          // complete 1 s windows in the current 10 s one
+  void rollWindows(uint32_t now);
+#endif
 
-public: // public for debugging
-  static IsrFunction save_systick_isr;
-  static IsrFunction save_svcall_isr;
+#ifdef THREADS_SWITCH_PROFILING
+  volatile uint32_t switch_cycles;
+  volatile uint32_t switch_cycles_max;
+  volatile uint32_t switch_count;
+#endif
+
+  ThreadFunctionSleep enter_sleep_callback = NULL;
 
 public:
   Threads();
@@ -277,8 +380,25 @@ public:
   int id();
   int getStackUsed(int id);
   int getStackRemaining(int id);
-#ifdef DEBUG
+  int getStackSize(int id);
+#ifdef THREADS_STACK_PROFILING
+  // Deepest the stack has ever been, in bytes (scans the painted stack)
+  int getStackHighWater(int id);
+#endif
+#ifdef THREADS_CYCLE_ACCOUNTING
+  // Cycles the thread has run since it was created (wraps)
   unsigned long getCyclesUsed(int id);
+  // Longest single run of the thread in cycles; reset clears it. Unused ids read 0
+  uint32_t getRunMax(int id, bool reset = false);
+  // Share of the CPU the thread got over the last complete 1 s (or 10 s) window, in 1/1000
+  uint16_t getLoadPermille(int id, bool ten_seconds = false);
+#endif
+#ifdef THREADS_SWITCH_PROFILING
+  // Cycles spent choosing the next thread: total, worst case and number of switches
+  uint32_t getSwitchCycles() { return switch_cycles; }
+  uint32_t getSwitchCyclesMax() { return switch_cycles_max; }
+  uint32_t getSwitchCount() { return switch_count; }
+  void resetSwitchProfile();
 #endif
 
   // Yield current thread's remaining time slice to the next thread, causing immediate
@@ -303,13 +423,28 @@ public:
   friend void threads_systick_isr(void);
   friend void threads_svcall_isr(void);
   friend void loadNextThread();
+  friend uint32_t threads_stack_guard_fault(uint32_t exc_return);
   friend class ThreadLock;
 
 protected:
   void getNextThread();
+  void markReady(int id) { __atomic_fetch_or(&ready_mask, 1UL << id, __ATOMIC_RELAXED); }
+  void markNotReady(int id) { __atomic_fetch_and(&ready_mask, ~(1UL << id), __ATOMIC_RELAXED); }
+  void setFlags(int id, int state);
   void *loadstack(ThreadFunction p, void * arg, void *stackaddr, int stack_size);
   static void force_switch_isr();
   void setStackMarker(void *stack);
+  uint32_t *stackMarker(int id);
+#ifdef THREADS_STACK_PROFILING
+  void paintStack(void *stack, int stack_size);
+#endif
+#ifdef THREADS_MPU_GUARD
+  static const uint32_t STACK_GUARD_SIZE = THREADS_MPU_GUARD_SIZE;
+  static_assert(STACK_GUARD_SIZE >= 32 && (STACK_GUARD_SIZE & (STACK_GUARD_SIZE - 1)) == 0, "an MPU region is a power of two, 32 bytes at least");
+  void setStackGuard(ThreadInfo *tp);
+  static uint8_t *stackGuardEnd(ThreadInfo *tp) { return (uint8_t*)(tp->guard_rbar & ~(STACK_GUARD_SIZE - 1)) + STACK_GUARD_SIZE; }
+  uint32_t stackGuardFault(uint32_t exc_return);
+#endif
 
 private:
   static void del_process(void);
@@ -0,0 +1,185 @@
+#include <Arduino.h>
+#include "deadline_timer.h"
+
+deadline_timer::deadline_timer() :
+    heap_size_(0),
+    expired_count_(0),
+    timer_running_(false)
+{
+    for (uint8_t i = 0; i < k_max_deadlines; ++i) {
+        heap_[i] = 0;
+    }
+}
+
+deadline_timer& deadline_timer::shared() {
+    static deadline_timer instance;
+    return instance;
+}
+
+deadline_timer::handle_t deadline_timer::arm(uint32_t timeout_us, expiry_callback_t callback, void* context) {
+    if (!callback) {
+        return k_invalid_handle;
+    }
+
+    __disable_irq();
+
+    uint8_t slot_index = k_max_deadlines;
+    for (uint8_t i = 0; i < k_max_deadlines; ++i) {
+        if (!slots_[i].armed) {
+            slot_index = i;
+            break;
+        }
+    }
+
+    if (slot_index == k_max_deadlines) {
+        __enable_irq();
+        return k_invalid_handle;
+    }
+
+    uint32_t now_us = micros();
+    slot_t& slot = slots_[slot_index];
+    slot.deadline_us = now_us + timeout_us;
+    slot.callback = callback;
+    slot.context = context;
+    slot.armed = true;
+    slot.generation++;
+
+    uint8_t position = heap_size_++;
+    heap_[position] = slot_index;
+    slot.heap_position = position;
+    sift_up(position);
+
+    // Only a new head changes what the PIT should be counting towards
+    if (slot.heap_position == 0) {
+        reprogram(now_us);
+    }
+
+    handle_t handle = static_cast<handle_t>((slot.generation << 8) | slot_index);
+    __enable_irq();
+
+    return handle;
+}
+
+bool deadline_timer::cancel(handle_t handle) {
+    uint8_t slot_index = handle & 0xFF;
+    uint8_t generation = handle >> 8;
+
+    if (handle == k_invalid_handle || slot_index >= k_max_deadlines) {
+        return false;
+    }
+
+    __disable_irq();
+    slot_t& slot = slots_[slot_index];
+    if (!slot.armed || slot.generation != generation) {
+        __enable_irq();
+        return false;
+    }
+
+    bool was_head = slot.heap_position == 0;
+    remove_at(slot.heap_position);
+
+    if (was_head) {
+        reprogram(micros());
+    }
+    __enable_irq();
+
+    return true;
+}
+
+void deadline_timer::swap_nodes(uint8_t a, uint8_t b) {
+    uint8_t slot_a = heap_[a];
+    uint8_t slot_b = heap_[b];
+    heap_[a] = slot_b;
+    heap_[b] = slot_a;
+    slots_[slot_b].heap_position = a;
+    slots_[slot_a].heap_position = b;
+}
+
+void deadline_timer::sift_up(uint8_t position) {
+    while (position > 0) {
+        uint8_t parent = (position - 1) / 2;
+        if (!earlier(slots_[heap_[position]].deadline_us, slots_[heap_[parent]].deadline_us)) {
+            break;
+        }
+        swap_nodes(position, parent);
+        position = parent;
+    }
+}
+
+void deadline_timer::sift_down(uint8_t position) {
+    while (true) {
+        uint8_t left = 2 * position + 1;
+        uint8_t right = left + 1;
+        uint8_t smallest = position;
+
+        if (left < heap_size_ && earlier(slots_[heap_[left]].deadline_us, slots_[heap_[smallest]].deadline_us)) {
+            smallest = left;
+        }
+        if (right < heap_size_ && earlier(slots_[heap_[right]].deadline_us, slots_[heap_[smallest]].deadline_us)) {
+            smallest = right;
+        }
+        if (smallest == position) {
+            break;
+        }
+        swap_nodes(position, smallest);
+        position = smallest;
+    }
+}
+
+void deadline_timer::remove_at(uint8_t position) {
+    slots_[heap_[position]].armed = false;
+
+    uint8_t last = --heap_size_;
+    if (position == last) {
+        return;
+    }
+
+    uint8_t moved_slot = heap_[last];
+    swap_nodes(position, last);
+
+    // The moved node may belong above or below its new spot
+    sift_up(position);
+    sift_down(slots_[moved_slot].heap_position);
+}
+
+void deadline_timer::reprogram(uint32_t now_us) {
+    if (heap_size_ == 0) {
+        if (timer_running_) {
+            timer_.end();
+            timer_running_ = false;
+        }
+        return;
+    }
+
+    uint32_t head_deadline = slots_[heap_[0]].deadline_us;
+    uint32_t delay_us = earlier(now_us, head_deadline) ? head_deadline - now_us : 0;
+    if (delay_us < k_min_arm_micros) {
+        delay_us = k_min_arm_micros;
+    }
+
+    // begin() on a running channel just reloads it
+    timer_.begin(timer_isr, delay_us);
+    timer_running_ = true;
+}
+
+void deadline_timer::service_expired() {
+    uint32_t now_us = micros();
+
+    while (heap_size_ > 0 && !earlier(now_us, slots_[heap_[0]].deadline_us)) {
+        slot_t& slot = slots_[heap_[0]];
+        expiry_callback_t callback = slot.callback;
+        void* context = slot.context;
+
+        remove_at(0);
+        expired_count_++;
+        callback(context);
+
+        now_us = micros();
+    }
+
+    reprogram(now_us);
+}
+
+void deadline_timer::timer_isr() {
+    shared().service_expired();
+}
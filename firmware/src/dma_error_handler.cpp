@@ -11,7 +11,10 @@ dma_error_handler::dma_error_handler(const error_config_t& config) :
     log_count_(0),
     config_(config),
     total_operations_(0),
-    last_statistics_update_(0)
+    last_statistics_update_(0),
+    fault_injector_(nullptr),
+    reset_callback_(nullptr),
+    reset_user_data_(nullptr)
 {
     // Initialize error log array
     for (uint8_t i = 0; i < MAX_ERROR_LOG_ENTRIES; ++i) {
@@ -53,6 +56,10 @@ dma_error_handler::recovery_strategy_t dma_error_handler::handle_error(
     recovery_state_.last_error_time[dac_index] = event.timestamp_us;
     error_mutex_.unlock();
     
+    if (fault_injector_) {
+        fault_injector_->on_recovery_strategy(dac_index, static_cast<uint8_t>(event.recovery));
+    }
+    
     return event.recovery;
 }
 
@@ -62,8 +69,15 @@ bool dma_error_handler::execute_recovery(const error_event_t& error_event) {
             return retry_operation(error_event.dac_index, error_event.retry_count + 1);
             
         case recovery_strategy_t::RETRY_WITH_DELAY: {
-            uint32_t delay_ms = calculate_retry_delay(error_event.retry_count);
-            delay(delay_ms);
+            // Called from the DAC worker (or the event loop): no sleeping here, the worker
+            // holds its frames until may_retry() says the backoff is over
+            if (error_event.dac_index < 4) {
+                uint32_t delay_ms = calculate_retry_delay(error_event.retry_count);
+                error_mutex_.lock();
+                recovery_state_.retry_at_ms[error_event.dac_index] = millis() + delay_ms;
+                recovery_state_.backing_off[error_event.dac_index] = true;
+                error_mutex_.unlock();
+            }
             return retry_operation(error_event.dac_index, error_event.retry_count + 1);
         }
         
@@ -78,13 +92,8 @@ bool dma_error_handler::execute_recovery(const error_event_t& error_event) {
             return false;
             
         case recovery_strategy_t::RESET_PERIPHERAL:
-            if (config_.enable_peripheral_reset && should_reset_peripheral(error_event.dac_index)) {
-                reset_peripheral(error_event.dac_index);
-                error_mutex_.lock();
-                statistics_.peripheral_resets++;
-                recovery_state_.peripheral_reset_count++;
-                error_mutex_.unlock();
-                return true;
+            if (config_.enable_peripheral_reset && should_reset_peripheral(error_event)) {
+                return reset_peripheral(error_event.dac_index);
             }
             return false;
             
@@ -100,6 +109,19 @@ bool dma_error_handler::execute_recovery(const error_event_t& error_event) {
     }
 }
 
+bool dma_error_handler::may_retry(uint8_t dac_index, uint32_t now_millis) {
+    if (dac_index >= 4 || !recovery_state_.backing_off[dac_index]) {
+        return true;
+    }
+    
+    if (static_cast<int32_t>(now_millis - recovery_state_.retry_at_ms[dac_index]) < 0) {
+        return false;
+    }
+    
+    recovery_state_.backing_off[dac_index] = false;
+    return true;
+}
+
 bool dma_error_handler::retry_operation(uint8_t dac_index, uint8_t retry_count) {
     if (retry_count >= config_.max_retry_attempts) {
         return false;
@@ -119,6 +141,9 @@ void dma_error_handler::enable_sync_fallback(uint8_t dac_index) {
     if (dac_index < 4) {
         error_mutex_.lock();
         recovery_state_.fallback_mode[dac_index] = true;
+        if (recovery_state_.transport[dac_index]) {
+            recovery_state_.transport[dac_index]->select(transport_arbiter::transport_t::SYNC);
+        }
         error_mutex_.unlock();
     }
 }
@@ -127,6 +152,21 @@ void dma_error_handler::disable_sync_fallback(uint8_t dac_index) {
     if (dac_index < 4) {
         error_mutex_.lock();
         recovery_state_.fallback_mode[dac_index] = false;
+        if (recovery_state_.transport[dac_index]) {
+            recovery_state_.transport[dac_index]->select(transport_arbiter::transport_t::DMA);
+        }
+        error_mutex_.unlock();
+    }
+}
+
+void dma_error_handler::attach_transport_arbiter(uint8_t dac_index, transport_arbiter* arbiter) {
+    if (dac_index < 4) {
+        error_mutex_.lock();
+        recovery_state_.transport[dac_index] = arbiter;
+        if (arbiter) {
+            arbiter->select(recovery_state_.fallback_mode[dac_index] ?
+                            transport_arbiter::transport_t::SYNC : transport_arbiter::transport_t::DMA);
+        }
         error_mutex_.unlock();
     }
 }
@@ -138,6 +178,11 @@ bool dma_error_handler::is_sync_fallback_active(uint8_t dac_index) const {
 void dma_error_handler::notify_success(uint8_t dac_index) {
     if (dac_index >= 4) return;
     
+    if (fault_injector_) {
+        // Sync fallback writes count as recovered output too, not just DMA completions
+        fault_injector_->on_transfer_result(dac_index, drivers::dma_i2c_hal::error_code_t::SUCCESS);
+    }
+    
     error_mutex_.lock();
     // Reset consecutive error count on success
     recovery_state_.consecutive_errors[dac_index] = 0;
@@ -214,6 +259,9 @@ dma_error_handler::recovery_strategy_t dma_error_handler::determine_recovery_str
         case drivers::dma_i2c_hal::error_code_t::TIMEOUT:
             if (error_event.retry_count < config_.max_retry_attempts) {
                 return recovery_strategy_t::RETRY_WITH_DELAY;
+            } else if (config_.enable_peripheral_reset && reset_callback_) {
+                // Timeouts that survive the retries are what a slave holding SDA looks like
+                return recovery_strategy_t::RESET_PERIPHERAL;
             } else {
                 return recovery_strategy_t::FALLBACK_TO_SYNC;
             }
@@ -281,9 +329,12 @@ void dma_error_handler::update_statistics() {
 }
 
 uint32_t dma_error_handler::calculate_retry_delay(uint8_t retry_count) {
-    // Exponential backoff with jitter
-    uint32_t delay = config_.retry_delay_base_ms << retry_count; // 2^retry_count
-    delay = min(delay, config_.retry_delay_max_ms);
+    // Exponential backoff with jitter; the shift stops where it would pass the maximum,
+    // long before it could run off the 32 bits
+    uint32_t delay = config_.retry_delay_max_ms;
+    if (retry_count < 32 && config_.retry_delay_base_ms <= (config_.retry_delay_max_ms >> retry_count)) {
+        delay = config_.retry_delay_base_ms << retry_count; // 2^retry_count
+    }
     
     // Add small random jitter (10% of delay)
     uint32_t jitter = delay / 10;
@@ -294,21 +345,59 @@ uint32_t dma_error_handler::calculate_retry_delay(uint8_t retry_count) {
     return delay;
 }
 
-bool dma_error_handler::should_reset_peripheral(uint8_t dac_index) {
-    if (dac_index >= 4) return false;
+bool dma_error_handler::should_reset_peripheral(const error_event_t& error_event) {
+    if (error_event.dac_index >= 4) return false;
+    
+    // Persistent timeouts already went through the retries
+    if (error_event.error_code == drivers::dma_i2c_hal::error_code_t::TIMEOUT &&
+        error_event.retry_count >= config_.max_retry_attempts) {
+        return true;
+    }
     
     // Reset if consecutive errors exceed threshold
-    return recovery_state_.consecutive_errors[dac_index] > 10;
+    return recovery_state_.consecutive_errors[error_event.dac_index] > 10;
 }
 
-void dma_error_handler::reset_peripheral(uint8_t dac_index) {
-    // Placeholder for peripheral reset logic
-    // In actual implementation, this would reset the specific I2C peripheral
+bool dma_error_handler::reset_peripheral(uint8_t dac_index) {
     Serial.print(F("Resetting I2C peripheral for DAC "));
     Serial.println(dac_index);
     
-    // Reset consecutive error count
-    recovery_state_.consecutive_errors[dac_index] = 0;
+    if (fault_injector_) {
+        // An injected stuck bus is released by the same reset that would free a real one
+        fault_injector_->release_stuck_bus(dac_index);
+    }
+    
+    uint32_t start_time = micros();
+    bool recovered = reset_callback_ ? reset_callback_(dac_index, reset_user_data_) : false;
+    uint32_t reset_time = micros() - start_time;
+    
+    error_mutex_.lock();
+    statistics_.peripheral_resets++;
+    recovery_state_.peripheral_reset_count++;
+    statistics_.last_reset_time_us = reset_time;
+    if (reset_time > statistics_.max_reset_time_us) {
+        statistics_.max_reset_time_us = reset_time;
+    }
+    statistics_.average_reset_time_us = (statistics_.peripheral_resets == 1) ? reset_time :
+        (statistics_.average_reset_time_us * 7 + reset_time) / 8;
+    
+    if (recovered) {
+        statistics_.successful_recoveries++;
+        recovery_state_.consecutive_errors[dac_index] = 0;
+    } else {
+        statistics_.failed_recoveries++;
+        statistics_.failed_peripheral_resets++;
+    }
+    error_mutex_.unlock();
+    
+    return recovered;
+}
+
+void dma_error_handler::set_peripheral_reset_callback(peripheral_reset_callback_t callback, void* user_data) {
+    error_mutex_.lock();
+    reset_callback_ = callback;
+    reset_user_data_ = user_data;
+    error_mutex_.unlock();
 }
 
 const dma_error_handler::error_event_t* dma_error_handler::get_error_log(uint8_t& count) const {
@@ -387,27 +476,85 @@ const char* dma_error_handler::recovery_strategy_to_string(recovery_strategy_t s
     }
 }
 
+void dma_error_handler::print_fault_latency_report() const {
+    if (!fault_injector_) {
+        Serial.println(F("No fault injector attached"));
+        return;
+    }
+    
+    Serial.println(F("\n=== Fault Recovery Latency ==="));
+    
+    for (uint8_t f = 1; f < drivers::i2c_fault_injector::k_fault_types; ++f) {
+        drivers::i2c_fault_injector::fault_t fault = static_cast<drivers::i2c_fault_injector::fault_t>(f);
+        uint32_t injected = fault_injector_->get_injected_count(fault);
+        if (injected == 0) {
+            continue;
+        }
+        
+        Serial.print(drivers::i2c_fault_injector::fault_to_string(fault));
+        Serial.print(F(" (injected "));
+        Serial.print(injected);
+        Serial.println(F(")"));
+        
+        for (uint8_t s = 0; s < drivers::i2c_fault_injector::k_strategy_slots; ++s) {
+            const drivers::i2c_fault_injector::latency_statistics_t& stats =
+                fault_injector_->get_latency_statistics(fault, s);
+            if (stats.samples == 0) {
+                continue;
+            }
+            
+            Serial.print(F("  "));
+            Serial.print(recovery_strategy_to_string(static_cast<recovery_strategy_t>(s)));
+            Serial.print(F(": n="));
+            Serial.print(stats.samples);
+            Serial.print(F(" detect avg/max "));
+            Serial.print(stats.average_detect_us);
+            Serial.print(F("/"));
+            Serial.print(stats.max_detect_us);
+            Serial.print(F(" μs, recover avg/max "));
+            Serial.print(stats.average_recover_us);
+            Serial.print(F("/"));
+            Serial.print(stats.max_recover_us);
+            Serial.println(F(" μs"));
+        }
+    }
+}
+
 // dma_timeout_watchdog implementation
 
 dma_timeout_watchdog::dma_timeout_watchdog(dma_error_handler* error_handler, 
                                           const watchdog_config_t& config) :
     config_(config),
     error_handler_(error_handler),
-    watchdog_active_(false)
+    watchdog_active_(false),
+    pending_expiries_(0),
+    watchdog_thread_id_(-1)
 {
+    for (uint8_t dac_index = 0; dac_index < 4; ++dac_index) {
+        trackers_[dac_index].owner = this;
+        trackers_[dac_index].dac_index = dac_index;
+    }
 }
 
 dma_timeout_watchdog::~dma_timeout_watchdog() {
     stop_watchdog();
+    
+    for (uint8_t dac_index = 0; dac_index < 4; ++dac_index) {
+        deadline_timer::shared().cancel(trackers_[dac_index].deadline);
+    }
 }
 
 void dma_timeout_watchdog::start_operation_tracking(uint8_t dac_index) {
     if (dac_index >= 4) return;
     
     watchdog_mutex_.lock();
-    trackers_[dac_index].operation_active = true;
-    trackers_[dac_index].start_time_ms = millis();
-    trackers_[dac_index].dac_index = dac_index;
+    operation_tracker_t& tracker = trackers_[dac_index];
+    deadline_timer::shared().cancel(tracker.deadline);
+    
+    tracker.operation_active = true;
+    tracker.start_time_ms = millis();
+    tracker.expired = false;
+    tracker.deadline = deadline_timer::shared().arm(config_.timeout_threshold_ms * 1000, deadline_expired, &tracker);
     watchdog_mutex_.unlock();
 }
 
@@ -415,8 +562,12 @@ void dma_timeout_watchdog::stop_operation_tracking(uint8_t dac_index) {
     if (dac_index >= 4) return;
     
     watchdog_mutex_.lock();
-    if (trackers_[dac_index].operation_active) {
-        uint32_t duration = millis() - trackers_[dac_index].start_time_ms;
+    operation_tracker_t& tracker = trackers_[dac_index];
+    deadline_timer::shared().cancel(tracker.deadline);
+    tracker.deadline = deadline_timer::k_invalid_handle;
+    
+    if (tracker.operation_active) {
+        uint32_t duration = millis() - tracker.start_time_ms;
         
         // Update statistics
         if (config_.enable_statistics) {
@@ -429,7 +580,7 @@ void dma_timeout_watchdog::stop_operation_tracking(uint8_t dac_index) {
                 (statistics_.average_operation_time_ms + duration) / 2;
         }
         
-        trackers_[dac_index].operation_active = false;
+        tracker.operation_active = false;
     }
     watchdog_mutex_.unlock();
 }
@@ -438,8 +589,7 @@ bool dma_timeout_watchdog::is_operation_timeout(uint8_t dac_index) {
     if (dac_index >= 4) return false;
     
     watchdog_mutex_.lock();
-    bool timeout = trackers_[dac_index].operation_active &&
-                   (millis() - trackers_[dac_index].start_time_ms > config_.timeout_threshold_ms);
+    bool timeout = trackers_[dac_index].operation_active && trackers_[dac_index].expired;
     watchdog_mutex_.unlock();
     
     return timeout;
@@ -455,25 +605,56 @@ void dma_timeout_watchdog::start_watchdog() {
 void dma_timeout_watchdog::stop_watchdog() {
     watchdog_active_ = false;
     // Note: TeensyThreads doesn't have a direct thread termination method
-    // The thread will exit on next iteration
+    // Wake the thread so it sees the flag and exits
+    wake_watchdog();
+}
+
+void dma_timeout_watchdog::deadline_expired(void* context) {
+    // ISR context: flag the tracker and wake the watchdog, recovery runs in the thread
+    operation_tracker_t* tracker = static_cast<operation_tracker_t*>(context);
+    tracker->deadline = deadline_timer::k_invalid_handle;
+    tracker->expired = true;
+    tracker->owner->pending_expiries_ = tracker->owner->pending_expiries_ + 1;
+    tracker->owner->wake_watchdog();
+}
+
+void dma_timeout_watchdog::wake_watchdog() {
+    int thread_id = watchdog_thread_id_;
+    if (thread_id >= 0) {
+        threads.restart(thread_id);
+    }
 }
 
 void dma_timeout_watchdog::watchdog_thread(void* user_data) {
     dma_timeout_watchdog* watchdog = static_cast<dma_timeout_watchdog*>(user_data);
+    watchdog->watchdog_thread_id_ = threads.id();
     
     while (watchdog->watchdog_active_) {
+        // Sleep until a deadline fires; checked with IRQs off so a wake-up can't be lost
+        __disable_irq();
+        if (watchdog->pending_expiries_ == 0 && watchdog->watchdog_active_) {
+            threads.suspend(watchdog->watchdog_thread_id_);
+        }
+        __enable_irq();
+        threads.yield();
+        
         watchdog->check_timeouts();
-        threads.delay(watchdog->config_.check_interval_ms);
     }
+    
+    watchdog->watchdog_thread_id_ = -1;
 }
 
 void dma_timeout_watchdog::check_timeouts() {
     uint32_t current_time = millis();
     
+    __disable_irq();
+    pending_expiries_ = 0;
+    __enable_irq();
+    
     for (uint8_t dac_index = 0; dac_index < 4; ++dac_index) {
         watchdog_mutex_.lock();
-        bool timeout_detected = trackers_[dac_index].operation_active &&
-            (current_time - trackers_[dac_index].start_time_ms > config_.timeout_threshold_ms);
+        bool timeout_detected = trackers_[dac_index].operation_active && trackers_[dac_index].expired;
+        trackers_[dac_index].expired = false;
         
         if (timeout_detected) {
             trackers_[dac_index].timeout_count++;
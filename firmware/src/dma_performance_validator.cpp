@@ -8,7 +8,8 @@ namespace dma_validation {
 
 dma_performance_validator::dma_performance_validator(const test_config_t& config) :
     config_(config),
-    timing_buffer_index_(0)
+    timing_buffer_index_(0),
+    fault_injector_(nullptr)
 {
     memset(timing_buffer_, 0, sizeof(timing_buffer_));
 }
@@ -173,8 +174,25 @@ void dma_performance_validator::disable_stress_testing() {
 void dma_performance_validator::inject_error_scenario(uint8_t dac_index) {
     if (stress_state_.active) {
         stress_state_.error_injection_count++;
-        // Error injection would be implemented based on specific test requirements
-        Serial.print(F("Error injected for DAC "));
+        
+        if (!fault_injector_) {
+            Serial.println(F("No fault injector attached"));
+            return;
+        }
+        
+        // Cycle through the fault types so one stress run covers all of them
+        drivers::i2c_fault_injector::fault_t fault =
+            static_cast<drivers::i2c_fault_injector::fault_t>(stress_state_.next_fault);
+        if (++stress_state_.next_fault >= drivers::i2c_fault_injector::k_fault_types) {
+            stress_state_.next_fault = 1;
+        }
+        
+        fault_injector_->enable();
+        fault_injector_->arm_single_fault(dac_index, fault);
+        
+        Serial.print(F("Fault "));
+        Serial.print(drivers::i2c_fault_injector::fault_to_string(fault));
+        Serial.print(F(" armed for DAC "));
         Serial.println(dac_index);
     }
 }
@@ -642,6 +660,17 @@ void dma_realtime_monitor::check_performance_constraints() {
                           static_cast<uint32_t>(error_rate_percent * 100),
                           static_cast<uint32_t>(config_.alert_threshold_error_rate * 100));
         }
+        
+#ifdef THREADS_CYCLE_ACCOUNTING
+        // A starved thread (MIDI input) shows up as its share of the last second dropping
+        if (config_.watched_thread_id >= 0) {
+            uint16_t share_permille = threads.getLoadPermille(config_.watched_thread_id);
+            if (share_permille < config_.alert_threshold_thread_share_permille) {
+                generate_alert(alert_level_t::WARNING, "Watched thread CPU share low",
+                              share_permille, config_.alert_threshold_thread_share_permille);
+            }
+        }
+#endif
     }
 }
 
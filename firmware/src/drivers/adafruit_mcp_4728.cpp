@@ -4,10 +4,34 @@
 #include "TeensyThreads.h"
 
 #include "drivers/adafruit_mcp_4728.h"
+#include "drivers/i2c_bus_recovery.h"
 
 namespace drivers {
 
-void adafruit_mcp_4728::initialize( const initialization_struct_t& initialization_struct ) {
+bool adafruit_mcp_4728::initialize( const initialization_struct_t& initialization_struct ) {
+    attach( initialization_struct );
+
+    // a missing device is picked up later by the background re-probe, don't hold the boot
+    uint8_t retry = 0;
+    bool    found = bring_up( );
+    while ( !found && ++retry < dr_teeth::k_boot_probe_attempts ) {
+        threads.delay( dr_teeth::k_boot_probe_delay_millis );
+        found = bring_up( );
+    }
+
+    if ( !found ) {
+        return false;
+    }
+
+    for ( uint8_t channel_index = 0; channel_index < adafruit_mcp_4728::k_channels; ++channel_index ) {
+        mcp.setChannelValue( static_cast< MCP4728_channel_t >( channel_index ), 0 );
+    }
+
+    return true;
+}
+
+void adafruit_mcp_4728::attach( const initialization_struct_t& initialization_struct ) {
+    wire        = initialization_struct.wire;
     ldac_port   = initialization_struct.ldac_port;
 
     pinMode( ldac_port, OUTPUT );
@@ -15,17 +39,26 @@ void adafruit_mcp_4728::initialize( const initialization_struct_t& initializatio
 
     initialization_struct.wire->begin( );
     initialization_struct.wire->setClock( k_wire_clock );
+}
 
-    uint16_t retry = 0;
-    while ( retry++ < 100 && !mcp.begin( MCP4728_I2CADDR_DEFAULT, initialization_struct.wire ) ) {
-        threads.delay( 10 );
-    }
+bool adafruit_mcp_4728::bring_up( void ) {
+    // one attempt, a device that is not there costs a single NAK
+    // no zeroing, the worker's first frame (journaled at the last power down) is the first DAC write
+    return mcp.begin( MCP4728_I2CADDR_DEFAULT, wire );
+}
 
-    if ( retry < 100 ) {
-        for ( uint8_t channel_index = 0; channel_index < adafruit_mcp_4728::k_channels; ++channel_index ) {
-            mcp.setChannelValue( static_cast< MCP4728_channel_t >( channel_index ), 0 );
-        }
-    }
+void adafruit_mcp_4728::reinitialize( void ) {
+    // single attempt, recovery must not block the worker
+    mcp.begin( MCP4728_I2CADDR_DEFAULT, wire );
+}
+
+bool adafruit_mcp_4728::recover_bus( void ) {
+    return recover_i2c_bus( wire, k_wire_clock );
+}
+
+bool adafruit_mcp_4728::probe( void ) {
+    wire->beginTransmission( MCP4728_I2CADDR_DEFAULT );
+    return wire->endTransmission( ) == 0;
 }
 
 void adafruit_mcp_4728::enable( void ) {
@@ -49,8 +82,8 @@ void adafruit_mcp_4728::set_all_channels_same_value( value_t value_for_all_chann
     mcp.fastWrite( value_for_all_channels, value_for_all_channels, value_for_all_channels, value_for_all_channels );
 }
 
-void adafruit_mcp_4728::set_values( value_t values[ adafruit_mcp_4728::k_channels ] ) {
-    mcp.fastWrite( dac_value_rescale( values[ 0 ] ), 
+bool adafruit_mcp_4728::set_values( value_t values[ adafruit_mcp_4728::k_channels ] ) {
+    return mcp.fastWrite( dac_value_rescale( values[ 0 ] ), 
                    dac_value_rescale( values[ 1 ] ), 
                    dac_value_rescale( values[ 2 ] ), 
                    dac_value_rescale( values[ 3 ] ) );
@@ -0,0 +1,166 @@
+#include <Arduino.h>
+#include <cstring>
+#include "drivers/adafruit_mcp_4728_async.h"
+
+namespace drivers {
+
+adafruit_mcp_4728_async::adafruit_mcp_4728_async() :
+    adafruit_mcp_4728(),
+    async_status_(async_status_t::READY),
+    current_callback_(nullptr),
+    current_user_data_(nullptr),
+    transfer_start_time_(0)
+{
+    memset(dma_write_buffer_, 0, sizeof(dma_write_buffer_));
+}
+
+adafruit_mcp_4728_async::~adafruit_mcp_4728_async() {
+    if (async_status_ == async_status_t::IN_PROGRESS) {
+        abort_async_operation();
+    }
+}
+
+bool adafruit_mcp_4728_async::initialize_async(const initialization_struct_t& initialization_struct,
+                                               uint8_t dma_channel) {
+    dma_i2c_hal::dma_i2c_config_t dma_config;
+
+    dma_config.wire_instance = initialization_struct.wire;
+    dma_config.dma_channel = dma_channel;
+    dma_config.clock_frequency = k_wire_clock;
+    dma_config.slave_address = MCP4728_I2CADDR_DEFAULT;
+    dma_config.timeout_ms = 100;
+
+    if (dma_hal_.init(dma_config) != dma_i2c_hal::error_code_t::SUCCESS) {
+        return false;
+    }
+
+    async_status_ = async_status_t::READY;
+    return true;
+}
+
+dma_i2c_hal::error_code_t adafruit_mcp_4728_async::set_values_async(const value_t values[],
+                                                                    async_completion_callback_t callback,
+                                                                    void* user_data) {
+    return set_frame_async(values, 0, callback, user_data);
+}
+
+dma_i2c_hal::error_code_t adafruit_mcp_4728_async::set_frame_async(const value_t values[],
+                                                                   uint8_t,
+                                                                   async_completion_callback_t callback,
+                                                                   void* user_data) {
+    if (!is_async_mode_available()) {
+        return dma_i2c_hal::error_code_t::NOT_INITIALIZED;
+    }
+
+    if (!callback || !values) {
+        return dma_i2c_hal::error_code_t::INVALID_PARAMETER;
+    }
+
+    async_mutex_.lock();
+    if (async_status_ == async_status_t::IN_PROGRESS) {
+        async_mutex_.unlock();
+        return dma_i2c_hal::error_code_t::BUSY;
+    }
+
+    current_callback_ = callback;
+    current_user_data_ = user_data;
+    async_status_ = async_status_t::IN_PROGRESS;
+    transfer_start_time_ = micros();
+    async_mutex_.unlock();
+
+    // Copied before the transfer starts, the caller's frame may change right after
+    prepare_fast_write_buffer(values);
+
+    // No register address, a fast write is just the channel words
+    dma_i2c_hal::dma_i2c_transfer_t transfer;
+    transfer.data_buffer = dma_write_buffer_;
+    transfer.data_length = k_fast_write_bytes;
+    transfer.register_address = 0x00;
+    transfer.is_write_operation = true;
+    transfer.slave_address_override = 0;
+    transfer.completion_context = this;
+
+    dma_i2c_hal::error_code_t result = dma_hal_.transfer_async(transfer,
+                                                               dma_completion_callback,
+                                                               this);
+
+    if (result != dma_i2c_hal::error_code_t::SUCCESS) {
+        async_status_ = async_status_t::ERROR_OCCURRED;
+        current_callback_ = nullptr;
+        current_user_data_ = nullptr;
+    }
+
+    return result;
+}
+
+dma_i2c_hal::error_code_t adafruit_mcp_4728_async::wait_for_async_completion(uint32_t timeout_ms) {
+    if (!is_async_mode_available()) {
+        return dma_i2c_hal::error_code_t::NOT_INITIALIZED;
+    }
+
+    return dma_hal_.wait_for_completion(timeout_ms);
+}
+
+dma_i2c_hal::error_code_t adafruit_mcp_4728_async::abort_async_operation() {
+    if (!is_async_mode_available()) {
+        return dma_i2c_hal::error_code_t::NOT_INITIALIZED;
+    }
+
+    dma_i2c_hal::error_code_t result = dma_hal_.abort_transfer();
+    async_status_ = async_status_t::ERROR_OCCURRED;
+
+    return result;
+}
+
+void adafruit_mcp_4728_async::reset_async_statistics() {
+    async_mutex_.lock();
+    stats_ = async_stats_t();
+    async_mutex_.unlock();
+}
+
+void adafruit_mcp_4728_async::dma_completion_callback(dma_i2c_hal::transfer_state_t state,
+                                                      dma_i2c_hal::error_code_t error,
+                                                      void* user_data) {
+    adafruit_mcp_4728_async* instance = static_cast<adafruit_mcp_4728_async*>(user_data);
+
+    if (!instance || !instance->current_callback_) {
+        return;
+    }
+
+    uint32_t duration_us = micros() - instance->transfer_start_time_;
+    bool     success     = (state == dma_i2c_hal::transfer_state_t::COMPLETED);
+
+    instance->async_mutex_.lock();
+    instance->stats_.total_operations++;
+    if (success) {
+        instance->stats_.successful_operations++;
+    } else {
+        instance->stats_.failed_operations++;
+    }
+    if (duration_us > instance->stats_.max_transfer_time_us) {
+        instance->stats_.max_transfer_time_us = duration_us;
+    }
+    instance->async_mutex_.unlock();
+
+    instance->async_status_ = success ? async_status_t::COMPLETED : async_status_t::ERROR_OCCURRED;
+
+    // Cleared before the call, the callback may well start the next frame
+    async_completion_callback_t callback = instance->current_callback_;
+    void*                       callback_data = instance->current_user_data_;
+    instance->current_callback_ = nullptr;
+    instance->current_user_data_ = nullptr;
+
+    callback(success, error, callback_data);
+}
+
+void adafruit_mcp_4728_async::prepare_fast_write_buffer(const value_t values[]) {
+    // Fast write: per channel 0 0 PD1 PD0 D11..D8, then D7..D0; PD clear, outputs on
+    for (uint8_t channel = 0; channel < k_channels; ++channel) {
+        value_t rescaled_value = dac_value_rescale(values[channel]);
+
+        dma_write_buffer_[2 * channel]     = (rescaled_value >> 8) & 0x0F;
+        dma_write_buffer_[2 * channel + 1] = rescaled_value & 0xFF;
+    }
+}
+
+} // namespace drivers
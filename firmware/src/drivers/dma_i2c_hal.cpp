@@ -1,11 +1,17 @@
 #include <Arduino.h>
 #include "drivers/dma_i2c_hal.h"
+#include "drivers/i2c_fault_injector.h"
 #include "TeensyThreads.h"
 #include <Wire.h>
 
 namespace drivers {
 
-dma_i2c_hal::dma_i2c_hal() : initialized_(false) {
+dma_i2c_hal::dma_i2c_hal() :
+    initialized_(false),
+    fault_injector_(nullptr),
+    fault_bus_index_(0),
+    worker_running_(false)
+{
     reset_state();
 }
 
@@ -24,6 +30,11 @@ dma_i2c_hal::error_code_t dma_i2c_hal::init(const dma_i2c_config_t& config) {
         return error_code_t::INVALID_PARAMETER;
     }
     
+    // After a deinit the old worker may still be winding down on the same stack
+    if (worker_running_) {
+        return error_code_t::BUSY;
+    }
+    
     // Store configuration
     handle_.config = config;
     
@@ -31,13 +42,18 @@ dma_i2c_hal::error_code_t dma_i2c_hal::init(const dma_i2c_config_t& config) {
     config.wire_instance->begin();
     config.wire_instance->setClock(config.clock_frequency);
     
-    // Start async worker thread for simulating DMA operations
-    threads.addThread(async_worker_thread, this);
-    
     initialized_ = true;
     handle_.state = transfer_state_t::IDLE;
     handle_.last_error = error_code_t::SUCCESS;
     
+    // Start async worker thread for simulating DMA operations; it runs while initialized_ holds
+    worker_running_ = true;
+    if (threads.addThread(async_worker_thread, this, sizeof(worker_stack_), worker_stack_) < 0) {
+        worker_running_ = false;
+        initialized_ = false;
+        return error_code_t::NOT_INITIALIZED;
+    }
+    
     return error_code_t::SUCCESS;
 }
 
@@ -67,7 +83,8 @@ dma_i2c_hal::error_code_t dma_i2c_hal::transfer_async(const dma_i2c_transfer_t&
         return error_code_t::NOT_INITIALIZED;
     }
     
-    if (handle_.state == transfer_state_t::DMA_IN_PROGRESS) {
+    // A transfer aborted by its deadline may still own the bus until Wire returns
+    if (handle_.state == transfer_state_t::DMA_IN_PROGRESS || handle_.async_operation_pending) {
         return error_code_t::BUSY;
     }
     
@@ -86,9 +103,13 @@ dma_i2c_hal::error_code_t dma_i2c_hal::transfer_async(const dma_i2c_transfer_t&
     handle_.async_operation_complete = false;
     
     // Update state before starting transfer
+    handle_.deadline_fired = false;
     handle_.state = transfer_state_t::DMA_IN_PROGRESS;
     handle_.last_error = error_code_t::SUCCESS;
     
+    // One-shot deadline on the shared PIT; aborts the transfer exactly at its timeout
+    handle_.deadline = deadline_timer::shared().arm(handle_.config.timeout_ms * 1000, deadline_expired, this);
+    
     return error_code_t::SUCCESS;
 }
 
@@ -105,17 +126,21 @@ dma_i2c_hal::error_code_t dma_i2c_hal::wait_for_completion(uint32_t timeout_ms)
         return error_code_t::NOT_INITIALIZED;
     }
     
+    // The armed deadline ends the wait on its own; the clock is only checked for a
+    // caller-supplied timeout or a transfer that found no free deadline slot
+    bool check_clock = timeout_ms != 0 || handle_.deadline == deadline_timer::k_invalid_handle;
     uint32_t timeout = timeout_ms ? timeout_ms : handle_.config.timeout_ms;
     uint32_t start_time = millis();
     
     while (handle_.state == transfer_state_t::DMA_IN_PROGRESS) {
-        if (millis() - start_time > timeout) {
+        if (check_clock && millis() - start_time > timeout) {
+            disarm_deadline();
             handle_.state = transfer_state_t::ERROR_TIMEOUT;
             handle_.last_error = error_code_t::TIMEOUT;
             abort_transfer();
             return error_code_t::TIMEOUT;
         }
-        yield(); // Allow other threads to run
+        threads.yield();
     }
     
     return handle_.last_error;
@@ -127,6 +152,7 @@ dma_i2c_hal::error_code_t dma_i2c_hal::abort_transfer() {
     }
     
     if (handle_.state == transfer_state_t::DMA_IN_PROGRESS) {
+        disarm_deadline();
         handle_.async_operation_pending = false;
         handle_.async_operation_complete = true;
         handle_.state = transfer_state_t::ERROR_DMA_FAILURE;
@@ -142,18 +168,24 @@ void dma_i2c_hal::async_worker_thread(void* user_data) {
     
     while (hal_instance->initialized_) {
         if (hal_instance->handle_.async_operation_pending && !hal_instance->handle_.async_operation_complete) {
-            // Perform the actual I2C transfer
-            error_code_t result = hal_instance->perform_i2c_transfer(hal_instance->handle_.pending_transfer);
+            // Perform the actual I2C transfer, unless the deadline beat the worker to it
+            error_code_t result = hal_instance->handle_.deadline_fired ?
+                                  error_code_t::TIMEOUT :
+                                  hal_instance->perform_i2c_transfer(hal_instance->handle_.pending_transfer);
             
-            // Update state based on transfer result
-            if (result == error_code_t::SUCCESS) {
-                hal_instance->handle_.state = transfer_state_t::COMPLETED;
-                hal_instance->handle_.last_error = error_code_t::SUCCESS;
-            } else {
-                hal_instance->handle_.state = transfer_state_t::ERROR_DMA_FAILURE;
-                hal_instance->handle_.last_error = result;
+            // Finished past the deadline: the waiter already saw TIMEOUT, keep it that way
+            if (!hal_instance->disarm_deadline()) {
+                result = error_code_t::TIMEOUT;
             }
             
+            if (hal_instance->fault_injector_) {
+                hal_instance->fault_injector_->on_transfer_result(hal_instance->fault_bus_index_, result);
+            }
+            
+            // Update state based on transfer result
+            hal_instance->handle_.state = error_to_state(result);
+            hal_instance->handle_.last_error = result;
+            
             // Mark operation complete and call callback
             hal_instance->handle_.async_operation_complete = true;
             hal_instance->handle_.async_operation_pending = false;
@@ -168,6 +200,12 @@ void dma_i2c_hal::async_worker_thread(void* user_data) {
         threads.yield();
         threads.delay(1); // Small delay to prevent busy waiting
     }
+    
+    // Leaves with interrupts off: the return lands in the scheduler's del_process, which stops
+    // the scheduler before it marks the thread ENDED, so init() can't hand this stack to a new
+    // worker while this one still has a frame on it
+    __disable_irq();
+    hal_instance->worker_running_ = false;
 }
 
 dma_i2c_hal::error_code_t dma_i2c_hal::perform_i2c_transfer(const dma_i2c_transfer_t& transfer) {
@@ -176,6 +214,13 @@ dma_i2c_hal::error_code_t dma_i2c_hal::perform_i2c_transfer(const dma_i2c_transf
         return error_code_t::NOT_INITIALIZED;
     }
     
+    if (fault_injector_) {
+        i2c_fault_injector::fault_t fault = fault_injector_->next_fault(fault_bus_index_);
+        if (fault != i2c_fault_injector::fault_t::NONE) {
+            return perform_faulty_transfer(static_cast<uint8_t>(fault), transfer);
+        }
+    }
+    
     uint8_t slave_addr = transfer.slave_address_override ? 
                         transfer.slave_address_override : handle_.config.slave_address;
     
@@ -231,6 +276,82 @@ dma_i2c_hal::error_code_t dma_i2c_hal::perform_i2c_transfer(const dma_i2c_transf
     }
 }
 
+dma_i2c_hal::error_code_t dma_i2c_hal::perform_faulty_transfer(uint8_t fault, const dma_i2c_transfer_t& transfer) {
+    switch (static_cast<i2c_fault_injector::fault_t>(fault)) {
+        case i2c_fault_injector::fault_t::NAK:
+            return error_code_t::NAK_RECEIVED;
+            
+        case i2c_fault_injector::fault_t::TIMEOUT:
+            // Hold the worker for the whole timeout, like a slave stretching SCL forever
+            threads.delay(handle_.config.timeout_ms);
+            return error_code_t::TIMEOUT;
+            
+        case i2c_fault_injector::fault_t::ARBITRATION_LOST:
+            return error_code_t::ARBITRATION_LOST;
+            
+        case i2c_fault_injector::fault_t::STUCK_SDA:
+            // LPI2C reports a busy bus as a timeout; keeps failing until the bus is released
+            threads.delay(handle_.config.timeout_ms);
+            return error_code_t::TIMEOUT;
+            
+        case i2c_fault_injector::fault_t::PARTIAL_TRANSFER: {
+            // Clock out the first half of the payload for real, then report the NAK
+            if (transfer.is_write_operation && transfer.data_length > 1) {
+                TwoWire* wire = handle_.config.wire_instance;
+                uint8_t slave_addr = transfer.slave_address_override ?
+                                    transfer.slave_address_override : handle_.config.slave_address;
+                wire->beginTransmission(slave_addr);
+                if (transfer.register_address != 0) {
+                    wire->write(transfer.register_address);
+                }
+                for (size_t i = 0; i < transfer.data_length / 2; ++i) {
+                    wire->write(transfer.data_buffer[i]);
+                }
+                wire->endTransmission();
+            }
+            return error_code_t::NAK_RECEIVED;
+        }
+        
+        default:
+            return error_code_t::DMA_ERROR;
+    }
+}
+
+dma_i2c_hal::transfer_state_t dma_i2c_hal::error_to_state(error_code_t error) {
+    switch (error) {
+        case error_code_t::SUCCESS: return transfer_state_t::COMPLETED;
+        case error_code_t::TIMEOUT: return transfer_state_t::ERROR_TIMEOUT;
+        case error_code_t::NAK_RECEIVED: return transfer_state_t::ERROR_NAK;
+        case error_code_t::ARBITRATION_LOST: return transfer_state_t::ERROR_ARBITRATION;
+        default: return transfer_state_t::ERROR_DMA_FAILURE;
+    }
+}
+
+void dma_i2c_hal::set_fault_injector(i2c_fault_injector* injector, uint8_t bus_index) {
+    fault_injector_ = injector;
+    fault_bus_index_ = bus_index;
+}
+
+void dma_i2c_hal::deadline_expired(void* context) {
+    // ISR context: flag the timeout and release waiters, the worker delivers the callback
+    dma_i2c_hal* hal_instance = static_cast<dma_i2c_hal*>(context);
+    hal_instance->handle_.deadline = deadline_timer::k_invalid_handle;
+    hal_instance->handle_.deadline_fired = true;
+    hal_instance->handle_.last_error = error_code_t::TIMEOUT;
+    hal_instance->handle_.state = transfer_state_t::ERROR_TIMEOUT;
+}
+
+bool dma_i2c_hal::disarm_deadline() {
+    // False only when the deadline fired before the transfer finished
+    deadline_timer::handle_t deadline = handle_.deadline;
+    handle_.deadline = deadline_timer::k_invalid_handle;
+    
+    if (deadline != deadline_timer::k_invalid_handle) {
+        deadline_timer::shared().cancel(deadline);
+    }
+    return !handle_.deadline_fired;
+}
+
 bool dma_i2c_hal::is_transfer_timeout() {
     if (handle_.state != transfer_state_t::DMA_IN_PROGRESS) {
         return false;
@@ -246,6 +367,8 @@ void dma_i2c_hal::reset_state() {
     handle_.callback = nullptr;
     handle_.user_data = nullptr;
     handle_.transfer_start_time = 0;
+    handle_.deadline = deadline_timer::k_invalid_handle;
+    handle_.deadline_fired = false;
 }
 
 uint32_t dma_i2c_hal::get_transfer_duration_us() const {
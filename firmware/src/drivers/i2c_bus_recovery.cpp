@@ -0,0 +1,74 @@
+#include <Arduino.h>
+#include <Wire.h>
+
+#include "drivers/i2c_bus_recovery.h"
+
+namespace drivers {
+
+void teensy_i2c_lines::release_sda( void ) {
+    pinMode( sda_pin, INPUT_PULLUP );
+}
+
+void teensy_i2c_lines::release_scl( void ) {
+    pinMode( scl_pin, INPUT_PULLUP );
+}
+
+void teensy_i2c_lines::drive_sda_low( void ) {
+    pinMode( sda_pin, OUTPUT );
+    digitalWrite( sda_pin, LOW );
+}
+
+void teensy_i2c_lines::drive_scl_low( void ) {
+    pinMode( scl_pin, OUTPUT );
+    digitalWrite( scl_pin, LOW );
+}
+
+bool teensy_i2c_lines::read_sda( void ) {
+    return digitalRead( sda_pin ) == HIGH;
+}
+
+bool teensy_i2c_lines::read_scl( void ) {
+    return digitalRead( scl_pin ) == HIGH;
+}
+
+void teensy_i2c_lines::half_period( void ) {
+    delayMicroseconds( k_half_period_micros );
+}
+
+bool teensy_i2c_lines::pins_for( TwoWire* wire, uint8_t& sda_pin, uint8_t& scl_pin ) {
+    // default pin set of each port on the Teensy 4.1
+    if ( wire == &Wire ) {
+        sda_pin = 18;
+        scl_pin = 19;
+    } else if ( wire == &Wire1 ) {
+        sda_pin = 17;
+        scl_pin = 16;
+    } else if ( wire == &Wire2 ) {
+        sda_pin = 25;
+        scl_pin = 24;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool recover_i2c_bus( TwoWire* wire, uint32_t wire_clock ) {
+    uint8_t sda_pin;
+    uint8_t scl_pin;
+
+    if ( !wire || !teensy_i2c_lines::pins_for( wire, sda_pin, scl_pin ) ) {
+        return false;
+    }
+
+    teensy_i2c_lines lines( sda_pin, scl_pin );
+    i2c_bus_recovery< teensy_i2c_lines >::result_t result = i2c_bus_recovery< teensy_i2c_lines >::recover( lines );
+
+    // LPI2C soft reset, also gives the pins back to the peripheral
+    wire->begin( );
+    wire->setClock( wire_clock );
+
+    return result == i2c_bus_recovery< teensy_i2c_lines >::result_t::BUS_FREE ||
+           result == i2c_bus_recovery< teensy_i2c_lines >::result_t::RECOVERED;
+}
+
+} // namespace drivers
@@ -0,0 +1,221 @@
+#include <Arduino.h>
+#include "drivers/i2c_fault_injector.h"
+
+namespace drivers {
+
+i2c_fault_injector::i2c_fault_injector(uint32_t seed) :
+    random_state_(seed ? seed : 1),
+    enabled_(false)
+{
+    for (uint8_t f = 0; f < k_fault_types; ++f) {
+        injected_[f] = 0;
+    }
+}
+
+uint32_t i2c_fault_injector::next_random() {
+    // xorshift32: cheap, deterministic per seed, good enough for fault timing
+    random_state_ ^= random_state_ << 13;
+    random_state_ ^= random_state_ >> 17;
+    random_state_ ^= random_state_ << 5;
+    return random_state_;
+}
+
+bool i2c_fault_injector::roll_probability(uint32_t probability_ppm) {
+    if (probability_ppm == 0) {
+        return false;
+    }
+    return (next_random() % 1000000UL) < probability_ppm;
+}
+
+void i2c_fault_injector::set_plan(uint8_t bus_index, const fault_plan_t& plan) {
+    if (bus_index >= k_max_buses) return;
+
+    injector_mutex_.lock();
+    bus_state_t& bus = buses_[bus_index];
+    bus.plan = plan;
+    bus.next_scheduled_transfer = plan.after_transfers ? bus.transfer_count + plan.after_transfers : 0;
+    injector_mutex_.unlock();
+}
+
+void i2c_fault_injector::clear_plan(uint8_t bus_index) {
+    set_plan(bus_index, fault_plan_t());
+}
+
+void i2c_fault_injector::arm_single_fault(uint8_t bus_index, fault_t fault) {
+    if (bus_index >= k_max_buses) return;
+    buses_[bus_index].armed_fault = fault;
+}
+
+void i2c_fault_injector::start_tracking(bus_state_t& bus, fault_t fault) {
+    injected_[static_cast<uint8_t>(fault)]++;
+
+    // A fault injected while a previous one is still open would skew both samples
+    if (bus.awaiting_detection || bus.awaiting_recovery) {
+        return;
+    }
+
+    bus.tracked_fault = fault;
+    bus.strategy_slot = 0;
+    bus.strategy_tagged = false;
+    bus.injected_at_us = micros();
+    bus.awaiting_detection = true;
+}
+
+void i2c_fault_injector::close_window(bus_state_t& bus, uint32_t now_us) {
+    latency_statistics_t& stats = latency_[static_cast<uint8_t>(bus.tracked_fault)][bus.strategy_slot];
+    stats.samples++;
+    accumulate(bus.detected_at_us - bus.injected_at_us, stats.samples, stats.average_detect_us, stats.max_detect_us);
+    accumulate(now_us - bus.detected_at_us, stats.samples, stats.average_recover_us, stats.max_recover_us);
+
+    bus.awaiting_recovery = false;
+    bus.tracked_fault = fault_t::NONE;
+}
+
+i2c_fault_injector::fault_t i2c_fault_injector::next_fault(uint8_t bus_index) {
+    if (!enabled_ || bus_index >= k_max_buses) {
+        return fault_t::NONE;
+    }
+
+    injector_mutex_.lock();
+    bus_state_t& bus = buses_[bus_index];
+    bus.transfer_count++;
+
+    fault_t fault = fault_t::NONE;
+    bool    armed = true;
+    if (bus.sda_stuck) {
+        // Stuck bus keeps failing until someone recovers it; still the one fault it was armed as
+        fault = fault_t::STUCK_SDA;
+        armed = false;
+    } else if (bus.armed_fault != fault_t::NONE) {
+        fault = bus.armed_fault;
+        bus.armed_fault = fault_t::NONE;
+    } else if (bus.plan.fault != fault_t::NONE) {
+        if (bus.next_scheduled_transfer != 0 && bus.transfer_count >= bus.next_scheduled_transfer) {
+            fault = bus.plan.fault;
+            bus.next_scheduled_transfer = bus.plan.repeat_every ? bus.transfer_count + bus.plan.repeat_every : 0;
+        } else if (roll_probability(bus.plan.probability_ppm)) {
+            fault = bus.plan.fault;
+        }
+    }
+
+    if (armed && fault != fault_t::NONE) {
+        if (fault == fault_t::STUCK_SDA) {
+            bus.sda_stuck = true;
+        }
+        start_tracking(bus, fault);
+    }
+    injector_mutex_.unlock();
+
+    return fault;
+}
+
+void i2c_fault_injector::on_transfer_result(uint8_t bus_index, dma_i2c_hal::error_code_t result) {
+    if (bus_index >= k_max_buses) return;
+
+    injector_mutex_.lock();
+    bus_state_t& bus = buses_[bus_index];
+    uint32_t now = micros();
+
+    if (result != dma_i2c_hal::error_code_t::SUCCESS) {
+        if (bus.awaiting_detection) {
+            bus.detected_at_us = now;
+            bus.awaiting_detection = false;
+            bus.awaiting_recovery = true;
+        }
+    } else if (bus.awaiting_recovery) {
+        // First good transfer after the fault closes the window: the DAC outputs move again
+        close_window(bus, now);
+    }
+    injector_mutex_.unlock();
+}
+
+void i2c_fault_injector::on_recovery_strategy(uint8_t bus_index, uint8_t strategy_slot) {
+    if (bus_index >= k_max_buses || strategy_slot >= k_strategy_slots) return;
+
+    injector_mutex_.lock();
+    bus_state_t& bus = buses_[bus_index];
+    // The first strategy chosen for the fault owns the sample; later escalations don't re-tag it
+    if ((bus.awaiting_detection || bus.awaiting_recovery) && !bus.strategy_tagged) {
+        bus.strategy_slot = strategy_slot;
+        bus.strategy_tagged = true;
+    }
+    injector_mutex_.unlock();
+}
+
+void i2c_fault_injector::release_stuck_bus(uint8_t bus_index) {
+    if (bus_index >= k_max_buses) return;
+    buses_[bus_index].sda_stuck = false;
+}
+
+bool i2c_fault_injector::is_bus_stuck(uint8_t bus_index) const {
+    return (bus_index < k_max_buses) ? buses_[bus_index].sda_stuck : false;
+}
+
+const i2c_fault_injector::latency_statistics_t& i2c_fault_injector::get_latency_statistics(fault_t fault,
+                                                                                           uint8_t strategy_slot) const {
+    uint8_t fault_index = static_cast<uint8_t>(fault);
+    if (fault_index >= k_fault_types || strategy_slot >= k_strategy_slots) {
+        static const latency_statistics_t empty_statistics;
+        return empty_statistics;
+    }
+    return latency_[fault_index][strategy_slot];
+}
+
+uint32_t i2c_fault_injector::get_injected_count(fault_t fault) const {
+    uint8_t fault_index = static_cast<uint8_t>(fault);
+    return (fault_index < k_fault_types) ? injected_[fault_index] : 0;
+}
+
+uint32_t i2c_fault_injector::get_transfer_count(uint8_t bus_index) const {
+    return (bus_index < k_max_buses) ? buses_[bus_index].transfer_count : 0;
+}
+
+void i2c_fault_injector::reset_statistics() {
+    injector_mutex_.lock();
+    for (uint8_t f = 0; f < k_fault_types; ++f) {
+        for (uint8_t s = 0; s < k_strategy_slots; ++s) {
+            latency_[f][s] = latency_statistics_t();
+        }
+        injected_[f] = 0;
+    }
+    for (uint8_t i = 0; i < k_max_buses; ++i) {
+        buses_[i].awaiting_detection = false;
+        buses_[i].awaiting_recovery = false;
+        buses_[i].tracked_fault = fault_t::NONE;
+    }
+    injector_mutex_.unlock();
+}
+
+void i2c_fault_injector::accumulate(uint32_t sample_us, uint32_t count, uint32_t& average_us, uint32_t& max_us) {
+    if (sample_us > max_us) {
+        max_us = sample_us;
+    }
+    // Cumulative average; count already includes this sample
+    average_us = average_us + static_cast<int32_t>(sample_us - average_us) / static_cast<int32_t>(count);
+}
+
+dma_i2c_hal::error_code_t i2c_fault_injector::error_for(fault_t fault) {
+    switch (fault) {
+        case fault_t::NONE: return dma_i2c_hal::error_code_t::SUCCESS;
+        case fault_t::NAK: return dma_i2c_hal::error_code_t::NAK_RECEIVED;
+        case fault_t::TIMEOUT: return dma_i2c_hal::error_code_t::TIMEOUT;
+        case fault_t::ARBITRATION_LOST: return dma_i2c_hal::error_code_t::ARBITRATION_LOST;
+        case fault_t::STUCK_SDA: return dma_i2c_hal::error_code_t::TIMEOUT;
+        case fault_t::PARTIAL_TRANSFER: return dma_i2c_hal::error_code_t::NAK_RECEIVED;
+        default: return dma_i2c_hal::error_code_t::DMA_ERROR;
+    }
+}
+
+const char* i2c_fault_injector::fault_to_string(fault_t fault) {
+    switch (fault) {
+        case fault_t::NONE: return "NONE";
+        case fault_t::NAK: return "NAK";
+        case fault_t::TIMEOUT: return "TIMEOUT";
+        case fault_t::ARBITRATION_LOST: return "ARBITRATION_LOST";
+        case fault_t::STUCK_SDA: return "STUCK_SDA";
+        case fault_t::PARTIAL_TRANSFER: return "PARTIAL_TRANSFER";
+        default: return "UNKNOWN";
+    }
+}
+
+} // namespace drivers
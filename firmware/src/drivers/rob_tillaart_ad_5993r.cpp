@@ -4,24 +4,84 @@
 #include "TeensyThreads.h"
 
 #include "drivers/rob_tillaart_ad_5993r.h"
+#include "drivers/i2c_bus_recovery.h"
 
 namespace drivers {
 
-void rob_tillaart_ad_5993r::initialize( const initialization_struct_t& initialization_struct ) {
+bool rob_tillaart_ad_5993r::initialize( const initialization_struct_t& initialization_struct ) {
+    attach( initialization_struct );
+
+    // a missing device is picked up later by the background re-probe, don't hold the boot
+    uint8_t retry = 0;
+    bool    found = bring_up( );
+    while ( !found && ++retry < dr_teeth::k_boot_probe_attempts ) {
+        threads.delay( dr_teeth::k_boot_probe_delay_millis );
+        found = bring_up( );
+    }
+
+    if ( !found ) {
+        return false;
+    }
+
+    // Initialize all DAC channels to 0, gates low
+    for ( uint8_t channel_index = 0; channel_index < rob_tillaart_ad_5993r::k_channels; ++channel_index ) {
+        if ( is_dac( channel_index ) ) {
+            ad5593r.writeDAC( channel_index, 0 );
+        }
+    }
+    set_gates( 0 );
+
+    return true;
+}
+
+void rob_tillaart_ad_5993r::attach( const initialization_struct_t& initialization_struct ) {
+    wire = initialization_struct.wire;
 
     initialization_struct.wire->begin( );
     initialization_struct.wire->setClock( k_wire_clock );
 
     // Initialize AD5593R with default I2C address (0x10)
-    ad5593r = AD5593R(0x10, initialization_struct.wire);
+    ad5593r = shadowed_ad5593r( 0x10, initialization_struct.wire );
+    ad5593r.verify_writes( dr_teeth::k_verify_config_writes );
+}
 
-    uint16_t retry = 0;
-    while ( retry++ < 100 && !ad5593r.begin( ) ) {
-        threads.delay( 10 );
+bool rob_tillaart_ad_5993r::bring_up( void ) {
+    // one attempt, a device that is not there costs a single NAK
+    if ( !ad5593r.begin( ) ) {
+        return false;
     }
 
-    //  set all eight pins to DAC mode.
-    ad5593r.setDACmode( 0xFF );
+    // no zeroing, the worker's first frame (journaled at the last power down) is the first DAC write
+    configure_device( );
+    return true;
+}
+
+void rob_tillaart_ad_5993r::reinitialize( void ) {
+    // the device may have browned out with the bus, bring the config back; outputs are left to the caller
+    configure_device( );
+}
+
+bool rob_tillaart_ad_5993r::recover_bus( void ) {
+    return recover_i2c_bus( wire, k_wire_clock );
+}
+
+bool rob_tillaart_ad_5993r::probe( void ) {
+    return ad5593r.isConnected( );
+}
+
+void rob_tillaart_ad_5993r::configure_device( void ) {
+    // whatever the shadow holds may predate a brown-out, let the config refill it
+    ad5593r.invalidate_shadow( );
+
+    //  gate pins are push-pull outputs, CV inputs are ADCs, everything else is a DAC.
+    ad5593r.setDACmode( k_dac_pins );
+    if ( dr_teeth::k_gate_mask ) {
+        ad5593r.setOUTPUTmode( dr_teeth::k_gate_mask );
+    }
+    if ( dr_teeth::k_cv_input_mask ) {
+        ad5593r.setADCmode( dr_teeth::k_cv_input_mask );
+        ad5593r.setADCRange2x( true );  // same 0 - 2 x Vref span as the outputs
+    }
 
     //  use internal Vref 2.5V
     ad5593r.setExternalReference( false, 5.0 );
@@ -32,11 +92,6 @@ void rob_tillaart_ad_5993r::initialize( const initialization_struct_t& initializ
     //  COPY input register direct to DAC
     //  must be set after setExternalReference()
     ad5593r.setLDACmode( AD5593R_LDAC_DIRECT );
-
-    // Initialize all 8 channels to 0
-    for ( uint8_t channel_index = 0; channel_index < rob_tillaart_ad_5993r::k_channels; ++channel_index ) {
-        ad5593r.writeDAC( channel_index, 0 );
-    }
 }
 
 void rob_tillaart_ad_5993r::enable( void ) {
@@ -52,6 +107,10 @@ void rob_tillaart_ad_5993r::set_channel_value( uint8_t channel_index, value_t va
         return;  // Invalid channel index
     }
 
+    if ( !is_dac( channel_index ) ) {
+        return;
+    }
+
     value = dac_value_rescale( value );
     ad5593r.writeDAC( channel_index, value );
 }
@@ -60,14 +119,53 @@ void rob_tillaart_ad_5993r::set_all_channels_same_value( value_t value_for_all_c
     value_for_all_channels = dac_value_rescale( value_for_all_channels );
 
     for ( uint8_t channel_index = 0; channel_index < rob_tillaart_ad_5993r::k_channels; ++channel_index ) {
-        ad5593r.writeDAC( channel_index, value_for_all_channels );
+        if ( is_dac( channel_index ) ) {
+            ad5593r.writeDAC( channel_index, value_for_all_channels );
+        }
     }
 }
 
-void rob_tillaart_ad_5993r::set_values( value_t values[ rob_tillaart_ad_5993r::k_channels ] ) {
+bool rob_tillaart_ad_5993r::set_values( value_t values[ rob_tillaart_ad_5993r::k_channels ] ) {
     for ( uint8_t channel_index = 0; channel_index < rob_tillaart_ad_5993r::k_channels; ++channel_index ) {
-        ad5593r.writeDAC( channel_index, dac_value_rescale( values[ channel_index ] ) );
+        if ( !is_dac( channel_index ) ) {
+            continue;
+        }
+
+        // stop at the first NAK, the rest of the frame would only burn bus time
+        if ( ad5593r.writeDAC( channel_index, dac_value_rescale( values[ channel_index ] ) ) != 0 ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool rob_tillaart_ad_5993r::set_gates( uint8_t gate_bits ) {
+    if ( !dr_teeth::k_gate_mask ) {
+        return true;
     }
+
+    // every gate in one register write; the frame rewrites it even when nothing changed
+    gates = gate_bits & dr_teeth::k_gate_mask;
+    return ad5593r.write8( gates ) == 0;
+}
+
+bool rob_tillaart_ad_5993r::read_cv_input( uint8_t& channel_index, value_t& value ) {
+    if ( !dr_teeth::k_cv_input_mask ) {
+        return false;
+    }
+
+    // free after the first call, until something else (readADC, a reset) replaces the sequence
+    if ( ad5593r.start_sequence( dr_teeth::k_cv_input_mask ) != 0 ) {
+        return false;
+    }
+
+    uint16_t raw = 0;
+    if ( !ad5593r.read_sequence( channel_index, raw ) || channel_index >= k_channels ) {
+        return false;
+    }
+
+    value = adc_value_rescale( raw );
+    return ( dr_teeth::k_cv_input_mask & ( 1 << channel_index ) ) != 0;
 }
 
 } // namespace drivers
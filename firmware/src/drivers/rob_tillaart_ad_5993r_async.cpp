@@ -20,10 +20,10 @@ rob_tillaart_ad_5993r_async::~rob_tillaart_ad_5993r_async() {
     }
 }
 
-void rob_tillaart_ad_5993r_async::initialize_async(const initialization_struct_t& initialization_struct,
+bool rob_tillaart_ad_5993r_async::initialize_async(const initialization_struct_t& initialization_struct,
                                                    uint8_t dma_channel) {
-    // First initialize the base synchronous driver
-    rob_tillaart_ad_5993r::initialize(initialization_struct);
+    // The base driver is attach()ed already and its worker brings the device up;
+    // a blocking initialize() here would hold the boot for a missing device
     
     // Configure DMA I2C HAL
     dma_i2c_hal::dma_i2c_config_t dma_config;
@@ -37,14 +37,25 @@ void rob_tillaart_ad_5993r_async::initialize_async(const initialization_struct_t
     
     // Initialize DMA HAL
     dma_i2c_hal::error_code_t result = dma_hal_.init(dma_config);
-    if (result == dma_i2c_hal::error_code_t::SUCCESS) {
-        set_async_status(async_status_t::READY);
+    if (result != dma_i2c_hal::error_code_t::SUCCESS) {
+        return false;
     }
+    
+    set_async_status(async_status_t::READY);
+    return true;
 }
 
 dma_i2c_hal::error_code_t rob_tillaart_ad_5993r_async::set_values_async(const value_t values[],
                                                                         async_completion_callback_t callback,
                                                                         void* user_data) {
+    // Gate pins keep whatever the last frame put there
+    return set_frame_async(values, gates, callback, user_data);
+}
+
+dma_i2c_hal::error_code_t rob_tillaart_ad_5993r_async::set_frame_async(const value_t values[],
+                                                                       uint8_t gate_bits,
+                                                                       async_completion_callback_t callback,
+                                                                       void* user_data) {
     if (!is_async_mode_available()) {
         return dma_i2c_hal::error_code_t::NOT_INITIALIZED;
     }
@@ -68,7 +79,9 @@ dma_i2c_hal::error_code_t rob_tillaart_ad_5993r_async::set_values_async(const va
     async_mutex_.unlock();
     
     // Prepare DMA buffer for multi-channel write
-    if (!prepare_dac_write_buffer(values, k_channels)) {
+    gates = gate_bits & dr_teeth::k_gate_mask;
+    uint8_t write_length = prepare_dac_write_buffer(values, k_channels);
+    if (write_length == 0) {
         set_async_status(async_status_t::ERROR_OCCURRED);
         return dma_i2c_hal::error_code_t::INVALID_PARAMETER;
     }
@@ -76,7 +89,7 @@ dma_i2c_hal::error_code_t rob_tillaart_ad_5993r_async::set_values_async(const va
     // Setup DMA transfer
     dma_i2c_hal::dma_i2c_transfer_t transfer;
     transfer.data_buffer = dma_write_buffer_;
-    transfer.data_length = k_channels * 3; // Each channel: register(1) + value(2)
+    transfer.data_length = write_length; // Each write: register(1) + value(2)
     transfer.register_address = 0x00; // Starting register
     transfer.is_write_operation = true;
     transfer.slave_address_override = 0; // Use default
@@ -252,9 +265,9 @@ void rob_tillaart_ad_5993r_async::update_statistics(bool success, dma_i2c_hal::e
     async_mutex_.unlock();
 }
 
-bool rob_tillaart_ad_5993r_async::prepare_dac_write_buffer(const value_t values[], uint8_t num_channels) {
+uint8_t rob_tillaart_ad_5993r_async::prepare_dac_write_buffer(const value_t values[], uint8_t num_channels) {
     if (!values || num_channels > k_channels) {
-        return false;
+        return 0;
     }
     
     // Clear buffer
@@ -265,6 +278,10 @@ bool rob_tillaart_ad_5993r_async::prepare_dac_write_buffer(const value_t values[
     uint8_t buffer_index = 0;
     
     for (uint8_t channel = 0; channel < num_channels; ++channel) {
+        if (!is_dac(channel)) {
+            continue;
+        }
+        
         value_t rescaled_value = dac_value_rescale(values[channel]);
         
         // AD5593R DAC register addresses start at 0x10 for channel 0
@@ -273,7 +290,15 @@ bool rob_tillaart_ad_5993r_async::prepare_dac_write_buffer(const value_t values[
         dma_write_buffer_[buffer_index++] = rescaled_value & 0xFF;
     }
     
-    return true;
+    // All gates in one GPIO output register write, riding on the same transfer
+    if (dr_teeth::k_gate_mask) {
+        dma_write_buffer_[buffer_index++] = shadowed_ad5593r::k_reg_gpio_output;
+        dma_write_buffer_[buffer_index++] = 0x00;
+        dma_write_buffer_[buffer_index++] = gates;
+        ad5593r.invalidate(shadowed_ad5593r::k_reg_gpio_output);
+    }
+    
+    return buffer_index;
 }
 
 void rob_tillaart_ad_5993r_async::set_async_status(async_status_t status) {
@@ -281,122 +306,4 @@ void rob_tillaart_ad_5993r_async::set_async_status(async_status_t status) {
     async_status_ = status;
 }
 
-// async_dac_manager implementation
-
-async_dac_manager::async_dac_manager(rob_tillaart_ad_5993r_async* driver) :
-    async_driver_(driver),
-    next_operation_sequence_(1)
-{
-}
-
-async_dac_manager::~async_dac_manager() {
-    if (operation_state_.operation_pending) {
-        force_operation_completion();
-    }
-}
-
-bool async_dac_manager::initiate_async_update(const rob_tillaart_ad_5993r::value_t values[]) {
-    if (!async_driver_ || !values) {
-        return false;
-    }
-    
-    // Check if already busy
-    operation_state_.state_mutex.lock();
-    if (operation_state_.operation_pending) {
-        operation_state_.state_mutex.unlock();
-        return false;
-    }
-    
-    // Setup operation state
-    operation_state_.operation_pending = true;
-    operation_state_.operation_completed = false;
-    operation_state_.last_error = dma_i2c_hal::error_code_t::SUCCESS;
-    operation_state_.completion_sequence = next_operation_sequence_++;
-    operation_state_.state_mutex.unlock();
-    
-    // Start async operation
-    dma_i2c_hal::error_code_t result = async_driver_->set_values_async(values, 
-                                                                       async_operation_callback, 
-                                                                       this);
-    
-    if (result != dma_i2c_hal::error_code_t::SUCCESS) {
-        // Operation failed to start, reset state
-        operation_state_.state_mutex.lock();
-        operation_state_.operation_pending = false;
-        operation_state_.last_error = result;
-        operation_state_.state_mutex.unlock();
-        return false;
-    }
-    
-    return true;
-}
-
-bool async_dac_manager::is_operation_pending() const {
-    return operation_state_.operation_pending;
-}
-
-bool async_dac_manager::is_operation_completed() const {
-    return operation_state_.operation_completed;
-}
-
-uint32_t async_dac_manager::get_completion_sequence() const {
-    return operation_state_.completion_sequence;
-}
-
-dma_i2c_hal::error_code_t async_dac_manager::get_operation_result() {
-    operation_state_.state_mutex.lock();
-    dma_i2c_hal::error_code_t result = operation_state_.last_error;
-    operation_state_.state_mutex.unlock();
-    return result;
-}
-
-bool async_dac_manager::check_and_clear_completion(uint32_t expected_sequence) {
-    operation_state_.state_mutex.lock();
-    
-    bool completed = operation_state_.operation_completed && 
-                    operation_state_.completion_sequence == expected_sequence;
-    
-    if (completed) {
-        // Clear completion state for next operation
-        operation_state_.operation_pending = false;
-        operation_state_.operation_completed = false;
-    }
-    
-    operation_state_.state_mutex.unlock();
-    return completed;
-}
-
-void async_dac_manager::reset_operation_state() {
-    operation_state_.state_mutex.lock();
-    operation_state_.operation_pending = false;
-    operation_state_.operation_completed = false;
-    operation_state_.last_error = dma_i2c_hal::error_code_t::SUCCESS;
-    operation_state_.state_mutex.unlock();
-}
-
-bool async_dac_manager::has_operation_error() const {
-    return operation_state_.last_error != dma_i2c_hal::error_code_t::SUCCESS;
-}
-
-void async_dac_manager::force_operation_completion() {
-    if (async_driver_) {
-        async_driver_->abort_async_operation();
-    }
-    reset_operation_state();
-}
-
-void async_dac_manager::async_operation_callback(bool success, dma_i2c_hal::error_code_t error, void* user_data) {
-    async_dac_manager* manager = static_cast<async_dac_manager*>(user_data);
-    
-    if (!manager) {
-        return;
-    }
-    
-    // Update operation state
-    manager->operation_state_.state_mutex.lock();
-    manager->operation_state_.operation_completed = true;
-    manager->operation_state_.last_error = success ? dma_i2c_hal::error_code_t::SUCCESS : error;
-    manager->operation_state_.state_mutex.unlock();
-}
-
 } // namespace drivers
\ No newline at end of file
@@ -0,0 +1,283 @@
+#include <Arduino.h>
+#include <cstring>
+
+#include "drivers/shadowed_ad5593r.h"
+
+namespace drivers {
+
+namespace {
+    const uint8_t  k_reg_sw_reset      = 0x0F;
+    const uint8_t  k_reg_adc_read      = 0x40;
+    const uint16_t k_sw_reset_code     = 0x0DAC;
+    const uint16_t k_adc_seq_repeat    = 0x0200;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// register access
+
+int shadowed_ad5593r::writeRegister( uint8_t reg, uint16_t data ) {
+    int result = AD5593R::writeRegister( reg, data );
+
+    if ( reg >= k_shadowed_registers ) {
+        return result;
+    }
+
+    if ( result != AD5593R_OK ) {
+        // no telling what the device latched
+        shadow_valid &= ~( 1 << reg );
+        return result;
+    }
+
+    shadow[ reg ]  = data;
+    shadow_valid  |= ( 1 << reg );
+
+    // LDAC release is a one-shot command, it doesn't read back
+    if ( verify && reg != k_reg_ldac_mode ) {
+        uint16_t read_back = AD5593R::readConfigRegister( reg );
+
+        if ( _error != 0 || read_back != data ) {
+            ++verify_errors;
+            shadow_valid &= ~( 1 << reg );
+            return AD5593R_I2C_ERROR;
+        }
+    }
+
+    return result;
+}
+
+uint16_t shadowed_ad5593r::readConfigRegister( uint8_t reg ) {
+    if ( shadowed( reg ) ) {
+        ++transactions_saved;
+        return shadow[ reg ];
+    }
+
+    uint16_t value = AD5593R::readConfigRegister( reg );
+
+    if ( reg < k_shadowed_registers && _error == 0 ) {
+        shadow[ reg ]  = value;
+        shadow_valid  |= ( 1 << reg );
+    }
+    return value;
+}
+
+int shadowed_ad5593r::update_bits( uint8_t reg, uint16_t set_mask, uint16_t clear_mask ) {
+    bool     known = shadowed( reg );
+    uint16_t value = readConfigRegister( reg );
+
+    if ( !known && _error != 0 ) {
+        return _error;
+    }
+
+    uint16_t updated = ( value & ~clear_mask ) | set_mask;
+
+    // the shadow says the device already holds it
+    if ( known && updated == value ) {
+        return AD5593R_OK;
+    }
+    return writeRegister( reg, updated );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// mode
+
+int shadowed_ad5593r::setMode( const char config[ 9 ] ) {
+    if ( strlen( config ) != 8 ) {
+        return -1;
+    }
+
+    uint8_t dac_mask   = 0x00;
+    uint8_t adc_mask   = 0x00;
+    uint8_t in_mask    = 0x00;
+    uint8_t out_mask   = 0x00;
+    uint8_t three_mask = 0x00;
+
+    for ( uint8_t pin = 0; pin < 8; ++pin ) {
+        uint8_t pin_mask = 1 << pin;
+        switch ( config[ pin ] ) {
+            case 'a': case 'A': adc_mask   |= pin_mask;                      break;
+            case 'd': case 'D': dac_mask   |= pin_mask;                      break;
+            case 'i': case 'I': in_mask    |= pin_mask;                      break;
+            case 't': case 'T': three_mask |= pin_mask; out_mask |= pin_mask; break;
+            case 'o': case 'O': out_mask   |= pin_mask;                      break;
+            default:                                                         break;
+        }
+    }
+
+    int result = setADCmode( adc_mask );
+    if ( result == AD5593R_OK ) result = setDACmode( dac_mask );
+    if ( result == AD5593R_OK ) result = setINPUTmode( in_mask );
+    if ( result == AD5593R_OK ) result = setOUTPUTmode( out_mask );
+    if ( result == AD5593R_OK ) result = setTHREESTATEmode( three_mask );
+    return result;
+}
+
+int shadowed_ad5593r::setADCmode( uint8_t bitMask ) {
+    return writeRegister( k_reg_adc_config, bitMask );
+}
+
+int shadowed_ad5593r::setDACmode( uint8_t bitMask ) {
+    return writeRegister( k_reg_dac_config, bitMask );
+}
+
+int shadowed_ad5593r::setINPUTmode( uint8_t bitMask ) {
+    return writeRegister( k_reg_gpio_input, bitMask );
+}
+
+int shadowed_ad5593r::setOUTPUTmode( uint8_t bitMask ) {
+    return writeRegister( k_reg_gpio_config, bitMask );
+}
+
+int shadowed_ad5593r::setTHREESTATEmode( uint8_t bitMask ) {
+    return writeRegister( k_reg_io_ts_config, bitMask );
+}
+
+int shadowed_ad5593r::setPULLDOWNmode( uint8_t bitMask ) {
+    return writeRegister( k_reg_pulldown_config, bitMask );
+}
+
+int shadowed_ad5593r::setLDACmode( uint8_t mode ) {
+    if ( mode > AD5593R_LDAC_RELEASE ) {
+        return AD5593R_LDAC_ERROR;
+    }
+    return writeRegister( k_reg_ldac_mode, mode );
+}
+
+int shadowed_ad5593r::setOpenDrainMode( uint8_t bitMask ) {
+    return writeRegister( k_reg_opendrain_config, bitMask );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// digital
+
+uint16_t shadowed_ad5593r::write1( uint8_t pin, uint8_t value ) {
+    if ( pin > 7 ) {
+        return AD5593R_PIN_ERROR;
+    }
+
+    uint16_t pin_mask = 1 << pin;
+    return update_bits( k_reg_gpio_output, value == LOW ? 0 : pin_mask, value == LOW ? pin_mask : 0 );
+}
+
+uint16_t shadowed_ad5593r::write8( uint8_t bitMask ) {
+    return writeRegister( k_reg_gpio_output, bitMask );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// reference, range and general control
+
+int shadowed_ad5593r::setExternalReference( bool flag, float Vref ) {
+    _Vref = flag ? Vref : 2.5;
+    return flag ? update_bits( k_reg_powerdown_ref, 0, 0x0200 ) : update_bits( k_reg_powerdown_ref, 0x0200, 0 );
+}
+
+int shadowed_ad5593r::setADCRange2x( bool flag ) {
+    _gain = flag ? 2 : 1;
+    return flag ? update_bits( k_reg_gen_ctrl, 0x0020, 0 ) : update_bits( k_reg_gen_ctrl, 0, 0x0020 );
+}
+
+int shadowed_ad5593r::setDACRange2x( bool flag ) {
+    return flag ? update_bits( k_reg_gen_ctrl, 0x0010, 0 ) : update_bits( k_reg_gen_ctrl, 0, 0x0010 );
+}
+
+int shadowed_ad5593r::enableADCBufferPreCharge( bool flag ) {
+    return flag ? update_bits( k_reg_gen_ctrl, 0x0200, 0 ) : update_bits( k_reg_gen_ctrl, 0, 0x0200 );
+}
+
+int shadowed_ad5593r::enableADCBuffer( bool flag ) {
+    return flag ? update_bits( k_reg_gen_ctrl, 0x0100, 0 ) : update_bits( k_reg_gen_ctrl, 0, 0x0100 );
+}
+
+int shadowed_ad5593r::enableIOLock( bool flag ) {
+    return flag ? update_bits( k_reg_gen_ctrl, 0x0080, 0 ) : update_bits( k_reg_gen_ctrl, 0, 0x0080 );
+}
+
+int shadowed_ad5593r::writeAllDacs( bool flag ) {
+    return flag ? update_bits( k_reg_gen_ctrl, 0x0040, 0 ) : update_bits( k_reg_gen_ctrl, 0, 0x0040 );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// analog in
+
+uint16_t shadowed_ad5593r::readADC( uint8_t pin ) {
+    if ( pin > 8 ) {
+        return AD5593R_PIN_ERROR;
+    }
+
+    // repeated reads of the same pin don't need the sequence written again
+    uint16_t sequence = k_adc_seq_repeat | ( 1 << pin );
+    if ( !shadowed( k_reg_adc_seq ) || shadow[ k_reg_adc_seq ] != sequence ) {
+        writeRegister( k_reg_adc_seq, sequence );
+    } else {
+        ++transactions_saved;
+    }
+
+    return readIORegister( k_reg_adc_read ) & 0x0FFF;
+}
+
+int shadowed_ad5593r::start_sequence( uint8_t bitMask ) {
+    // once running, the sequence only needs writing again after something else replaced it
+    uint16_t sequence = k_adc_seq_repeat | bitMask;
+    if ( shadowed( k_reg_adc_seq ) && shadow[ k_reg_adc_seq ] == sequence ) {
+        ++transactions_saved;
+        return 0;
+    }
+
+    return writeRegister( k_reg_adc_seq, sequence );
+}
+
+bool shadowed_ad5593r::read_sequence( uint8_t& pin, uint16_t& value ) {
+    uint16_t raw = readIORegister( k_reg_adc_read );
+    if ( _error != 0 ) {
+        return false;
+    }
+
+    // the conversion carries its pin in the top four bits
+    pin   = raw >> 12;
+    value = raw & 0x0FFF;
+    return true;
+}
+
+float shadowed_ad5593r::readTemperature( void ) {
+    float temperature = AD5593R::readTemperature( );
+
+    // the library wrote the sequence behind our back
+    shadow_valid &= ~( 1 << k_reg_adc_seq );
+    return temperature;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// power and reset
+
+int shadowed_ad5593r::powerDown( void ) {
+    return update_bits( k_reg_powerdown_ref, 0x0400, 0 );
+}
+
+int shadowed_ad5593r::wakeUp( void ) {
+    _Vref = 2.5;
+    return update_bits( k_reg_powerdown_ref, 0, 0x0400 );
+}
+
+int shadowed_ad5593r::powerDownDac( uint8_t pin ) {
+    if ( pin > 7 ) {
+        return 0;
+    }
+    return update_bits( k_reg_powerdown_ref, 1 << pin, 0 );
+}
+
+int shadowed_ad5593r::wakeUpDac( uint8_t pin ) {
+    if ( pin > 7 ) {
+        return 0;
+    }
+    return update_bits( k_reg_powerdown_ref, 0, 1 << pin );
+}
+
+int shadowed_ad5593r::reset( void ) {
+    int result = AD5593R::writeRegister( k_reg_sw_reset, k_sw_reset_code );
+
+    _Vref = 2.5;
+    _gain = 1;
+    invalidate_shadow( );
+    return result;
+}
+
+} // namespace drivers
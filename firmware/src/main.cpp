@@ -8,6 +8,16 @@
 
 #include "function_generator.h"
 #include "muppet_clock.h"
+#include "muppet_config_store.h"
+#include "muppet_event_loop.h"
+#include "muppet_frame_config.h"
+#include "muppet_frame_journal.h"
+#include "muppet_latency_probe.h"
+#include "muppet_modulation.h"
+#include "muppet_preset_bank.h"
+#include "muppet_preset_morph.h"
+#include "muppet_snapshot_exchange.h"
+#include "deadline_timer.h"
 
 // DMA Validation headers (always include for conditional compilation)
 #include "dma_automatic_validation.h"
@@ -56,11 +66,12 @@ using dac_driver_t = drivers::rob_tillaart_ad_5993r;
 #elif defined MASTER_OF_MUPPETS_MCP4728
 
 #ifdef ENABLE_DMA_OPERATIONS
-#error "unsuported"
-#endif
-
+#include "drivers/adafruit_mcp_4728_async.h"
+using dac_driver_t = drivers::adafruit_mcp_4728_async;
+#else
 #include "drivers/adafruit_mcp_4728.h"
 using dac_driver_t = drivers::adafruit_mcp_4728;
+#endif
 
 // end of MASTER_OF_MUPPETS_MCP4728
 #else
@@ -76,6 +87,38 @@ electric_mayhem_dma< dac_driver_t > the_muppets;
 electric_mayhem< dac_driver_t > the_muppets;
 #endif
 static Threads::Mutex           inspiration;
+static muppet_frame_journal     the_journal;                // last frame across power cycles
+static muppet_config_store      the_config;                 // wiring, applied at boot
+static muppet_preset_bank       the_presets;                // input frames and modulation, program change recalls
+static muppet_preset_morph< dac_driver_t::k_max_val > the_morph;
+static int                      the_voice_thread_id = -1;
+
+// routing and calibration, swapped in live: one reader index per real-time thread reading them
+enum config_reader : uint8_t {
+    k_show_reader = 0,
+    k_voice_reader,                                             // the modulation matrix
+    k_config_reader_count
+};
+static muppet_snapshot_exchange< muppet_frame_config, k_config_reader_count > the_frame_configs;
+static bool                     the_frame_config_draft_lost = false;
+static muppet_modulation        the_modulation;             // evaluated by the voice, added by the show
+
+alignas( THREADS_STACK_ALIGN ) static uint8_t the_muppet_show_stack[ dr_teeth::k_muppet_show_stack_bytes ];
+alignas( THREADS_STACK_ALIGN ) static uint8_t the_voice_stack[       dr_teeth::k_voice_stack_bytes ];
+
+// every stack starts on a guard boundary, the workers' second one included
+static_assert( dr_teeth::k_stack_guard_bytes >= THREADS_MPU_GUARD_SIZE, "the stacks don't budget for TeensyThreads' guard" );
+static_assert( dr_teeth::k_worker_stack_bytes % THREADS_STACK_ALIGN == 0, "a worker stack isn't a whole number of guards" );
+
+// run-to-completion execution model, dr_teeth::k_run_to_completion: the number is the priority
+enum muppet_event : uint8_t {
+    k_voice_event = 0,
+    k_show_event,
+    k_worker_event,                                             // one per device from here
+    k_refresh_event = k_worker_event + dr_teeth::k_dac_count,
+    k_event_count
+};
+static muppet_event_loop< k_event_count > the_loop;
 
 // DMA Validation System Components
 #ifdef ENABLE_DMA_VALIDATION
@@ -84,6 +127,8 @@ static dma_validation::dma_test_suite*               g_test_suite              =
 static dma_validation::dma_realtime_monitor*         g_monitor                 = nullptr;
 static dma_diagnostics::dma_error_handler*           g_error_handler           = nullptr;
 static dma_validation::dma_automatic_validation*     g_auto_validator          = nullptr;
+static drivers::i2c_fault_injector*                  g_fault_injector          = nullptr;
+static uint8_t                                       g_fault_dac_index         = 0;
 static bool                                          g_validation_mode_enabled = false;
 #endif
 
@@ -185,48 +230,531 @@ void set_channel_value( uint8_t channel_index, int pitch ) {
     dr_teeth::input_buffer[ channel_index ] = static_cast< uint16_t >(
         min( pitch + dr_teeth::k_midi_pitch_zero_offset, dr_teeth::k_midi_pitch_14_bit_max ) * dr_teeth::k_midi_to_framework_scale 
     );
+    the_morph.release( channel_index );
 
     #ifdef DEBUG_LED
         ublink();
     #endif
 }
 
-void midi_read( void ) {
-    usbMIDI.read();
+////////////////////////////////////////////////////////////////////////////////
+// gates and triggers
+// A channel whose device pin is in dr_teeth::k_gate_mask follows note on/off;
+// trigger pins drop on their own, k_trigger_width_micros after the note on,
+// timed by the deadline timer instead of by the note off.
+////////////////////////////////////////////////////////////////////////////////
+
+static deadline_timer::handle_t trigger_deadlines[ dr_teeth::k_total_channels ];
+
+// the channel's bit in its device's gate mask, 0 for DAC channels
+inline uint8_t gate_bit( uint8_t channel_index ) {
+    return dr_teeth::k_gate_mask & ( 1 << ( channel_index % dac_driver_t::k_channels ) );
+}
+
+inline bool is_trigger( uint8_t channel_index ) {
+    return ( dr_teeth::k_trigger_mask & gate_bit( channel_index ) ) != 0;
+}
+
+void set_gate( uint8_t channel_index, bool high ) {
+    uint8_t muppet_index = channel_index / dac_driver_t::k_channels;
+    uint8_t bit          = gate_bit( channel_index );
+
+    // trigger ends clear bits from the timer ISR, keep the read-modify-write whole
+    __disable_irq();
+    if ( high ) {
+        dr_teeth::input_gates[ muppet_index ] = dr_teeth::input_gates[ muppet_index ] | bit;
+    } else {
+        dr_teeth::input_gates[ muppet_index ] = dr_teeth::input_gates[ muppet_index ] & ~bit;
+    }
+    __enable_irq();
+}
+
+// deadline_timer callback, runs in the timer ISR
+void end_trigger( void* hidden_channel_index ) {
+    uint8_t channel_index = static_cast< uint8_t >( reinterpret_cast< uintptr_t >( hidden_channel_index ) );
+
+    trigger_deadlines[ channel_index ] = deadline_timer::k_invalid_handle;
+    uint8_t muppet_index = channel_index / dac_driver_t::k_channels;
+    dr_teeth::input_gates[ muppet_index ] = dr_teeth::input_gates[ muppet_index ] & ~gate_bit( channel_index );
+
+    // nobody polls the gates in between voices there, the pulse ends on time anyway
+    if constexpr ( dr_teeth::k_run_to_completion ) {
+        the_loop.post( k_show_event );
+    }
+}
+
+// callback for note off
+void close_gate( uint8_t channel_index, uint8_t, uint8_t ) {
+    channel_index -= 1;
+    the_modulation.gate( channel_index, false );
+    if ( channel_index >= dr_teeth::k_total_channels || !gate_bit( channel_index ) ) {
+        return;
+    }
+
+    // a running trigger ends on its own; one that got no deadline ends here
+    if ( !is_trigger( channel_index ) || trigger_deadlines[ channel_index ] == deadline_timer::k_invalid_handle ) {
+        set_gate( channel_index, false );
+    }
+}
+
+// callback for note on
+void open_gate( uint8_t channel_index, uint8_t note, uint8_t velocity ) {
+    if ( velocity == 0 ) {
+        close_gate( channel_index, note, velocity );
+        return;
+    }
+
+    channel_index -= 1;
+    the_modulation.gate( channel_index, true );
+    if ( channel_index >= dr_teeth::k_total_channels || !gate_bit( channel_index ) ) {
+        return;
+    }
+
+    bool trigger = is_trigger( channel_index );
+    if ( trigger ) {
+        // a retrigger restarts the pulse; the old deadline goes first, or it could
+        // fire right after the gate opened and cut the new pulse short
+        deadline_timer::handle_t previous = trigger_deadlines[ channel_index ];
+        trigger_deadlines[ channel_index ] = deadline_timer::k_invalid_handle;
+        deadline_timer::shared( ).cancel( previous );
+    }
+
+    set_gate( channel_index, true );
+
+    if ( trigger ) {
+        trigger_deadlines[ channel_index ] = deadline_timer::shared( ).arm(
+            dr_teeth::k_trigger_width_micros, end_trigger, reinterpret_cast< void* >( static_cast< uintptr_t >( channel_index ) )
+        );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// presets
+// Program change on k_preset_midi_channel morphs the input to that preset
+// over the_morph_millis, set by the k_morph_time_cc pair (MSB first, which
+// clears the LSB), and publishes its modulation as a new frame config;
+// k_preset_store_cc stores the input and the modulation as preset <value>.
+////////////////////////////////////////////////////////////////////////////////
+
+static uint16_t the_morph_millis = 0;
+
+// callback for program change
+void recall_preset( uint8_t channel, uint8_t program ) {
+    const muppet_preset_bank::record_t* preset = the_presets.recall( program );
+    if ( channel != dr_teeth::k_preset_midi_channel || !preset ) {
+        return;
+    }
+
+    the_morph.start( dr_teeth::input_buffer, preset->frame, static_cast< uint32_t >( the_morph_millis ) * 1000 / dr_teeth::k_morph_tick_micros );
+
+    // a SysEx edit half way through would go out with the preset, it is dropped and its apply refused
+    if ( the_frame_configs.has_draft( ) ) {
+        the_frame_configs.discard( );
+        the_frame_config_draft_lost = true;
+    }
+
+    // no draft while the readers hold every other snapshot: the modulation stays as it was
+    if ( muppet_frame_config* draft = the_frame_configs.draft( ) ) {
+        muppet_preset_bank::modulation_into( *preset, *draft );
+        draft->settle( );
+        the_frame_configs.publish( );
+    }
+}
+
+// callback for control change
+void preset_control( uint8_t channel, uint8_t control, uint8_t value ) {
+    if ( channel != dr_teeth::k_preset_midi_channel ) {
+        return;
+    }
+
+    if ( control == dr_teeth::k_morph_time_cc ) {
+        the_morph_millis = static_cast< uint16_t >( value & 0x7F ) << 7;
+    } else if ( control == dr_teeth::k_morph_time_cc + 32 ) {
+        the_morph_millis = ( the_morph_millis & ~0x7F ) | ( value & 0x7F );
+    } else if ( control == dr_teeth::k_preset_store_cc ) {
+        // the voice is the frame config's only writer, the current snapshot can't go away under it
+        the_presets.store( value, dr_teeth::input_buffer, *the_frame_configs.peek( ) );
+    }
+}
+
+// drains what the host sent since the last pass, up to k_midi_messages_per_pass;
+// true when a message came in
+bool midi_read( void ) {
+    bool heard = false;
+    for ( uint8_t message = 0; message < dr_teeth::k_midi_messages_per_pass && usbMIDI.read( ); ++message ) {
+        heard = true;
+    }
+    return heard;
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// cv_input_send
+// CV inputs go back to the host as 14 bit CC pairs, MSB on k_cv_input_cc and
+// LSB 32 above it, on the channel's MIDI channel; only changed values are
+// sent, at most every k_cv_input_send_every_millis.
+////////////////////////////////////////////////////////////////////////////////
+
+static uint16_t cv_input_sent[ dr_teeth::k_total_channels ];
+static uint32_t cv_input_sent_at = 0;
+
+void cv_input_send( void ) {
+    if ( !dr_teeth::k_cv_input_mask || millis( ) - cv_input_sent_at < dr_teeth::k_cv_input_send_every_millis ) {
+        return;
+    }
+    cv_input_sent_at = millis( );
+
+    bool sent = false;
+    for ( uint8_t channel_index = 0; channel_index < dr_teeth::k_total_channels; ++channel_index ) {
+        if ( !( dr_teeth::k_cv_input_mask & ( 1 << ( channel_index % dac_driver_t::k_channels ) ) ) ) {
+            continue;
+        }
+
+        // from the common framework 16 bit to MIDI 14 bit
+        uint16_t value = dr_teeth::cv_input_buffer[ channel_index ] / dr_teeth::k_midi_to_framework_scale;
+        if ( value == cv_input_sent[ channel_index ] ) {
+            continue;
+        }
+        cv_input_sent[ channel_index ] = value;
+
+        usbMIDI.sendControlChange( dr_teeth::k_cv_input_cc,      value >> 7,   channel_index + 1 );
+        usbMIDI.sendControlChange( dr_teeth::k_cv_input_cc + 32, value & 0x7F, channel_index + 1 );
+        sent = true;
+    }
+
+    if ( sent ) {
+        usbMIDI.send_now( );
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// config_sysex
+// The config store over SysEx, F0 7D 4D <command> ... F7 (7D: non-commercial
+// manufacturer ID). Values travel as five 7 bit bytes, least significant
+// first. Changes are staged until committed and take effect at the next boot.
+//   01 key v0 v1 v2 v3 v4     stage key = value, not when the board has no such bus, pin or DMA channel
+//   02                        commit what is staged, answers 12 <accepted>
+//   03 key                    read key, answers 13 key <present> v0 v1 v2 v3 v4
+// Routing and calibration edit a draft of the frame config instead, which
+// replaces the one the show reads, all edits at once, when applied; the
+// frame journal keeps what was applied across power cycles:
+//   04 channel input          output channel follows input channel
+//   05 channel v0 .. v4       quantizer step, 0 is off
+//   06 channel g0 .. g4 o0 .. o4  gain (16.16) and offset (two's complement)
+//   07                        apply the draft, answers 17 <accepted>
+//   08 source channel d0 .. d4    modulation route, depth Q15 (two's complement), 0 removes it
+//   09 lfo c0 .. c4 shape     LFO rate in centihertz, shape (muppet_frame_config::lfo_shape)
+//   0A envelope a0 .. a4 r0 .. r4  attack and release in milliseconds
+//   0B random mode h0 .. h4   random source mode (muppet_frame_config::random_mode), hold in ms
+////////////////////////////////////////////////////////////////////////////////
+
+static constexpr uint8_t k_sysex_id          = 0x7D;
+static constexpr uint8_t k_sysex_model       = 0x4D;
+static constexpr uint8_t k_sysex_set         = 0x01;
+static constexpr uint8_t k_sysex_commit      = 0x02;
+static constexpr uint8_t k_sysex_get         = 0x03;
+static constexpr uint8_t k_sysex_route       = 0x04;
+static constexpr uint8_t k_sysex_quantize    = 0x05;
+static constexpr uint8_t k_sysex_calibrate   = 0x06;
+static constexpr uint8_t k_sysex_apply       = 0x07;
+static constexpr uint8_t k_sysex_modulate    = 0x08;
+static constexpr uint8_t k_sysex_lfo         = 0x09;
+static constexpr uint8_t k_sysex_envelope    = 0x0A;
+static constexpr uint8_t k_sysex_random      = 0x0B;
+static constexpr uint8_t k_sysex_answer      = 0x10;     // or'ed into the command being answered
+
+void config_sysex_answer( const uint8_t* payload, uint8_t length ) {
+    uint8_t message[ 12 ] = { 0xF0, k_sysex_id, k_sysex_model };
+
+    memcpy( &message[ 3 ], payload, length );
+    message[ 3 + length ] = 0xF7;
+    usbMIDI.sendSysEx( 4 + length, message, true );
+}
+
+uint32_t config_sysex_value( const uint8_t* bytes ) {
+    uint32_t value = 0;
+    for ( uint8_t index = 0; index < 5; ++index ) {
+        value |= static_cast< uint32_t >( bytes[ index ] & 0x7F ) << ( 7 * index );
+    }
+    return value;
+}
+
+// the frame config draft when channel_index is an output channel; an edit that finds no draft
+// (the show still holds every other snapshot) spoils the apply it belongs to
+muppet_frame_config* frame_config_draft( uint8_t channel_index ) {
+    if ( channel_index >= dr_teeth::k_total_channels ) {
+        return nullptr;
+    }
+
+    muppet_frame_config* draft = the_frame_configs.draft( );
+    the_frame_config_draft_lost = the_frame_config_draft_lost || !draft;
+    return draft;
+}
+
+// callback for system exclusive, complete messages only (F0 and F7 included)
+void config_sysex( const uint8_t* data, uint16_t length, bool complete ) {
+    if ( !complete || length < 5 || data[ 1 ] != k_sysex_id || data[ 2 ] != k_sysex_model ) {
+        return;
+    }
+
+    const uint8_t* arguments       = &data[ 4 ];
+    uint16_t       arguments_count = length - 5;
+
+    switch ( data[ 3 ] ) {
+        case k_sysex_set:
+            if ( arguments_count == 6 ) {
+                the_config.set( arguments[ 0 ], config_sysex_value( &arguments[ 1 ] ) );
+            }
+            break;
+
+        case k_sysex_commit: {
+            uint8_t answer[ 2 ] = { k_sysex_commit | k_sysex_answer, the_config.commit( ) };
+            config_sysex_answer( answer, sizeof( answer ) );
+            break;
+        }
+
+        case k_sysex_get:
+            if ( arguments_count == 1 ) {
+                uint32_t value     = the_config.get( arguments[ 0 ], 0 );
+                uint8_t  answer[ 8 ] = { k_sysex_get | k_sysex_answer, arguments[ 0 ], the_config.has( arguments[ 0 ] ) };
+                for ( uint8_t index = 0; index < 5; ++index ) {
+                    answer[ 3 + index ] = ( value >> ( 7 * index ) ) & 0x7F;
+                }
+                config_sysex_answer( answer, sizeof( answer ) );
+            }
+            break;
+
+        case k_sysex_route:
+            if ( arguments_count == 2 && arguments[ 1 ] < dr_teeth::k_total_channels ) {
+                if ( muppet_frame_config* draft = frame_config_draft( arguments[ 0 ] ) ) {
+                    draft->routing[ arguments[ 0 ] ] = arguments[ 1 ];
+                }
+            }
+            break;
+
+        case k_sysex_quantize:
+            if ( arguments_count == 6 ) {
+                if ( muppet_frame_config* draft = frame_config_draft( arguments[ 0 ] ) ) {
+                    uint32_t step = config_sysex_value( &arguments[ 1 ] );
+                    draft->quantize_step[ arguments[ 0 ] ] = step < dr_teeth::k_max_value ? step : dr_teeth::k_max_value;
+                }
+            }
+            break;
+
+        case k_sysex_calibrate:
+            if ( arguments_count == 11 ) {
+                if ( muppet_frame_config* draft = frame_config_draft( arguments[ 0 ] ) ) {
+                    draft->gain[   arguments[ 0 ] ] = static_cast< int32_t >( config_sysex_value( &arguments[ 1 ] ) );
+                    draft->offset[ arguments[ 0 ] ] = static_cast< int32_t >( config_sysex_value( &arguments[ 6 ] ) );
+                }
+            }
+            break;
+
+        case k_sysex_modulate:
+            if ( arguments_count == 7 ) {
+                if ( muppet_frame_config* draft = frame_config_draft( arguments[ 1 ] ) ) {
+                    int16_t depth = static_cast< int16_t >( config_sysex_value( &arguments[ 2 ] ) );
+                    the_frame_config_draft_lost = !draft->set_route( arguments[ 0 ], arguments[ 1 ], depth ) || the_frame_config_draft_lost;
+                }
+            }
+            break;
+
+        case k_sysex_lfo:
+            if ( arguments_count == 7 && arguments[ 0 ] < dr_teeth::k_lfo_count && arguments[ 6 ] < muppet_frame_config::k_lfo_shape_count ) {
+                if ( muppet_frame_config* draft = frame_config_draft( 0 ) ) {
+                    uint32_t centihertz = config_sysex_value( &arguments[ 1 ] );
+                    draft->lfo_centihertz[ arguments[ 0 ] ] = centihertz < 0xFFFF ? centihertz : 0xFFFF;
+                    draft->lfo_shapes[     arguments[ 0 ] ] = arguments[ 6 ];
+                }
+            }
+            break;
+
+        case k_sysex_envelope:
+            if ( arguments_count == 11 && arguments[ 0 ] < dr_teeth::k_envelope_count ) {
+                if ( muppet_frame_config* draft = frame_config_draft( 0 ) ) {
+                    uint32_t attack  = config_sysex_value( &arguments[ 1 ] );
+                    uint32_t release = config_sysex_value( &arguments[ 6 ] );
+                    draft->envelope_attack_millis[  arguments[ 0 ] ] = attack  < 0xFFFF ? attack  : 0xFFFF;
+                    draft->envelope_release_millis[ arguments[ 0 ] ] = release < 0xFFFF ? release : 0xFFFF;
+                }
+            }
+            break;
+
+        case k_sysex_random:
+            if ( arguments_count == 7 && arguments[ 0 ] < dr_teeth::k_random_count && arguments[ 1 ] < muppet_frame_config::k_random_mode_count ) {
+                if ( muppet_frame_config* draft = frame_config_draft( 0 ) ) {
+                    uint32_t hold = config_sysex_value( &arguments[ 2 ] );
+                    draft->random_modes[       arguments[ 0 ] ] = arguments[ 1 ];
+                    draft->random_hold_millis[ arguments[ 0 ] ] = hold < 0xFFFF ? hold : 0xFFFF;
+                }
+            }
+            break;
+
+        case k_sysex_apply: {
+            bool applied = false;
+            if ( the_frame_config_draft_lost ) {
+                the_frame_configs.discard( );
+            } else if ( muppet_frame_config* draft = the_frame_configs.draft( ) ) {
+                draft->settle( );
+                applied = the_frame_configs.publish( );
+            }
+
+            // what is live now is what the next boot starts from
+            if ( applied ) {
+                the_journal.keep_calibration( *the_frame_configs.peek( ) );
+            }
+            the_frame_config_draft_lost = false;
+
+            uint8_t answer[ 2 ] = { k_sysex_apply | k_sysex_answer, applied };
+            config_sysex_answer( answer, sizeof( answer ) );
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+// a device's key in the store, the board's wiring when it never was set (or was set to
+// something the board does not have, by a firmware that did not check)
+uint8_t configured( uint8_t key, uint8_t fallback ) {
+    uint32_t value = the_config.get( key, fallback );
+    return muppet_config_store::is_valid( key, value ) ? value : fallback;
+}
+
+TwoWire* configured_bus( uint8_t muppet_index, uint8_t fallback ) {
+    static TwoWire* const k_buses[] = { &Wire, &Wire1, &Wire2 };
+    static_assert( sizeof( k_buses ) / sizeof( k_buses[ 0 ] ) == muppet_config_store::k_bus_count, "a bus the store allows has no TwoWire" );
+
+    return k_buses[ configured( muppet_config_store::k_key_bus + muppet_index, fallback ) ];
+}
+
+uint8_t configured_select_pin( uint8_t muppet_index, uint8_t fallback ) {
+    return configured( muppet_config_store::k_key_select_pin + muppet_index, fallback );
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // the_voice_from_beyond
+// the_voice_speaks is one pass, true when the input may have changed. The
+// thread runs it back to back, the event loop every k_voice_every_micros.
 ////////////////////////////////////////////////////////////////////////////////
 
-void the_voice_from_beyond ( void ) {
-    while ( 1 ) {
-        muppet_clock::tick();
-        inspiration.lock();
+bool the_voice_speaks( void ) {
+    muppet_clock::tick();
+    bool heard = muppet_latency_probe::stimulus( micros( ) );
+    heard = the_morph.tick( dr_teeth::input_buffer, micros( ) ) || heard;
 
-        #ifdef LFO_FREQUENCY
-            test_lfo();
-        #else
-            midi_read();
-        #endif
+    const muppet_frame_config* config = the_frame_configs.enter( k_voice_reader );
+    heard = the_modulation.tick( *config, dr_teeth::input_buffer, dr_teeth::cv_input_buffer, micros( ) ) || heard;
+    the_frame_configs.leave( k_voice_reader );
 
+    #ifdef LFO_FREQUENCY
+        test_lfo();
+        heard = true;
+    #else
+        heard = midi_read() || heard;
+        cv_input_send();
+    #endif
+
+    return heard;
+}
 
+void the_voice_from_beyond ( void ) {
+    while ( 1 ) {
+        inspiration.lock();
+        the_voice_speaks();
         inspiration.unlock();
     }
 }
 
 ////////////////////////////////////////////////////////////////////////////////
 // the_muppet_show
+// the_show_goes_on is one pass: the input becomes the devices' next frames.
 ////////////////////////////////////////////////////////////////////////////////
 
+void the_show_goes_on( void ) {
+    // the snapshot holds still until leave(), a new one is the next pass's business
+    const muppet_frame_config* config = the_frame_configs.enter( k_show_reader );
+    dr_teeth::go_muppets( the_muppets, *config, the_modulation.what_offsets( ) );
+    the_frame_configs.leave( k_show_reader );
+
+    // a worker slipping in right after the copy takes the probe's stamp one frame late,
+    // which can only make the thread numbers look worse than they are
+    for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
+        muppet_latency_probe::copied( muppet_index );
+    }
+}
+
 void the_muppet_show ( void ) {
     while ( 1 ) {
         inspiration.lock();
-        dr_teeth::go_muppets( the_muppets );
+        the_show_goes_on();
         inspiration.unlock();
     }
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// run to completion
+// With dr_teeth::k_run_to_completion the voice, the show, the workers and the
+// forced refresh are events on the_loop instead of threads, all run from
+// loop(). Each one finishes before the next starts, so they take no locks
+// among themselves; the voice passes the input on by posting the show, the
+// show and the refresh post the workers.
+////////////////////////////////////////////////////////////////////////////////
+
+void post_workers( void ) {
+    for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
+        the_loop.post( k_worker_event + muppet_index );
+    }
+}
+
+void voice_event( void* ) {
+    if ( the_voice_speaks( ) ) {
+        the_loop.post( k_show_event );
+    }
+}
+
+void show_event( void* ) {
+    the_show_goes_on( );
+    post_workers( );
+}
+
+void worker_event( void* hidden_muppet_index ) {
+    the_muppets.do_your_thing( static_cast< uint8_t >( reinterpret_cast< uintptr_t >( hidden_muppet_index ) ) );
+}
+
+void refresh_event( void* ) {
+    the_muppets.shit_storm( );
+    post_workers( );
+}
+
+////////////////////////////////////////////////////////////////////////////////
+// latency_report
+// The latency probe's numbers, with the CPU share of the execution model:
+// everything but the idle thread 0 for the threads, the loop's own handlers
+// plus the threads that remain (DMA, validation) for the event loop.
+////////////////////////////////////////////////////////////////////////////////
+
+static uint32_t latency_reported_at = 0;
+
+void latency_report( void ) {
+    if ( !dr_teeth::k_latency_probe || millis( ) - latency_reported_at < dr_teeth::k_latency_report_every_millis ) {
+        return;
+    }
+    latency_reported_at = millis( );
+
+    uint16_t cpu_permille = 0;
+    #ifdef THREADS_CYCLE_ACCOUNTING
+    cpu_permille = 1000 - min( threads.getLoadPermille( 0 ), static_cast< uint16_t >( 1000 ) );
+    #endif
+
+    if constexpr ( dr_teeth::k_run_to_completion ) {
+        cpu_permille = min( static_cast< uint16_t >( cpu_permille + the_loop.how_busy_permille( ) ), static_cast< uint16_t >( 1000 ) );
+        muppet_latency_probe::report( Serial, "event loop", cpu_permille );
+    } else {
+        muppet_latency_probe::report( Serial, "threads", cpu_permille );
+    }
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 // DMA Validation System Functions
 ////////////////////////////////////////////////////////////////////////////////
@@ -246,6 +774,14 @@ void initialize_dma_validation_system( void ) {
     
     g_error_handler = new dma_diagnostics::dma_error_handler( error_config );
     
+    // Fault injection stays disabled until a fault is requested
+    g_fault_injector = new drivers::i2c_fault_injector( );
+    g_error_handler->attach_fault_injector( g_fault_injector );
+    #ifdef ENABLE_DMA_OPERATIONS
+    the_muppets.attach_error_handler( g_error_handler );
+    the_muppets.attach_fault_injector( g_fault_injector );
+    #endif
+    
     // Initialize performance validator
     dma_validation::dma_performance_validator::test_config_t perf_config;
     perf_config.test_duration_ms              = 30000;
@@ -258,6 +794,7 @@ void initialize_dma_validation_system( void ) {
     perf_config.thread_slice_limit_us         = 10;
     
     g_perf_validator = new dma_validation::dma_performance_validator( perf_config );
+    g_perf_validator->set_fault_injector( g_fault_injector );
     
     // Initialize test suite
     g_test_suite = new dma_validation::dma_test_suite( g_perf_validator, g_error_handler );
@@ -270,6 +807,8 @@ void initialize_dma_validation_system( void ) {
     monitor_config.enable_constraint_checking  = true;
     monitor_config.alert_threshold_latency_us  = 2000;
     monitor_config.alert_threshold_error_rate  = 1.0f;
+    monitor_config.watched_thread_id           = the_voice_thread_id;   // MIDI input must keep its slices
+    monitor_config.alert_threshold_thread_share_permille = dr_teeth::k_midi_min_cpu_permille;
     
     g_monitor = new dma_validation::dma_realtime_monitor( g_perf_validator, monitor_config );
     
@@ -318,6 +857,47 @@ void stop_dma_validation( void ) {
     }
 }
 
+// cycles per sample of the function generator's sine: the scalar call, the float block and the
+// integer phase block, for blocks of 16 and 256 samples
+void benchmark_function_generator( void ) {
+    static float   times[  256 ];
+    static float   values[ 256 ];
+    static int16_t codes[  256 ];
+    static const uint16_t block_sizes[] = { 16, 256 };
+
+    function_generator generator( 0.01f, 1.0f, 0.0f, 0.0f );
+    uint32_t           step = generator.phaseStep( 48000.0f );
+    for ( uint16_t index = 0; index < 256; ++index ) {
+        times[ index ] = index / 48000.0f;
+    }
+
+    Serial.println( "\n=== FUNCTION GENERATOR (cycles per sample: scalar / block / q15) ===" );
+    for ( uint16_t count : block_sizes ) {
+        uint32_t start_cycles = ARM_DWT_CYCCNT;
+        for ( uint16_t index = 0; index < count; ++index ) {
+            values[ index ] = generator.sinus( times[ index ] );
+        }
+        uint32_t scalar_cycles = ARM_DWT_CYCCNT - start_cycles;
+
+        start_cycles = ARM_DWT_CYCCNT;
+        generator.sinus( times, values, count );
+        uint32_t block_cycles = ARM_DWT_CYCCNT - start_cycles;
+
+        start_cycles = ARM_DWT_CYCCNT;
+        generator.sinus_q15( 0, step, codes, count );
+        uint32_t q15_cycles = ARM_DWT_CYCCNT - start_cycles;
+
+        Serial.print( "n=" );
+        Serial.print( count );
+        Serial.print( ": " );
+        Serial.print( static_cast< float >( scalar_cycles ) / count );
+        Serial.print( " / " );
+        Serial.print( static_cast< float >( block_cycles ) / count );
+        Serial.print( " / " );
+        Serial.println( static_cast< float >( q15_cycles ) / count );
+    }
+}
+
 void handle_validation_commands( void ) {
     if ( !Serial.available( ) || !g_auto_validator ) {
         return;
@@ -365,6 +945,8 @@ void handle_validation_commands( void ) {
                 Serial.print( "DMA Mode: " );
                 #ifdef ENABLE_DMA_OPERATIONS
                 Serial.println( "ENABLED" );
+                Serial.print( "DMA frames: " );
+                Serial.println( the_muppets.do_frames_fit( ) ? "coroutine" : "SYNC, the coroutine frame outgrew its pool" );
                 #else
                 Serial.println( "DISABLED" );
                 #endif
@@ -376,8 +958,184 @@ void handle_validation_commands( void ) {
                     Serial.print( "Performance Acceptable: " );
                     Serial.println( g_monitor->is_performance_acceptable() ? "YES" : "NO" );
                 }
+
+                Serial.print( "Frame journal: " );
+                Serial.print( the_journal.was_restored( ) ? "restored, " : "empty at boot, " );
+                Serial.print( the_journal.how_many_writes( ) );
+                Serial.print( " writes, sequence " );
+                Serial.print( the_journal.what_sequence( ) );
+                Serial.print( ", longest EEPROM write (interrupts off at most) " );
+                Serial.print( the_journal.how_long_at_most( ) );
+                Serial.print( " cycles, " );
+                Serial.print( the_journal.how_many_calibration_writes( ) );
+                Serial.println( " calibration writes" );
+
+                Serial.print( "Config store: generation " );
+                Serial.print( the_config.what_generation( ) );
+                Serial.print( ", " );
+                Serial.print( the_config.how_many_commits( ) );
+                Serial.print( " commits, " );
+                Serial.print( the_config.how_many_compactions( ) );
+                Serial.println( the_config.is_writing( ) ? " compactions, writing" : " compactions" );
+
+                Serial.print( "Presets: " );
+                Serial.print( the_presets.how_many_stored( ) );
+                Serial.print( " stored, " );
+                Serial.print( the_presets.how_many_writes( ) );
+                Serial.println( the_morph.is_running( ) ? " writes, morphing" : " writes" );
+
+                Serial.print( "Modulation: " );
+                Serial.print( the_modulation.how_many_routes( ) );
+                Serial.print( " routes, " );
+                Serial.print( the_modulation.how_long_last( ) );
+                Serial.print( " cycles per tick, at most " );
+                Serial.println( the_modulation.how_long_at_most( ) );
+
+                Serial.print( "Frame config: epoch " );
+                Serial.print( the_frame_configs.what_epoch( ) );
+                Serial.print( ", " );
+                Serial.print( the_frame_configs.how_many_publishes( ) );
+                Serial.println( the_frame_configs.peek( )->identity ? " applied, identity" : " applied" );
+
+                for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) 
+                {
+                    uint32_t first_frame_micros = the_muppets.how_are_you( muppet_index ).how_long_to_first_frame( );
+                    Serial.print( "Boot to first frame, DAC " );
+                    Serial.print( muppet_index );
+                    Serial.print( ": " );
+                    if ( first_frame_micros ) 
+                    {
+                        Serial.print( first_frame_micros / 1000.0f, 2 );
+                        Serial.println( " ms" );
+                    } 
+                    else 
+                    {
+                        Serial.println( "none yet" );
+                    }
+                }
+
+                if ( dr_teeth::k_cv_input_mask ) 
+                {
+                    for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) 
+                    {
+                        const muppet_cv_input& cv_input = the_muppets.how_well_do_you_hear( muppet_index );
+                        Serial.print( "CV Input Bus " );
+                        Serial.print( muppet_index );
+                        Serial.print( ": " );
+                        Serial.print( cv_input.how_many_samples_per_second() );
+                        Serial.print( " samples/s, " );
+                        Serial.print( cv_input.how_many_errors() );
+                        Serial.println( " errors" );
+                    }
+                }
+            }
+            break;
+            
+        case 'f':
+        case 'F':
+            if ( g_perf_validator ) 
+            {
+                if ( !g_perf_validator->is_stress_testing_active( ) ) 
+                {
+                    g_perf_validator->enable_stress_testing( );
+                }
+                g_perf_validator->inject_error_scenario( g_fault_dac_index );
+                g_fault_dac_index = ( g_fault_dac_index + 1 ) % dr_teeth::k_dac_count;
+            }
+            break;
+            
+        case 'l':
+        case 'L':
+            if ( g_error_handler ) 
+            {
+                g_error_handler->print_fault_latency_report( );
+            }
+            break;
+
+        case 'g':
+        case 'G':
+            benchmark_function_generator( );
+            break;
+            
+        #ifdef ENABLE_DMA_OPERATIONS
+        case 't':
+        case 'T':
+            Serial.println( "\n=== TRANSPORT ARBITERS ===" );
+            for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) 
+            {
+                const transport_arbiter& transport = the_muppets.which_transport( muppet_index );
+                const transport_arbiter::switch_statistics_t& stats = transport.get_statistics( );
+                
+                Serial.print( "DAC " );
+                Serial.print( muppet_index );
+                Serial.print( transport.uses_dma( ) ? ": DMA" : ": SYNC" );
+                Serial.print( ", switches " );
+                Serial.print( stats.switches_to_sync + stats.switches_to_dma );
+                Serial.print( " (last/max " );
+                Serial.print( stats.last_switch_cycles );
+                Serial.print( "/" );
+                Serial.print( stats.max_switch_cycles );
+                Serial.print( " cycles), stale claims " );
+                Serial.print( stats.stale_claims );
+                Serial.print( ", stale commits " );
+                Serial.println( stats.stale_commits );
             }
             break;
+        #endif
+
+        #ifdef THREADS_CYCLE_ACCOUNTING
+        case 'u':
+        case 'U':
+            Serial.println( "\n=== THREAD CPU (1s / 10s permille, max run cycles) ===" );
+            for ( int thread_id = 0; thread_id < Threads::MAX_THREADS; ++thread_id ) 
+            {
+                uint32_t run_max = threads.getRunMax( thread_id, true );
+                if ( run_max == 0 ) 
+                {
+                    continue;
+                }
+                Serial.print( "Thread " );
+                Serial.print( thread_id );
+                Serial.print( thread_id == the_voice_thread_id ? " (midi): " : ": " );
+                Serial.print( threads.getLoadPermille( thread_id ) );
+                Serial.print( " / " );
+                Serial.print( threads.getLoadPermille( thread_id, true ) );
+                Serial.print( ", " );
+                #ifdef THREADS_STACK_PROFILING
+                Serial.print( run_max );
+                Serial.print( ", stack " );
+                Serial.print( threads.getStackHighWater( thread_id ) );
+                Serial.print( " / " );
+                Serial.println( threads.getStackSize( thread_id ) );
+                #else
+                Serial.println( run_max );
+                #endif
+            }
+            break;
+        #endif
+
+        #ifdef THREADS_SWITCH_PROFILING
+        case 'k':
+        case 'K':
+            {
+                // the scheduler's share of a context switch since the last 'k'
+                uint32_t switches = threads.getSwitchCount( );
+                Serial.println( "\n=== SCHEDULER ===" );
+                Serial.print( "Switches: " );
+                Serial.print( switches );
+                Serial.print( ", avg " );
+                Serial.print( switches ? threads.getSwitchCycles( ) / switches : 0 );
+                Serial.print( " cycles, max " );
+                Serial.print( threads.getSwitchCyclesMax( ) );
+                #ifdef THREADS_LINEAR_SCAN
+                Serial.println( " cycles (linear scan)" );
+                #else
+                Serial.println( " cycles (ready bitmap)" );
+                #endif
+                threads.resetSwitchProfile( );
+            }
+            break;
+        #endif
             
         case 'h':
         case 'H':
@@ -386,52 +1144,23 @@ void handle_validation_commands( void ) {
             Serial.println( "v - Toggle validation on/off" );
             Serial.println( "r - Show validation results" );
             Serial.println( "s - Show system status" );
+            Serial.println( "f - Inject next I2C fault (round-robin DACs)" );
+            Serial.println( "l - Show fault recovery latency" );
+            Serial.println( "g - Benchmark the function generator" );
+            #ifdef ENABLE_DMA_OPERATIONS
+            Serial.println( "t - Show transport arbiters" );
+            #endif
+            #ifdef THREADS_CYCLE_ACCOUNTING
+            Serial.println( "u - Show per-thread CPU share" );
+            #endif
+            #ifdef THREADS_SWITCH_PROFILING
+            Serial.println( "k - Show scheduler switch cost" );
+            #endif
             Serial.println( "h - Show this help" );
             break;
     }
 }
 
-void cleanup_validation_system( void ) 
-{
-    if ( g_auto_validator ) 
-    {
-        if ( g_auto_validator->is_validation_active( ) ) 
-        {
-            g_auto_validator->stop_validation( );
-        }
-        delete g_auto_validator;
-        g_auto_validator = nullptr;
-    }
-    
-    if ( g_monitor ) 
-    {
-        if ( g_monitor->is_monitoring_active( ) ) 
-        {
-            g_monitor->stop_monitoring( );
-        }
-        delete g_monitor;
-        g_monitor = nullptr;
-    }
-    
-    if ( g_test_suite ) 
-    {
-        delete g_test_suite;
-        g_test_suite = nullptr;
-    }
-    
-    if ( g_perf_validator ) 
-    {
-        delete g_perf_validator;
-        g_perf_validator = nullptr;
-    }
-    
-    if ( g_error_handler ) 
-    {
-        delete g_error_handler;
-        g_error_handler = nullptr;
-    }
-}
-
 #endif // ENABLE_DMA_VALIDATION
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -439,14 +1168,33 @@ void cleanup_validation_system( void )
 ////////////////////////////////////////////////////////////////////////////////
 
 void setup( void ) {
-  dac_driver_t::initialization_struct_t initialization_structs[ dr_teeth::k_dac_count ] = {
-        dac_driver_t::initialization_struct_t( &Wire2, 11 ),
-        dac_driver_t::initialization_struct_t( &Wire1, 37 ),
+    // the wiring comes from the config store, the fallbacks are the board as built
+    the_config.load( );
+    the_presets.load( );
+
+    dac_driver_t::initialization_struct_t initialization_structs[ dr_teeth::k_dac_count ] = {
+        dac_driver_t::initialization_struct_t( configured_bus( 0, 2 ), configured_select_pin( 0, 11 ) ),
+        dac_driver_t::initialization_struct_t( configured_bus( 1, 1 ), configured_select_pin( 1, 37 ) ),
     };
 
+    // the last frame before power went away is the first one the workers write, through the
+    // routing and calibration last applied; nobody reads the configs yet, the draft is there
+    the_journal.restore( );
+    if ( muppet_frame_config* draft = the_frame_configs.draft( ) ) {
+        if ( the_journal.restore_calibration( *draft ) ) {
+            draft->settle( );
+            the_frame_configs.publish( );
+        } else {
+            the_frame_configs.discard( );
+        }
+    }
+
 #ifdef ENABLE_DMA_OPERATIONS
     // DMA channels for each DAC (0-31 available on Teensy 4.1)
-    uint8_t dma_channels[ dr_teeth::k_dac_count ] = { 0, 1 };
+    uint8_t dma_channels[ dr_teeth::k_dac_count ] = {
+        configured( muppet_config_store::k_key_dma_channel + 0, 0 ),
+        configured( muppet_config_store::k_key_dma_channel + 1, 1 ),
+    };
     the_muppets.initialize( initialization_structs, dma_channels );
     
     // Set DMA mode (ENABLED allows fallback, REQUIRED fails if DMA unavailable)
@@ -460,10 +1208,29 @@ void setup( void ) {
         the_function_generator.setAmplitude( dr_teeth::k_audio_half_scale - 1 );
     #endif
 
+    for ( uint8_t channel_index = 0; channel_index < dr_teeth::k_total_channels; ++channel_index ) {
+        trigger_deadlines[ channel_index ] = deadline_timer::k_invalid_handle;
+    }
+
     usbMIDI.setHandlePitchChange( set_channel_value );
+    usbMIDI.setHandleNoteOn(      open_gate );
+    usbMIDI.setHandleNoteOff(     close_gate );
+    usbMIDI.setHandleSystemExclusive( config_sysex );
+    usbMIDI.setHandleProgramChange( recall_preset );
+    usbMIDI.setHandleControlChange( preset_control );
     threads.setSliceMicros( dr_teeth::k_thread_slice_micros );
-    threads.addThread( the_muppet_show );
-    threads.addThread( the_voice_from_beyond );
+
+    if constexpr ( dr_teeth::k_run_to_completion ) {
+        the_loop.on( k_voice_event,   voice_event,   nullptr, dr_teeth::k_voice_every_micros );
+        the_loop.on( k_show_event,    show_event,    nullptr );
+        for ( uint8_t muppet_index = 0; muppet_index < dr_teeth::k_dac_count; ++muppet_index ) {
+            the_loop.on( k_worker_event + muppet_index, worker_event, reinterpret_cast< void* >( static_cast< uintptr_t >( muppet_index ) ), dr_teeth::k_worker_every_micros );
+        }
+        the_loop.on( k_refresh_event, refresh_event, nullptr, dr_teeth::k_force_refresh_every_millis * 1000 );
+    } else {
+        threads.addThread( the_muppet_show, 0, sizeof( the_muppet_show_stack ), the_muppet_show_stack );
+        the_voice_thread_id = threads.addThread( the_voice_from_beyond, 0, sizeof( the_voice_stack ), the_voice_stack );
+    }
 
     // Initialize DMA Validation System if enabled
     #ifdef ENABLE_DMA_VALIDATION
@@ -473,8 +1240,13 @@ void setup( void ) {
     Serial.println( "MASTER OF MUPPETS - DMA VALIDATION MODE" );
     Serial.println( "========================================" );
     Serial.println( "DMA Mode: ENABLED" );
+    #ifdef ENABLE_DMA_OPERATIONS
+    if ( !the_muppets.do_frames_fit( ) ) {
+        Serial.println( "WARNING: DMA frame coroutine does not fit muppet_frame_pool, frames go out SYNC" );
+    }
+    #endif
     Serial.println( "Validation System: AVAILABLE" );
-    Serial.println( "Commands: v=toggle, r=results, s=status, h=help" );
+    Serial.println( "Commands: v=toggle, r=results, s=status, f=fault, l=latency, h=help" );
     Serial.println( "========================================\n" );
     
     // Initialize but don't start validation automatically
@@ -483,12 +1255,22 @@ void setup( void ) {
 }
 
 ////////////////////////////////////////////////////////////////////////////////
-// loop - just because it is required
+// loop - just because it is required, unless the muppets run to completion
 ////////////////////////////////////////////////////////////////////////////////
 
 void loop( void ) 
 { 
+    if constexpr ( dr_teeth::k_run_to_completion ) {
+        // events back to back while there are any, the remaining threads get the idle time
+        while ( the_loop.run( ) ) { }
+    }
     threads.yield( );
+
+    // idle time only, an EEPROM write may wait for a flash erase
+    the_journal.keep( the_muppets, millis( ) );
+    the_config.keep( );
+    the_presets.keep( );
+    latency_report( );
     
     // Handle DMA validation commands if enabled
     #ifdef ENABLE_DMA_VALIDATION
@@ -1,6 +1,18 @@
 #pragma once
 
 #include "dr_teeth.h"
+#include "muppet_latency_probe.h"
 
 uint16_t                     dr_teeth::input_buffer[ dr_teeth::k_total_channels ]   = { 0 };
 uint16_t                    dr_teeth::output_buffer[ dr_teeth::k_total_channels ]   = { 0 };
+volatile uint8_t             dr_teeth::input_gates[  dr_teeth::k_dac_count ]       = { 0 };
+uint8_t                      dr_teeth::output_gates[ dr_teeth::k_dac_count ]       = { 0 };
+volatile uint16_t            dr_teeth::cv_input_buffer[ dr_teeth::k_total_channels ] = { 0 };
+
+uint32_t                                    muppet_latency_probe::next_stimulus_micros                        = 0;
+volatile uint32_t                           muppet_latency_probe::stimulus_stamps[  dr_teeth::k_dac_count ]   = { 0 };
+volatile uint32_t                           muppet_latency_probe::copied_stamps[    dr_teeth::k_dac_count ]   = { 0 };
+uint32_t                                    muppet_latency_probe::taken_stamps[     dr_teeth::k_dac_count ]   = { 0 };
+uint32_t                                    muppet_latency_probe::in_flight_stamps[ dr_teeth::k_dac_count ]   = { 0 };
+muppet_latency_probe::statistics_t          muppet_latency_probe::statistics[       dr_teeth::k_dac_count ];
+volatile bool                               muppet_latency_probe::restart[          dr_teeth::k_dac_count ]   = { false };
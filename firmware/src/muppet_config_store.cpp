@@ -0,0 +1,321 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <cstddef>
+#include <cstring>
+
+#include "muppet_config_store.h"
+#include "muppet_crc.h"
+
+#ifdef CORE_NUM_DIGITAL
+static_assert( muppet_config_store::k_pin_count == CORE_NUM_DIGITAL, "the config store's pins are not this board's" );
+#endif
+
+muppet_config_store::muppet_config_store( void ) :
+    present(        0                ),
+    staged(         0                ),
+    outbox(         0                ),
+    active_segment( 0                ),
+    has_header(     false            ),
+    version(        k_schema_version ),
+    generation(     0                ),
+    write_offset(   sizeof( header_t ) ),
+    transaction(    0                ),
+    span_count(     0                ),
+    span_index(     0                ),
+    span_offset(    0                ),
+    compacting(     false            ),
+    image_records(  0                ),
+    commits(        0                ),
+    compactions(    0                )
+{
+    memset( values,        0, sizeof( values        ) );
+    memset( staged_values, 0, sizeof( staged_values ) );
+    memset( outbox_values, 0, sizeof( outbox_values ) );
+}
+
+void muppet_config_store::load( void ) {
+    header_t headers[ 2 ];
+    bool     valid[ 2 ] = { read_segment( 0, headers[ 0 ] ), read_segment( 1, headers[ 1 ] ) };
+
+    if ( !valid[ 0 ] && !valid[ 1 ] ) {
+        // never written, the first commit lays the store down
+        return;
+    }
+
+    uint8_t segment = valid[ 0 ] ? 0 : 1;
+    if ( valid[ 0 ] && valid[ 1 ] && static_cast< int32_t >( headers[ 1 ].generation - headers[ 0 ].generation ) > 0 ) {
+        segment = 1;
+    }
+
+    active_segment = segment;
+    generation     = headers[ segment ].generation;
+    version        = headers[ segment ].version;
+
+    if ( version > k_schema_version ) {
+        // written by newer firmware: run on defaults, the next commit starts over
+        return;
+    }
+
+    has_header = true;
+    replay( segment );
+
+    if ( version < k_schema_version ) {
+        migrate( version );
+        start_compaction( );
+    }
+}
+
+uint32_t muppet_config_store::get( uint8_t key, uint32_t fallback ) const {
+    return has( key ) ? values[ key ] : fallback;
+}
+
+bool muppet_config_store::is_valid( uint8_t key, uint32_t value ) {
+    if ( key < k_key_select_pin ) {
+        return value < k_bus_count;
+    }
+    if ( key < k_key_dma_channel ) {
+        return value < k_pin_count;
+    }
+    return key < k_key_count && value < k_dma_channel_count;
+}
+
+bool muppet_config_store::set( uint8_t key, uint32_t value ) {
+    if ( !is_valid( key, value ) ) {
+        return false;
+    }
+
+    __disable_irq();
+    staged_values[ key ] = value;
+    staged               = staged | ( 1UL << key );
+    __enable_irq();
+    return true;
+}
+
+bool muppet_config_store::commit( void ) {
+    __disable_irq();
+    if ( outbox ) {
+        __enable_irq();
+        return false;
+    }
+
+    uint32_t ready = staged;
+    for ( uint8_t key = 0; key < k_key_count; ++key ) {
+        if ( ready & ( 1UL << key ) ) {
+            outbox_values[ key ] = staged_values[ key ];
+        }
+    }
+    outbox = ready;
+    staged = 0;
+    __enable_irq();
+    return true;
+}
+
+void muppet_config_store::keep( void ) {
+    if ( !span_count ) {
+        uint32_t ready = outbox;
+        if ( !ready ) {
+            return;
+        }
+
+        int bytes = __builtin_popcount( ready ) * sizeof( record_t );
+        if ( !has_header || version != k_schema_version || write_offset + bytes > k_segment_bytes ) {
+            start_compaction( );
+        } else {
+            start_append( );
+        }
+    }
+
+    for ( int budget = dr_teeth::k_config_bytes_per_pass; budget > 0 && span_index < span_count; ) {
+        const span_t& span = spans[ span_index ];
+        if ( span_offset >= span.length ) {
+            ++span_index;
+            span_offset = 0;
+            continue;
+        }
+
+        EEPROM.update( span.address + span_offset, span.data ? span.data[ span_offset ] : k_blank );
+        ++span_offset;
+        --budget;
+    }
+
+    if ( span_index == span_count ) {
+        finish( );
+    }
+}
+
+void muppet_config_store::start_append( void ) {
+    record_t* records = reinterpret_cast< record_t* >( image );
+    uint32_t  ready   = outbox;
+
+    ++transaction;
+    image_records = 0;
+    for ( uint8_t key = 0; key < k_key_count; ++key ) {
+        if ( !( ready & ( 1UL << key ) ) ) {
+            continue;
+        }
+
+        record_t& record = records[ image_records++ ];
+        record.key         = key;
+        record.flags       = ( ready >> ( key + 1 ) ) ? 0 : k_flag_last;
+        record.transaction = transaction;
+        record.value       = outbox_values[ key ];
+        record.crc         = crc_of( record );
+    }
+
+    // one span: a record cut short fails its CRC and takes its transaction with it
+    spans[ 0 ]  = { segment_address( active_segment ) + write_offset, static_cast< uint16_t >( image_records * sizeof( record_t ) ), image };
+    span_count  = 1;
+    span_index  = 0;
+    span_offset = 0;
+    compacting  = false;
+}
+
+void muppet_config_store::start_compaction( void ) {
+    header_t& header  = *reinterpret_cast< header_t* >( image );
+    record_t* records =  reinterpret_cast< record_t* >( image + sizeof( header_t ) );
+    uint32_t  ready   = outbox;
+    uint32_t  live    = present | ready;
+
+    // the index with the transaction on top, as the new segment's only transaction
+    transaction   = 0;
+    image_records = 0;
+    for ( uint8_t key = 0; key < k_key_count; ++key ) {
+        if ( !( live & ( 1UL << key ) ) ) {
+            continue;
+        }
+
+        record_t& record = records[ image_records++ ];
+        record.key         = key;
+        record.flags       = ( live >> ( key + 1 ) ) ? 0 : k_flag_last;
+        record.transaction = transaction;
+        record.value       = ( ready & ( 1UL << key ) ) ? outbox_values[ key ] : values[ key ];
+        record.crc         = crc_of( record );
+    }
+
+    header.magic      = k_magic;
+    header.version    = k_schema_version;
+    header.reserved   = 0;
+    header.generation = generation + 1;
+    header.crc        = crc_of( header );
+
+    // the target's header goes first and comes back last, whatever is in between is invisible
+    int      target        = segment_address( 1 - active_segment );
+    uint16_t records_bytes = image_records * sizeof( record_t );
+    uint16_t used_bytes    = sizeof( header_t ) + records_bytes;
+
+    spans[ 0 ]  = { target,                               sizeof( header_t ),                                      nullptr                    };
+    spans[ 1 ]  = { target + int( sizeof( header_t ) ),   records_bytes,                                           image + sizeof( header_t ) };
+    spans[ 2 ]  = { target + used_bytes,                  static_cast< uint16_t >( k_segment_bytes - used_bytes ), nullptr                    };
+    spans[ 3 ]  = { target,                               sizeof( header_t ),                                      image                      };
+    span_count  = 4;
+    span_index  = 0;
+    span_offset = 0;
+    compacting  = true;
+}
+
+void muppet_config_store::finish( void ) {
+    if ( compacting ) {
+        active_segment = 1 - active_segment;
+        generation    += 1;
+        version        = k_schema_version;
+        has_header     = true;
+        write_offset   = sizeof( header_t ) + image_records * sizeof( record_t );
+        ++compactions;
+    } else {
+        write_offset  += image_records * sizeof( record_t );
+    }
+
+    __disable_irq();
+    uint32_t ready = outbox;
+    for ( uint8_t key = 0; key < k_key_count; ++key ) {
+        if ( ready & ( 1UL << key ) ) {
+            values[ key ] = outbox_values[ key ];
+        }
+    }
+    present |= ready;
+    outbox   = 0;
+    __enable_irq();
+
+    if ( ready ) {
+        ++commits;
+    }
+
+    span_count  = 0;
+    span_index  = 0;
+    span_offset = 0;
+}
+
+void muppet_config_store::migrate( uint16_t from_version ) {
+    // one case per schema step, each falling through to the next; the index holds the old
+    // schema's keys on the way in and the current one's on the way out
+    switch ( from_version ) {
+        case 0:     // no schema before the first one
+        default:
+            break;
+    }
+}
+
+bool muppet_config_store::read_segment( uint8_t segment, header_t& header ) const {
+    read_bytes( segment_address( segment ), &header, sizeof( header ) );
+    return header.magic == k_magic && header.crc == crc_of( header );
+}
+
+void muppet_config_store::replay( uint8_t segment ) {
+    uint32_t pending_values[ k_key_count ];
+    uint32_t pending             = 0;
+    uint16_t pending_transaction = 0;
+    int      offset              = sizeof( header_t );
+
+    while ( offset + static_cast< int >( sizeof( record_t ) ) <= k_segment_bytes ) {
+        record_t record;
+        read_bytes( segment_address( segment ) + offset, &record, sizeof( record ) );
+        if ( record.key == k_blank && record.flags == k_blank ) {
+            break;
+        }
+        offset += sizeof( record );
+
+        // torn, or the first record of another transaction: whatever was collected never committed
+        if ( record.crc != crc_of( record ) ) {
+            pending = 0;
+            continue;
+        }
+        if ( record.transaction != pending_transaction ) {
+            pending             = 0;
+            pending_transaction = record.transaction;
+        }
+        transaction = record.transaction;
+
+        // keys a newer schema added are carried along by nobody, skip them
+        if ( record.key < k_key_count ) {
+            pending_values[ record.key ] = record.value;
+            pending                     |= 1UL << record.key;
+        }
+
+        if ( record.flags & k_flag_last ) {
+            for ( uint8_t key = 0; key < k_key_count; ++key ) {
+                if ( pending & ( 1UL << key ) ) {
+                    values[ key ] = pending_values[ key ];
+                }
+            }
+            present |= pending;
+            pending  = 0;
+        }
+    }
+
+    write_offset = offset;
+}
+
+uint32_t muppet_config_store::crc_of( const header_t& header ) {
+    return muppet_crc::crc32( &header, offsetof( header_t, crc ) );
+}
+
+uint32_t muppet_config_store::crc_of( const record_t& record ) {
+    return muppet_crc::crc32( &record, offsetof( record_t, crc ) );
+}
+
+void muppet_config_store::read_bytes( int address, void* destination, int length ) {
+    uint8_t* bytes = static_cast< uint8_t* >( destination );
+    for ( int index = 0; index < length; ++index ) {
+        bytes[ index ] = EEPROM.read( address + index );
+    }
+}
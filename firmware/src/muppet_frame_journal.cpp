@@ -0,0 +1,215 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <cstddef>
+#include <cstring>
+
+#include "muppet_frame_journal.h"
+#include "muppet_crc.h"
+
+muppet_frame_journal::muppet_frame_journal( void ) :
+    dirty(              false ),
+    restored(           false ),
+    next_slot(          0     ),
+    sequence(           0     ),
+    checked_at_millis(  0     ),
+    changed_at_millis(  0     ),
+    dirty_since_millis( 0     ),
+    written_at_millis(  0     ),
+    writes(             0     ),
+    max_update_cycles(  0     ),
+    calibration_dirty(    false ),
+    calibration_slot(     0     ),
+    calibration_sequence( 0     ),
+    calibration_writes(   0     )
+{
+    memset( pending,      0, sizeof( pending      ) );
+    memset( saved,        0, sizeof( saved        ) );
+    memset( &calibration, 0, sizeof( calibration  ) );
+}
+
+bool muppet_frame_journal::restore( void ) {
+    record_t newest;
+    bool     found = false;
+
+    for ( uint8_t slot = 0; slot < k_slots; ++slot ) {
+        record_t record;
+        if ( !read_slot( slot, record ) ) {
+            continue;
+        }
+
+        if ( !found || static_cast< int32_t >( record.sequence - newest.sequence ) > 0 ) {
+            newest    = record;
+            next_slot = ( slot + 1 ) % k_slots;
+            found     = true;
+        }
+    }
+
+    if ( !found ) {
+        return false;
+    }
+
+    sequence = newest.sequence;
+    memcpy( saved,   newest.frame, sizeof( saved   ) );
+    memcpy( pending, newest.frame, sizeof( pending ) );
+
+    // the show copies input to output, both have to start from the journal
+    memcpy( dr_teeth::input_buffer,  newest.frame, sizeof( newest.frame ) );
+    memcpy( dr_teeth::output_buffer, newest.frame, sizeof( newest.frame ) );
+
+    restored = true;
+    return true;
+}
+
+bool muppet_frame_journal::restore_calibration( muppet_frame_config& config ) {
+    calibration_record_t newest;
+    bool                 found = false;
+
+    for ( uint8_t slot = 0; slot < k_calibration_slots; ++slot ) {
+        calibration_record_t record;
+        if ( !read_slot( slot, record ) ) {
+            continue;
+        }
+
+        if ( !found || static_cast< int32_t >( record.sequence - newest.sequence ) > 0 ) {
+            newest           = record;
+            calibration_slot = ( slot + 1 ) % k_calibration_slots;
+            found            = true;
+        }
+    }
+
+    if ( !found ) {
+        return false;
+    }
+
+    calibration_sequence = newest.sequence;
+    for ( uint8_t channel_index = 0; channel_index < dr_teeth::k_total_channels; ++channel_index ) {
+        // no apply routes past the inputs, whatever does keeps the channel on its own input
+        config.routing[       channel_index ] = newest.routing[ channel_index ] < dr_teeth::k_total_channels ? newest.routing[ channel_index ] : channel_index;
+        config.quantize_step[ channel_index ] = newest.quantize_step[ channel_index ];
+        config.gain[          channel_index ] = newest.gain[          channel_index ];
+        config.offset[        channel_index ] = newest.offset[        channel_index ];
+    }
+    return true;
+}
+
+void muppet_frame_journal::keep_calibration( const muppet_frame_config& config ) {
+    // write_calibration() copies it out with interrupts off as well, it never sees half of one
+    __disable_irq();
+    memcpy( calibration.routing,       config.routing,       sizeof( calibration.routing ) );
+    memcpy( calibration.quantize_step, config.quantize_step, sizeof( calibration.quantize_step ) );
+    memcpy( calibration.gain,          config.gain,          sizeof( calibration.gain ) );
+    memcpy( calibration.offset,        config.offset,        sizeof( calibration.offset ) );
+    calibration_dirty = true;
+    __enable_irq();
+}
+
+void muppet_frame_journal::consider( const uint16_t* frame, uint32_t now_millis ) {
+    if ( memcmp( frame, pending, sizeof( pending ) ) != 0 ) {
+        memcpy( pending, frame, sizeof( pending ) );
+        changed_at_millis = now_millis;
+
+        bool was_dirty = dirty;
+        dirty          = memcmp( pending, saved, sizeof( saved ) ) != 0;
+        if ( dirty && !was_dirty ) {
+            dirty_since_millis = now_millis;
+        }
+    }
+
+    if ( !dirty || ( writes && now_millis - written_at_millis < dr_teeth::k_journal_every_millis ) ) {
+        return;
+    }
+
+    if ( now_millis - changed_at_millis >= dr_teeth::k_journal_settle_millis ||
+         now_millis - dirty_since_millis >= dr_teeth::k_journal_max_lag_millis ) {
+        write( now_millis );
+    }
+}
+
+void muppet_frame_journal::write( uint32_t now_millis ) {
+    record_t record;
+    record.sequence = sequence + 1;
+    memcpy( record.frame, pending, sizeof( record.frame ) );
+    record.crc      = crc_of( record );
+
+    write_slot( next_slot, record );
+
+    sequence          = record.sequence;
+    next_slot         = ( next_slot + 1 ) % k_slots;
+    written_at_millis = now_millis;
+    dirty             = false;
+    memcpy( saved, pending, sizeof( saved ) );
+    ++writes;
+}
+
+void muppet_frame_journal::write_calibration( void ) {
+    if ( !calibration_dirty ) {
+        return;
+    }
+
+    calibration_record_t record;
+
+    __disable_irq();
+    record            = calibration;
+    calibration_dirty = false;
+    __enable_irq();
+
+    record.sequence = calibration_sequence + 1;
+    record.crc      = crc_of( record );
+
+    write_slot( calibration_slot, record );
+
+    calibration_sequence = record.sequence;
+    calibration_slot     = ( calibration_slot + 1 ) % k_calibration_slots;
+    ++calibration_writes;
+}
+
+bool muppet_frame_journal::read_slot( uint8_t slot, record_t& record ) {
+    read_bytes( dr_teeth::k_journal_eeprom_base + slot * k_record_bytes, reinterpret_cast< uint8_t* >( &record ), k_record_bytes );
+    return record.crc == crc_of( record );
+}
+
+bool muppet_frame_journal::read_slot( uint8_t slot, calibration_record_t& record ) {
+    read_bytes( dr_teeth::k_calibration_eeprom_base + slot * k_calibration_record_bytes, reinterpret_cast< uint8_t* >( &record ), k_calibration_record_bytes );
+    return record.crc == crc_of( record );
+}
+
+void muppet_frame_journal::write_slot( uint8_t slot, const record_t& record ) {
+    write_bytes( dr_teeth::k_journal_eeprom_base + slot * k_record_bytes, reinterpret_cast< const uint8_t* >( &record ), k_record_bytes );
+}
+
+void muppet_frame_journal::write_slot( uint8_t slot, const calibration_record_t& record ) {
+    write_bytes( dr_teeth::k_calibration_eeprom_base + slot * k_calibration_record_bytes, reinterpret_cast< const uint8_t* >( &record ), k_calibration_record_bytes );
+}
+
+// both records start with their sequence, which goes last: until then the slot fails its CRC
+// and the previous record stands
+void muppet_frame_journal::write_bytes( int address, const uint8_t* bytes, int length ) {
+    for ( int index = sizeof( uint32_t ); index < length; ++index ) {
+        update( address + index, bytes[ index ] );
+    }
+    for ( int index = 0; index < static_cast< int >( sizeof( uint32_t ) ); ++index ) {
+        update( address + index, bytes[ index ] );
+    }
+}
+
+void muppet_frame_journal::read_bytes( int address, uint8_t* bytes, int length ) {
+    for ( int index = 0; index < length; ++index ) {
+        bytes[ index ] = EEPROM.read( address + index );
+    }
+}
+
+void muppet_frame_journal::update( int address, uint8_t value ) {
+    uint32_t start_cycles = ARM_DWT_CYCCNT;
+    EEPROM.update( address, value );
+
+    uint32_t cycles   = ARM_DWT_CYCCNT - start_cycles;
+    max_update_cycles = cycles > max_update_cycles ? cycles : max_update_cycles;
+}
+
+uint32_t muppet_frame_journal::crc_of( const record_t& record ) {
+    return muppet_crc::crc32( &record, offsetof( record_t, crc ), k_version );
+}
+
+uint32_t muppet_frame_journal::crc_of( const calibration_record_t& record ) {
+    return muppet_crc::crc32( &record, offsetof( calibration_record_t, crc ), k_version );
+}
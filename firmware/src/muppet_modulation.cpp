@@ -0,0 +1,207 @@
+#include <Arduino.h>
+#include <cstring>
+
+#include "muppet_modulation.h"
+
+muppet_modulation::muppet_modulation( void ) :
+    live(             0 ),
+    lfo_ready(        0 ),
+    envelope_open(    0 ),
+    envelope_moving(  0 ),
+    random_clocked(   0 ),
+    routes(           0 ),
+    ticks(            0 ),
+    last_cycles(      0 ),
+    max_cycles(       0 ),
+    next_tick_micros( 0 )
+{
+    memset( offsets,         0, sizeof( offsets         ) );
+    memset( sums,            0, sizeof( sums            ) );
+    memset( lfo_phases,      0, sizeof( lfo_phases      ) );
+    memset( lfo_steps,       0, sizeof( lfo_steps       ) );
+    memset( lfo_values,      0, sizeof( lfo_values      ) );
+    memset( lfo_centihertz,  0, sizeof( lfo_centihertz  ) );
+    memset( envelope_levels, 0, sizeof( envelope_levels ) );
+    memset( random_values,   0, sizeof( random_values   ) );
+    memset( random_walks,    0, sizeof( random_walks    ) );
+    memset( random_browns,   0, sizeof( random_browns   ) );
+    memset( random_held,     0, sizeof( random_held     ) );
+}
+
+void muppet_modulation::gate( uint8_t channel_index, bool open ) {
+    if ( open && channel_index < dr_teeth::k_random_count ) {
+        random_clocked |= 1UL << channel_index;
+    }
+
+    if ( channel_index >= dr_teeth::k_envelope_count ) {
+        return;
+    }
+
+    if ( open ) {
+        envelope_open |= 1UL << channel_index;
+    } else {
+        envelope_open &= ~( 1UL << channel_index );
+    }
+    envelope_moving |= 1UL << channel_index;
+}
+
+bool muppet_modulation::tick( const muppet_frame_config& config, const uint16_t* input, const volatile uint16_t* cv_input, uint32_t now_micros ) {
+    if ( static_cast< int32_t >( now_micros - next_tick_micros ) < 0 ) {
+        return false;
+    }
+    next_tick_micros = now_micros + dr_teeth::k_modulation_tick_micros;
+
+    uint32_t start_cycles = ARM_DWT_CYCCNT;
+
+    advance( config );
+
+    // one pass over the routes, a destination's sum starts over at its first route
+    uint32_t touched = 0;
+    routes = config.modulation_route_count;
+    for ( uint8_t route = 0; route < routes; ++route ) {
+        uint8_t  destination = config.modulation_destinations[ route ];
+        uint32_t bit         = 1UL << destination;
+        int32_t  value       = source_value( config, config.modulation_sources[ route ], input, cv_input );
+
+        if ( !( touched & bit ) ) {
+            sums[ destination ] = 0;
+            touched            |= bit;
+        }
+        sums[ destination ] += ( value * config.modulation_depths[ route ] ) >> 14;
+    }
+
+    bool changed = false;
+    for ( uint32_t gone = live & ~touched; gone; gone &= gone - 1 ) {
+        uint8_t channel_index = __builtin_ctz( gone );
+        changed                  = changed || offsets[ channel_index ] != 0;
+        offsets[ channel_index ] = 0;
+    }
+    for ( uint32_t moved = touched; moved; moved &= moved - 1 ) {
+        uint8_t channel_index = __builtin_ctz( moved );
+        changed                  = changed || offsets[ channel_index ] != sums[ channel_index ];
+        offsets[ channel_index ] = sums[ channel_index ];
+    }
+    live = touched;
+
+    last_cycles = ARM_DWT_CYCCNT - start_cycles;
+    max_cycles  = last_cycles > max_cycles ? last_cycles : max_cycles;
+    ++ticks;
+
+    return changed;
+}
+
+void muppet_modulation::advance( const muppet_frame_config& config ) {
+    for ( uint8_t lfo_index = 0; lfo_index < dr_teeth::k_lfo_count; ++lfo_index ) {
+        uint16_t centihertz = config.lfo_centihertz[ lfo_index ];
+        if ( !centihertz ) {
+            continue;
+        }
+
+        if ( lfo_centihertz[ lfo_index ] != centihertz ) {
+            lfo_centihertz[ lfo_index ] = centihertz;
+            lfos[ lfo_index ].setFrequency( centihertz * 0.01f );
+            lfo_steps[ lfo_index ] = lfos[ lfo_index ].phaseStep( k_tick_hertz );
+        }
+
+        // wraps on its own at the end of the cycle
+        lfo_phases[ lfo_index ] += lfo_steps[ lfo_index ];
+    }
+    lfo_ready = 0;
+
+    for ( uint32_t moving = envelope_moving; moving; moving &= moving - 1 ) {
+        uint8_t  envelope_index = __builtin_ctz( moving );
+        bool     open           = envelope_open & ( 1UL << envelope_index );
+        uint32_t length_millis  = open ? config.envelope_attack_millis[ envelope_index ] : config.envelope_release_millis[ envelope_index ];
+        int32_t  step           = length_millis ? static_cast< int32_t >( k_full_scale * dr_teeth::k_modulation_tick_micros / ( length_millis * 1000 ) ) : k_full_scale;
+        int32_t& level          = envelope_levels[ envelope_index ];
+
+        step  = step ? step : 1;
+        level = open ? level + step : level - step;
+        if ( level >= k_full_scale || level <= 0 ) {
+            level            = level > 0 ? k_full_scale : 0;
+            envelope_moving &= ~( 1UL << envelope_index );
+        }
+    }
+
+    advance_randoms( config );
+}
+
+void muppet_modulation::advance_randoms( const muppet_frame_config& config ) {
+    int16_t white[ dr_teeth::k_random_count ];
+    randoms.white( white, dr_teeth::k_random_count );
+
+    for ( uint8_t random_index = 0; random_index < dr_teeth::k_random_count; ++random_index ) {
+        int16_t& value = random_values[ random_index ];
+
+        switch ( config.random_modes[ random_index ] ) {
+            case muppet_frame_config::k_random_white:
+                value = white[ random_index ];
+                break;
+
+            case muppet_frame_config::k_random_sample_and_hold: {
+                uint32_t hold_ticks = config.random_hold_millis[ random_index ] * 1000 / dr_teeth::k_modulation_tick_micros;
+                bool     clocked    = random_clocked & ( 1UL << random_index );
+
+                ++random_held[ random_index ];
+                if ( clocked || ( hold_ticks && random_held[ random_index ] >= hold_ticks ) ) {
+                    value                       = white[ random_index ];
+                    random_held[ random_index ] = 0;
+                }
+                break;
+            }
+
+            case muppet_frame_config::k_random_walk: {
+                // small random steps bounce off full scale, a one pole filter takes the corners off
+                int32_t& walk = random_walks[ random_index ];
+                walk += white[ random_index ] >> 5;
+                walk  = walk > 32767 ? 65534 - walk : walk < -32768 ? -65536 - walk : walk;
+                value = static_cast< int16_t >( value + ( ( walk - value ) >> 3 ) );
+                break;
+            }
+
+            case muppet_frame_config::k_random_pink:
+                value = random_generator::pink( random_pinks[ random_index ], white[ random_index ] );
+                break;
+
+            case muppet_frame_config::k_random_brown:
+                value = random_generator::brown( random_browns[ random_index ], white[ random_index ] );
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    random_clocked = 0;
+}
+
+int32_t muppet_modulation::source_value( const muppet_frame_config& config, uint8_t source, const uint16_t* input, const volatile uint16_t* cv_input ) {
+    if ( source < muppet_frame_config::k_cv_input_source ) {
+        return input[ source - muppet_frame_config::k_midi_source ] >> 1;
+    }
+    if ( source < muppet_frame_config::k_lfo_source ) {
+        return cv_input[ source - muppet_frame_config::k_cv_input_source ] >> 1;
+    }
+    if ( source < muppet_frame_config::k_envelope_source ) {
+        uint8_t lfo_index = source - muppet_frame_config::k_lfo_source;
+        if ( !( lfo_ready & ( 1UL << lfo_index ) ) ) {
+            function_generator& lfo   = lfos[ lfo_index ];
+            uint32_t            phase = lfo_phases[ lfo_index ];
+            int16_t*            value = &lfo_values[ lfo_index ];
+
+            switch ( config.lfo_shapes[ lfo_index ] ) {
+                case muppet_frame_config::k_lfo_triangle: lfo.triangle_q15( phase, 0, value, 1 ); break;
+                case muppet_frame_config::k_lfo_square:   lfo.square_q15(   phase, 0, value, 1 ); break;
+                case muppet_frame_config::k_lfo_sawtooth: lfo.sawtooth_q15( phase, 0, value, 1 ); break;
+                default:                                  lfo.sinus_q15(    phase, 0, value, 1 ); break;
+            }
+
+            lfo_ready |= 1UL << lfo_index;
+        }
+        return lfo_values[ lfo_index ];
+    }
+    if ( source < muppet_frame_config::k_random_source ) {
+        return envelope_levels[ source - muppet_frame_config::k_envelope_source ];
+    }
+    return random_values[ source - muppet_frame_config::k_random_source ];
+}
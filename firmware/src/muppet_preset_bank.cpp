@@ -0,0 +1,106 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <cstddef>
+#include <cstring>
+
+#include "muppet_preset_bank.h"
+#include "muppet_crc.h"
+
+muppet_preset_bank::muppet_preset_bank( void ) :
+    stored( 0 ),
+    dirty(  0 ),
+    writes( 0 )
+{
+    memset( records, 0, sizeof( records ) );
+}
+
+void muppet_preset_bank::load( void ) {
+    for ( uint8_t preset = 0; preset < k_presets; ++preset ) {
+        uint8_t* bytes   = reinterpret_cast< uint8_t* >( &records[ preset ] );
+        int      address = address_of( preset );
+
+        for ( int index = 0; index < k_record_bytes; ++index ) {
+            bytes[ index ] = EEPROM.read( address + index );
+        }
+
+        if ( records[ preset ].crc == crc_of( records[ preset ] ) ) {
+            stored |= 1UL << preset;
+        }
+    }
+}
+
+const muppet_preset_bank::record_t* muppet_preset_bank::recall( uint8_t preset ) const {
+    if ( preset >= k_presets || !( stored & ( 1UL << preset ) ) ) {
+        return nullptr;
+    }
+    return &records[ preset ];
+}
+
+bool muppet_preset_bank::store( uint8_t preset, const uint16_t* frame, const muppet_frame_config& config ) {
+    if ( preset >= k_presets ) {
+        return false;
+    }
+
+    // zeroed first so the padding, which the CRC covers, is the same every time
+    record_t record;
+    memset( &record, 0, sizeof( record ) );
+    memcpy( record.frame,                   frame,                          sizeof( record.frame ) );
+    memcpy( record.modulation_depths,       config.modulation_depths,       sizeof( record.modulation_depths ) );
+    memcpy( record.lfo_centihertz,          config.lfo_centihertz,          sizeof( record.lfo_centihertz ) );
+    memcpy( record.envelope_attack_millis,  config.envelope_attack_millis,  sizeof( record.envelope_attack_millis ) );
+    memcpy( record.envelope_release_millis, config.envelope_release_millis, sizeof( record.envelope_release_millis ) );
+    memcpy( record.random_hold_millis,      config.random_hold_millis,      sizeof( record.random_hold_millis ) );
+    memcpy( record.modulation_sources,      config.modulation_sources,      sizeof( record.modulation_sources ) );
+    memcpy( record.modulation_destinations, config.modulation_destinations, sizeof( record.modulation_destinations ) );
+    memcpy( record.lfo_shapes,              config.lfo_shapes,              sizeof( record.lfo_shapes ) );
+    memcpy( record.random_modes,            config.random_modes,            sizeof( record.random_modes ) );
+    record.modulation_route_count = config.modulation_route_count;
+    record.crc                    = crc_of( record );
+
+    // keep() copies the record out with interrupts off as well, it never sees half of one
+    __disable_irq();
+    records[ preset ] = record;
+    stored           |= 1UL << preset;
+    dirty             = dirty | ( 1UL << preset );
+    __enable_irq();
+    return true;
+}
+
+void muppet_preset_bank::keep( void ) {
+    if ( !dirty ) {
+        return;
+    }
+
+    record_t record;
+    uint8_t  preset;
+
+    __disable_irq();
+    preset  = __builtin_ctz( dirty );
+    record  = records[ preset ];
+    dirty   = dirty & ~( 1UL << preset );
+    __enable_irq();
+
+    const uint8_t* bytes   = reinterpret_cast< const uint8_t* >( &record );
+    int            address = address_of( preset );
+    for ( int index = 0; index < k_record_bytes; ++index ) {
+        EEPROM.update( address + index, bytes[ index ] );
+    }
+    ++writes;
+}
+
+void muppet_preset_bank::modulation_into( const record_t& record, muppet_frame_config& config ) {
+    config.modulation_route_count = record.modulation_route_count;
+    memcpy( config.modulation_depths,       record.modulation_depths,       sizeof( config.modulation_depths ) );
+    memcpy( config.lfo_centihertz,          record.lfo_centihertz,          sizeof( config.lfo_centihertz ) );
+    memcpy( config.envelope_attack_millis,  record.envelope_attack_millis,  sizeof( config.envelope_attack_millis ) );
+    memcpy( config.envelope_release_millis, record.envelope_release_millis, sizeof( config.envelope_release_millis ) );
+    memcpy( config.random_hold_millis,      record.random_hold_millis,      sizeof( config.random_hold_millis ) );
+    memcpy( config.modulation_sources,      record.modulation_sources,      sizeof( config.modulation_sources ) );
+    memcpy( config.modulation_destinations, record.modulation_destinations, sizeof( config.modulation_destinations ) );
+    memcpy( config.lfo_shapes,              record.lfo_shapes,              sizeof( config.lfo_shapes ) );
+    memcpy( config.random_modes,            record.random_modes,            sizeof( config.random_modes ) );
+}
+
+uint32_t muppet_preset_bank::crc_of( const record_t& record ) {
+    return muppet_crc::crc32( &record, offsetof( record_t, crc ), k_version );
+}
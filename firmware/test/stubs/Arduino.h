@@ -0,0 +1,69 @@
+#pragma once
+
+// Host stand-in for the Teensy core, just enough for the portable sources the
+// native tests link (dma_error_handler, i2c_fault_injector, deadline_timer).
+// Time only moves when a test says so: host_clock::advance_micros().
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+
+#define F(x) x
+
+#define LOW          0
+#define HIGH         1
+#define INPUT        0
+#define OUTPUT       1
+#define LED_BUILTIN  13
+
+using std::min;
+using std::max;
+
+namespace host_clock {
+    inline uint32_t micros_now = 0;
+
+    inline void advance_micros( uint32_t micros ) { micros_now += micros; }
+    inline void advance_millis( uint32_t millis ) { micros_now += millis * 1000; }
+}
+
+inline uint32_t micros( void )                 { return host_clock::micros_now;        }
+inline uint32_t millis( void )                 { return host_clock::micros_now / 1000; }
+inline void     delay( uint32_t millis )       { host_clock::advance_millis( millis ); }
+inline void     delayMicroseconds( uint32_t micros ) { host_clock::advance_micros( micros ); }
+inline void     yield( void )                  { }
+
+inline void pinMode( uint8_t, uint8_t )      { }
+inline void digitalWrite( uint8_t, uint8_t ) { }
+inline int  digitalRead( uint8_t )           { return LOW; }
+
+inline long random( long low, long high ) { return high > low ? low + std::rand( ) % ( high - low ) : low; }
+
+inline void __disable_irq( void ) { }
+inline void __enable_irq( void )  { }
+
+inline volatile uint32_t ARM_DWT_CYCCNT = 0;
+
+// Everything printed goes nowhere
+class Print {
+public:
+    template < typename value_t > size_t print( const value_t&, int = 0 )   { return 0; }
+    template < typename value_t > size_t println( const value_t&, int = 0 ) { return 0; }
+    size_t println( void ) { return 0; }
+};
+
+class Stream : public Print {
+public:
+    virtual ~Stream( ) { }
+    virtual int available( void ) { return 0;  }
+    virtual int read( void )      { return -1; }
+};
+
+class usb_serial_class : public Stream {
+public:
+    void begin( long ) { }
+};
+
+inline usb_serial_class Serial;
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+
+// Host stand-in: never fires, the tests drive deadlines by hand
+class IntervalTimer {
+public:
+    bool begin( void (*)( void ), uint32_t ) { return true; }
+    void end( void )                         { }
+    void update( uint32_t )                  { }
+    void priority( uint8_t )                 { }
+};
@@ -0,0 +1,42 @@
+#pragma once
+
+// Host stand-in for TeensyThreads: one thread, so every lock is free and
+// nothing can be started next to the test
+
+#define THREADS_STACK_ALIGN 8
+
+class Threads {
+public:
+    enum { EMPTY = 0, RUNNING, ENDED, ENDING, SUSPENDED };
+
+    class Mutex {
+    public:
+        int getState( void )             { return state; }
+        int lock( unsigned int = 0 )     { state = 1; return 1; }
+        int try_lock( void )             { if ( state ) return 0; state = 1; return 1; }
+        int unlock( void )               { state = 0; return 1; }
+    private:
+        int state = 0;
+    };
+
+    class Scope {
+    public:
+        Scope( Mutex& m ) : r( &m ) { r->lock( ); }
+        ~Scope( )                   { r->unlock( ); }
+    private:
+        Mutex* r;
+    };
+
+    template < typename function_t, typename argument_t >
+    int  addThread( function_t, argument_t, int = 0, void* = nullptr ) { return -1; }
+    int  getState( int )        { return EMPTY; }
+    int  id( void )             { return 0; }
+    int  restart( int )         { return 1; }
+    int  suspend( int )         { return 1; }
+    int  kill( int )            { return 1; }
+    int  setSliceMicros( int )  { return 1; }
+    void delay( int )           { }
+    void yield( void )          { }
+};
+
+inline Threads threads;
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "Arduino.h"
+
+// Host stand-in: a bus with nobody on it
+class TwoWire : public Stream {
+public:
+    void    begin( void )                   { }
+    void    end( void )                     { }
+    void    setClock( uint32_t )            { }
+    void    beginTransmission( uint8_t )    { }
+    uint8_t endTransmission( uint8_t = 1 )  { return 2; }
+    size_t  write( uint8_t )                { return 1; }
+    size_t  write( const uint8_t*, size_t length ) { return length; }
+    uint8_t requestFrom( uint8_t, uint8_t, uint8_t = 1 ) { return 0; }
+};
+
+inline TwoWire Wire, Wire1, Wire2;
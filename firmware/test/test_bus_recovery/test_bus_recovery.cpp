@@ -0,0 +1,193 @@
+#include <unity.h>
+
+#include "dma_error_handler.h"
+#include "drivers/i2c_fault_injector.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// Stuck bus recovery on the host
+// i2c_fault_injector holds SDA low on DAC 0 and dma_error_handler has to get
+// it back: retries with a backoff, then the peripheral reset, which releases
+// the bus. Each frame goes the way a DAC worker takes it: held while the
+// backoff runs, otherwise a transfer whose failure is reported like
+// electric_mayhem_dma::report_dma_result does. The host clock only moves when
+// the test says so.
+////////////////////////////////////////////////////////////////////////////////
+
+using dma_diagnostics::dma_error_handler;
+using drivers::dma_i2c_hal;
+using drivers::i2c_fault_injector;
+
+typedef dma_error_handler::recovery_strategy_t strategy_t;
+
+const uint8_t  k_dac                    = 0;
+const uint32_t k_backoff_ceiling_millis = 200;  // retry_delay_max_ms plus its jitter, with room
+
+enum class frame_t : uint8_t {
+    HELD = 0,       // backing off, not even tried
+    WRITTEN,
+    FAILED
+};
+
+struct rig_t {
+    i2c_fault_injector  injector;
+    dma_error_handler   handler;
+    uint8_t             retry_count = 0;
+    uint32_t            resets = 0;
+    bool                device_answers = true;
+    strategy_t          last_strategy = strategy_t::NONE;
+
+    rig_t( ) {
+        handler.attach_fault_injector( &injector );
+        handler.set_peripheral_reset_callback( reset, this );
+        injector.enable( );
+    }
+
+    // recover_muppet() stand-in: bus recovery, re-init and replay
+    static bool reset( uint8_t, void* user_data ) {
+        rig_t* rig = static_cast< rig_t* >( user_data );
+        rig->resets++;
+        return rig->device_answers;
+    }
+
+    frame_t frame( void ) {
+        if ( !handler.may_retry( k_dac, millis( ) ) ) {
+            return frame_t::HELD;
+        }
+
+        i2c_fault_injector::fault_t fault = injector.next_fault( k_dac );
+        dma_i2c_hal::error_code_t   result = i2c_fault_injector::error_for( fault );
+        injector.on_transfer_result( k_dac, result );
+
+        if ( result == dma_i2c_hal::error_code_t::SUCCESS ) {
+            handler.notify_success( k_dac );
+            retry_count = 0;
+            return frame_t::WRITTEN;
+        }
+
+        dma_error_handler::error_event_t event;
+        event.error_code  = result;
+        event.dac_index   = k_dac;
+        event.retry_count = retry_count;
+        event.recovery    = handler.handle_error( result, k_dac, retry_count );
+        last_strategy     = event.recovery;
+
+        bool recovered = handler.execute_recovery( event );
+        retry_count = ( recovered && event.recovery == strategy_t::RESET_PERIPHERAL ) ? 0 : retry_count + 1;
+        return frame_t::FAILED;
+    }
+
+    // Frames until one is written, letting every backoff run out; false if none is
+    frame_t frames_until_written( uint8_t limit, uint8_t& failures ) {
+        failures = 0;
+        for ( uint8_t i = 0; i < limit; ++i ) {
+            frame_t outcome = frame( );
+            if ( outcome == frame_t::WRITTEN ) {
+                return outcome;
+            }
+            if ( outcome == frame_t::FAILED ) {
+                failures++;
+            }
+            host_clock::advance_millis( k_backoff_ceiling_millis );
+        }
+        return frame_t::FAILED;
+    }
+};
+
+void setUp( void ) {
+    host_clock::micros_now = 1000000;
+}
+
+void tearDown( void ) { }
+
+void test_backoff_holds_frames_until_its_deadline( void ) {
+    rig_t rig;
+    rig.injector.arm_single_fault( k_dac, i2c_fault_injector::fault_t::STUCK_SDA );
+
+    TEST_ASSERT_TRUE( frame_t::FAILED == rig.frame( ) );
+    TEST_ASSERT_TRUE( strategy_t::RETRY_WITH_DELAY == rig.last_strategy );
+
+    // no sleeping in the recovery: the frame is held instead, the clock untouched
+    TEST_ASSERT_EQUAL_UINT32( 1000000, micros( ) );
+    TEST_ASSERT_TRUE( frame_t::HELD == rig.frame( ) );
+
+    host_clock::advance_millis( k_backoff_ceiling_millis );
+    TEST_ASSERT_TRUE( frame_t::FAILED == rig.frame( ) );
+}
+
+void test_stuck_bus_is_released_by_the_reset( void ) {
+    rig_t   rig;
+    uint8_t failures = 0;
+    const dma_error_handler::error_config_t& config = rig.handler.get_config( );
+
+    rig.injector.arm_single_fault( k_dac, i2c_fault_injector::fault_t::STUCK_SDA );
+
+    TEST_ASSERT_TRUE( frame_t::WRITTEN == rig.frames_until_written( 16, failures ) );
+
+    // every retry fails on the stuck bus, the one after them resets it
+    TEST_ASSERT_EQUAL_UINT8( config.max_retry_attempts + 1, failures );
+    TEST_ASSERT_TRUE( strategy_t::RESET_PERIPHERAL == rig.last_strategy );
+    TEST_ASSERT_EQUAL_UINT32( 1, rig.resets );
+    TEST_ASSERT_FALSE( rig.injector.is_bus_stuck( k_dac ) );
+    TEST_ASSERT_EQUAL_UINT8( 0, rig.retry_count );
+
+    const dma_error_handler::error_statistics_t& statistics = rig.handler.get_error_statistics( );
+    TEST_ASSERT_EQUAL_UINT32( failures, statistics.timeout_errors );
+    TEST_ASSERT_EQUAL_UINT32( 1, statistics.peripheral_resets );
+    TEST_ASSERT_EQUAL_UINT32( 1, statistics.successful_recoveries );
+}
+
+void test_stuck_bus_is_one_fault_one_sample( void ) {
+    rig_t   rig;
+    uint8_t failures = 0;
+
+    rig.injector.arm_single_fault( k_dac, i2c_fault_injector::fault_t::STUCK_SDA );
+    rig.frames_until_written( 16, failures );
+
+    // every failed transfer hit the same stuck bus: one injection, one latency sample,
+    // owned by the first strategy picked for it
+    TEST_ASSERT_EQUAL_UINT32( 1, rig.injector.get_injected_count( i2c_fault_injector::fault_t::STUCK_SDA ) );
+
+    const i2c_fault_injector::latency_statistics_t& latency =
+        rig.injector.get_latency_statistics( i2c_fault_injector::fault_t::STUCK_SDA,
+                                             static_cast< uint8_t >( strategy_t::RETRY_WITH_DELAY ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, latency.samples );
+    // frozen from the first failure to the first good frame, the backoffs in between
+    TEST_ASSERT_GREATER_OR_EQUAL( ( failures - 1 ) * k_backoff_ceiling_millis * 1000, latency.max_recover_us );
+}
+
+void test_reset_that_fails_is_counted( void ) {
+    rig_t   rig;
+    uint8_t failures = 0;
+
+    rig.device_answers = false;
+    rig.injector.arm_single_fault( k_dac, i2c_fault_injector::fault_t::STUCK_SDA );
+
+    // the reset frees the bus either way, the device just did not answer the re-init
+    TEST_ASSERT_TRUE( frame_t::WRITTEN == rig.frames_until_written( 16, failures ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, rig.resets );
+    TEST_ASSERT_EQUAL_UINT32( 1, rig.handler.get_error_statistics( ).failed_peripheral_resets );
+}
+
+void test_without_reset_the_bus_stays_stuck( void ) {
+    rig_t   rig;
+    uint8_t failures = 0;
+
+    rig.handler.set_peripheral_reset_callback( nullptr, nullptr );
+    rig.injector.arm_single_fault( k_dac, i2c_fault_injector::fault_t::STUCK_SDA );
+
+    // nobody can free it: the handler falls back to sync writes, which fail all the same
+    TEST_ASSERT_TRUE( frame_t::FAILED == rig.frames_until_written( 12, failures ) );
+    TEST_ASSERT_TRUE( strategy_t::FALLBACK_TO_SYNC == rig.last_strategy );
+    TEST_ASSERT_TRUE( rig.handler.is_sync_fallback_active( k_dac ) );
+    TEST_ASSERT_TRUE( rig.injector.is_bus_stuck( k_dac ) );
+}
+
+int main( void ) {
+    UNITY_BEGIN( );
+    RUN_TEST( test_backoff_holds_frames_until_its_deadline );
+    RUN_TEST( test_stuck_bus_is_released_by_the_reset );
+    RUN_TEST( test_stuck_bus_is_one_fault_one_sample );
+    RUN_TEST( test_reset_that_fails_is_counted );
+    RUN_TEST( test_without_reset_the_bus_stays_stuck );
+    return UNITY_END( );
+}
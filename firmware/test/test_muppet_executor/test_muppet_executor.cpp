@@ -0,0 +1,193 @@
+#include <unity.h>
+
+#include <atomic>
+#include <thread>
+
+#include "muppet_coroutine.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_executor and muppet_frame_pool on the host
+// A fake transfer stands in for set_frame_async: it parks the coroutine and
+// the test completes it, from the test thread or from a second one playing
+// the interrupt, by scheduling the handle like async_frame_transfer does.
+////////////////////////////////////////////////////////////////////////////////
+
+#ifdef MUPPET_COROUTINES
+
+// The transfer in flight; complete() is the completion interrupt
+struct fake_transfer {
+    static inline std::atomic< void* > parked{ nullptr };
+    static inline bool                 complete_on_suspend = false;
+
+    muppet_executor& executor;
+
+    bool await_ready( ) const noexcept { return false; }
+
+    void await_suspend( std::coroutine_handle<> handle ) {
+        if ( complete_on_suspend ) {
+            // done before the coroutine even finished suspending
+            executor.schedule( handle );
+            return;
+        }
+        parked.store( handle.address( ), std::memory_order_release );
+    }
+
+    void await_resume( ) const noexcept { }
+
+    static bool complete( muppet_executor& executor ) {
+        void* address = parked.exchange( nullptr, std::memory_order_acq_rel );
+        return address && executor.schedule( std::coroutine_handle<>::from_address( address ) );
+    }
+};
+
+// A DMA frame as the worker writes it: up to the transfer, then the rest once resumed
+static muppet_task frame( muppet_executor& executor, int& stage ) {
+    stage = 1;
+    co_await fake_transfer{ executor };
+    stage = 2;
+}
+
+// Same, with more state across the suspension than a pool frame holds
+static muppet_task oversized_frame( muppet_executor& executor, int& stage ) {
+    volatile uint8_t scratch[ 2 * muppet_frame_pool::k_frame_bytes ];
+    scratch[ 0 ] = 1;
+    stage = 1;
+    co_await fake_transfer{ executor };
+    stage = 2 + scratch[ 0 ];
+}
+
+void setUp( void ) {
+    fake_transfer::parked.store( nullptr );
+    fake_transfer::complete_on_suspend = false;
+}
+
+void tearDown( void ) { }
+
+void test_resumes_only_from_run( void ) {
+    muppet_executor executor;
+    int             stage = 0;
+
+    TEST_ASSERT_TRUE( frame( executor, stage ).started( ) );
+    TEST_ASSERT_EQUAL_INT( 1, stage );
+
+    TEST_ASSERT_EQUAL_UINT8( 0, executor.run( ) );
+    TEST_ASSERT_TRUE( fake_transfer::complete( executor ) );
+    TEST_ASSERT_EQUAL_INT( 1, stage );
+
+    TEST_ASSERT_EQUAL_UINT8( 1, executor.run( ) );
+    TEST_ASSERT_EQUAL_INT( 2, stage );
+    TEST_ASSERT_EQUAL_UINT8( 0, executor.run( ) );
+}
+
+void test_completion_before_suspend_waits_for_run( void ) {
+    muppet_executor executor;
+    int             stage = 0;
+
+    fake_transfer::complete_on_suspend = true;
+    TEST_ASSERT_TRUE( frame( executor, stage ).started( ) );
+    TEST_ASSERT_EQUAL_INT( 1, stage );
+
+    TEST_ASSERT_EQUAL_UINT32( 1, executor.run_until_idle( ) );
+    TEST_ASSERT_EQUAL_INT( 2, stage );
+}
+
+void test_full_executor_refuses_and_counts( void ) {
+    muppet_executor executor;
+    int             stages[ muppet_executor::k_capacity + 1 ] = { 0 };
+
+    // handles only, never resumed: the addresses just have to be distinct
+    for ( uint8_t i = 0; i < muppet_executor::k_capacity; ++i ) {
+        TEST_ASSERT_TRUE( executor.schedule( std::coroutine_handle<>::from_address( &stages[ i ] ) ) );
+    }
+    TEST_ASSERT_FALSE( executor.schedule( std::coroutine_handle<>::from_address( &stages[ muppet_executor::k_capacity ] ) ) );
+    TEST_ASSERT_EQUAL_UINT32( 1, executor.get_overflows( ) );
+}
+
+void test_pool_holds_one_frame_per_dac( void ) {
+    muppet_executor executors[ muppet_frame_pool::k_frames ];
+    int             stages[ muppet_frame_pool::k_frames ] = { 0 };
+    void*           parked[ muppet_frame_pool::k_frames ];
+
+    for ( uint8_t i = 0; i < muppet_frame_pool::k_frames; ++i ) {
+        TEST_ASSERT_TRUE( frame( executors[ i ], stages[ i ] ).started( ) );
+        parked[ i ] = fake_transfer::parked.exchange( nullptr );
+        TEST_ASSERT_NOT_NULL( parked[ i ] );
+    }
+
+    // every frame in flight: the next one never runs
+    muppet_executor extra_executor;
+    int             extra_stage = 0;
+    TEST_ASSERT_FALSE( frame( extra_executor, extra_stage ).started( ) );
+    TEST_ASSERT_EQUAL_INT( 0, extra_stage );
+
+    // one completes and frees its frame, which the next one gets
+    executors[ 0 ].schedule( std::coroutine_handle<>::from_address( parked[ 0 ] ) );
+    TEST_ASSERT_EQUAL_UINT8( 1, executors[ 0 ].run( ) );
+    TEST_ASSERT_EQUAL_INT( 2, stages[ 0 ] );
+    TEST_ASSERT_TRUE( frame( extra_executor, extra_stage ).started( ) );
+
+    // drain, so the pool is empty for the next test
+    fake_transfer::complete( extra_executor );
+    extra_executor.run_until_idle( );
+    for ( uint8_t i = 1; i < muppet_frame_pool::k_frames; ++i ) {
+        executors[ i ].schedule( std::coroutine_handle<>::from_address( parked[ i ] ) );
+        executors[ i ].run_until_idle( );
+        TEST_ASSERT_EQUAL_INT( 2, stages[ i ] );
+    }
+}
+
+void test_oversized_frame_is_not_started( void ) {
+    muppet_executor executor;
+    int             stage = 0;
+
+    TEST_ASSERT_FALSE( oversized_frame( executor, stage ).started( ) );
+    TEST_ASSERT_EQUAL_INT( 0, stage );
+}
+
+void test_completions_from_another_thread( void ) {
+    const uint32_t     k_frames = 5000;
+    muppet_executor    executor;
+    std::atomic< bool> done{ false };
+    uint32_t           finished = 0;
+
+    // the interrupt: completes whatever is parked, as soon as it is
+    std::thread completer( [ & ]( ) {
+        while ( !done.load( std::memory_order_acquire ) ) {
+            if ( !fake_transfer::complete( executor ) ) {
+                std::this_thread::yield( );
+            }
+        }
+    } );
+
+    for ( uint32_t i = 0; i < k_frames; ++i ) {
+        int stage = 0;
+        TEST_ASSERT_TRUE( frame( executor, stage ).started( ) );
+        while ( stage != 2 ) {
+            if ( !executor.run( ) ) {
+                std::this_thread::yield( );
+            }
+        }
+        ++finished;
+    }
+
+    done.store( true, std::memory_order_release );
+    completer.join( );
+
+    TEST_ASSERT_EQUAL_UINT32( k_frames, finished );
+    TEST_ASSERT_EQUAL_UINT32( 0, executor.get_overflows( ) );
+}
+
+#endif // MUPPET_COROUTINES
+
+int main( void ) {
+    UNITY_BEGIN( );
+#ifdef MUPPET_COROUTINES
+    RUN_TEST( test_resumes_only_from_run );
+    RUN_TEST( test_completion_before_suspend_waits_for_run );
+    RUN_TEST( test_full_executor_refuses_and_counts );
+    RUN_TEST( test_pool_holds_one_frame_per_dac );
+    RUN_TEST( test_oversized_frame_is_not_started );
+    RUN_TEST( test_completions_from_another_thread );
+#endif
+    return UNITY_END( );
+}
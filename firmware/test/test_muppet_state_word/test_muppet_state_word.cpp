@@ -0,0 +1,264 @@
+#include <unity.h>
+
+#include <cstdio>
+
+#include "muppet_state_word.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// muppet_state_word against a plain model of the protocol
+// Every sequence of k_depth operations, taken from what the worker, the
+// producers and the completion callback do to the word, runs on the real word
+// and on the model; after each step both must agree on the result and on the
+// whole word. On the target any of these can land between two others, so
+// covering every order covers every interleaving of whole operations.
+// The frame word (electric_mayhem_dma) and the operation word
+// (async_dac_manager) use different subsets, each checked for its invariants.
+////////////////////////////////////////////////////////////////////////////////
+
+typedef muppet_state_word word_t;
+
+const uint8_t  k_depth        = 6;
+const uint8_t  k_failure_code = 5;
+const uint32_t k_busy         = word_t::k_in_progress | word_t::k_pending;
+
+enum operation_t : uint8_t {
+    k_request = 0,      // producer: a new frame
+    k_try_begin,        // worker: takes the newest frame
+    k_hand_off,         // worker: the frame goes to DMA
+    k_try_start,        // async manager: a numbered operation
+    k_complete,         // callback: transfer done
+    k_fail,             // callback: transfer failed, with a code
+    k_collect,          // worker: completion seen, back to idle
+    k_retire,           // worker: frame done
+    k_operations
+};
+
+// The protocol written out field by field, no CAS, no packing tricks
+struct model_t {
+    uint32_t sequence = 0;      // in k_sequence_one steps
+    uint8_t  phase    = 0;
+    uint8_t  code     = 0;
+
+    uint32_t word( void ) const { return ( sequence << 8 ) | ( uint32_t( code ) << 4 ) | phase; }
+    uint8_t  low( void ) const  { return uint8_t( ( code << 4 ) | phase ); }
+
+    bool transition( uint32_t required, uint32_t forbidden, uint32_t set, uint32_t clear ) {
+        if ( ( low( ) & required ) != required || ( low( ) & forbidden ) ) {
+            return false;
+        }
+        uint8_t bits = uint8_t( ( low( ) & ~clear ) | set );
+        phase = bits & 0x0F;
+        code  = bits >> 4;
+        return true;
+    }
+};
+
+struct actors_t {
+    word_t   word;
+    model_t  model;
+    uint32_t last_sequence = 0;     // the worker's, as try_begin sees it
+};
+
+// Runs one operation on both; false when they disagree
+static bool step( actors_t& actors, operation_t operation ) {
+    word_t&  word  = actors.word;
+    model_t& model = actors.model;
+    bool     real  = false;
+    bool     expected = false;
+    uint32_t sequence = 0;
+
+    switch ( operation ) {
+        case k_request:
+            sequence = word.request( );
+            model.sequence = ( model.sequence + 1 ) & 0x00FFFFFF;
+            real = expected = true;
+            if ( sequence != ( model.sequence << 8 ) ) {
+                return false;
+            }
+            break;
+
+        case k_try_begin:
+            real = word.try_begin( actors.last_sequence, k_busy, sequence );
+            expected = ( model.sequence << 8 ) != actors.last_sequence && !( model.phase & k_busy );
+            if ( expected ) {
+                model.phase |= word_t::k_in_progress;
+                if ( !real || sequence != ( model.sequence << 8 ) ) {
+                    return false;
+                }
+                actors.last_sequence = sequence;
+            }
+            break;
+
+        case k_hand_off:
+            real     = word.transition( word_t::k_in_progress, 0, word_t::k_pending, 0 );
+            expected = model.transition( word_t::k_in_progress, 0, word_t::k_pending, 0 );
+            break;
+
+        case k_try_start:
+            real = word.try_start( word_t::k_pending, word_t::k_pending, sequence );
+            expected = !( model.phase & word_t::k_pending );
+            if ( expected ) {
+                model.sequence = ( model.sequence + 1 ) & 0x00FFFFFF;
+                model.phase = word_t::k_pending;
+                model.code  = 0;
+                if ( !real || sequence != ( model.sequence << 8 ) ) {
+                    return false;
+                }
+            }
+            break;
+
+        case k_complete:
+            real     = word.transition( word_t::k_pending, 0, word_t::k_completed, word_t::k_pending | word_t::k_code_mask );
+            expected = model.transition( word_t::k_pending, 0, word_t::k_completed, word_t::k_pending | word_t::k_code_mask );
+            break;
+
+        case k_fail:
+            real     = word.transition( word_t::k_pending, 0, word_t::k_completed | word_t::with_code( k_failure_code ),
+                                        word_t::k_pending | word_t::k_code_mask );
+            expected = model.transition( word_t::k_pending, 0, word_t::k_completed | word_t::with_code( k_failure_code ),
+                                         word_t::k_pending | word_t::k_code_mask );
+            break;
+
+        case k_collect:
+            real     = word.transition( word_t::k_completed, 0, 0, word_t::k_phase_mask );
+            expected = model.transition( word_t::k_completed, 0, 0, word_t::k_phase_mask );
+            break;
+
+        case k_retire:
+            word.retire( );
+            model.phase = 0;
+            model.code  = 0;
+            real = expected = true;
+            break;
+
+        default:
+            return false;
+    }
+
+    return real == expected && word.load( ) == model.word( );
+}
+
+// Frame word: request, try_begin, hand off, and the frame coroutine retires it
+const operation_t k_frame_protocol[]     = { k_request, k_try_begin, k_hand_off, k_retire };
+// Operation word: try_start, the callback completes or fails it, the worker collects
+const operation_t k_operation_protocol[] = { k_try_start, k_complete, k_fail, k_collect, k_retire };
+
+// The invariants both protocols keep whatever the order
+static bool consistent( const word_t& word ) {
+    uint32_t the_word = word.load( );
+
+    // a completion only comes from a pending transfer, which it ends
+    if ( word_t::is( the_word, word_t::k_completed ) && word_t::is( the_word, word_t::k_pending ) ) {
+        return false;
+    }
+    // nothing but the four phase bits
+    return ( the_word & word_t::k_phase_mask & ~( k_busy | word_t::k_completed ) ) == 0;
+}
+
+void setUp( void ) { }
+void tearDown( void ) { }
+
+// Runs every order of k_depth operations out of the given ones; false on the first
+// divergence from the model, or on a broken invariant when asked to check them
+static bool every_order( const operation_t* operations, uint8_t count, bool check_invariants, char* failure, size_t length ) {
+    uint32_t total = 1;
+    for ( uint8_t i = 0; i < k_depth; ++i ) {
+        total *= count;
+    }
+
+    for ( uint32_t order = 0; order < total; ++order ) {
+        actors_t actors;
+        uint32_t remaining = order;
+
+        for ( uint8_t i = 0; i < k_depth; ++i ) {
+            operation_t operation = operations[ remaining % count ];
+            remaining /= count;
+
+            bool agreed = step( actors, operation );
+            if ( !agreed || ( check_invariants && !consistent( actors.word ) ) ) {
+                snprintf( failure, length, "order %lu %s at step %u", ( unsigned long )order,
+                          agreed ? "broke an invariant" : "diverged from the model", i );
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void test_every_interleaving_matches_the_model( void ) {
+    operation_t all[ k_operations ];
+    for ( uint8_t i = 0; i < k_operations; ++i ) {
+        all[ i ] = operation_t( i );
+    }
+
+    char failure[ 64 ];
+    TEST_ASSERT_TRUE_MESSAGE( every_order( all, k_operations, false, failure, sizeof( failure ) ), failure );
+}
+
+void test_frame_protocol_keeps_its_invariants( void ) {
+    char failure[ 64 ];
+    TEST_ASSERT_TRUE_MESSAGE( every_order( k_frame_protocol, sizeof( k_frame_protocol ), true, failure, sizeof( failure ) ), failure );
+}
+
+void test_operation_protocol_keeps_its_invariants( void ) {
+    char failure[ 64 ];
+    TEST_ASSERT_TRUE_MESSAGE( every_order( k_operation_protocol, sizeof( k_operation_protocol ), true, failure, sizeof( failure ) ), failure );
+}
+
+void test_completion_needs_a_pending_transfer( void ) {
+    word_t word;
+
+    TEST_ASSERT_FALSE( word.transition( word_t::k_pending, 0, word_t::k_completed, word_t::k_pending ) );
+
+    uint32_t sequence = 0;
+    TEST_ASSERT_TRUE( word.try_start( word_t::k_pending, word_t::k_pending, sequence ) );
+    TEST_ASSERT_FALSE( word.try_start( word_t::k_pending, word_t::k_pending, sequence ) );
+
+    // a second completion for the same transfer is refused
+    TEST_ASSERT_TRUE( word.transition( word_t::k_pending, 0, word_t::k_completed, word_t::k_pending ) );
+    TEST_ASSERT_FALSE( word.transition( word_t::k_pending, 0, word_t::k_completed, word_t::k_pending ) );
+    TEST_ASSERT_EQUAL_UINT32( sequence, word.sequence( ) );
+}
+
+void test_retire_keeps_the_sequence( void ) {
+    word_t   word;
+    uint32_t sequence = 0;
+
+    word.request( );
+    word.request( );
+    TEST_ASSERT_TRUE( word.try_begin( 0, k_busy, sequence ) );
+    TEST_ASSERT_TRUE( word.transition( word_t::k_in_progress, 0, word_t::with_code( 3 ), 0 ) );
+
+    word.retire( );
+    TEST_ASSERT_EQUAL_UINT32( sequence, word.load( ) );
+    TEST_ASSERT_EQUAL_UINT32( 2 * word_t::k_sequence_one, sequence );
+}
+
+void test_sequence_wraps_with_the_word( void ) {
+    word_t   word;
+    uint32_t sequence = 0;
+
+    // last frame before the wrap, taken by the worker
+    for ( uint32_t i = 0; i < 0x00FFFFFF; ++i ) {
+        word.request( );
+    }
+    TEST_ASSERT_TRUE( word.try_begin( 0, k_busy, sequence ) );
+    TEST_ASSERT_EQUAL_UINT32( word_t::k_sequence_mask, sequence );
+    word.retire( );
+
+    // the next one is sequence 0 again, and still new to the worker
+    TEST_ASSERT_EQUAL_UINT32( 0, word.request( ) );
+    TEST_ASSERT_TRUE( word.try_begin( sequence, k_busy, sequence ) );
+    TEST_ASSERT_EQUAL_UINT32( 0, sequence );
+}
+
+int main( void ) {
+    UNITY_BEGIN( );
+    RUN_TEST( test_every_interleaving_matches_the_model );
+    RUN_TEST( test_frame_protocol_keeps_its_invariants );
+    RUN_TEST( test_operation_protocol_keeps_its_invariants );
+    RUN_TEST( test_completion_needs_a_pending_transfer );
+    RUN_TEST( test_retire_keeps_the_sequence );
+    RUN_TEST( test_sequence_wraps_with_the_word );
+    return UNITY_END( );
+}
@@ -0,0 +1,154 @@
+#include <unity.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include "random_generator.h"
+
+////////////////////////////////////////////////////////////////////////////////
+// random_generator on the host
+// Distribution of the white blocks, the level of the colored filters, and how
+// many samples a second the blocks come out at on this machine.
+////////////////////////////////////////////////////////////////////////////////
+
+const uint16_t k_block        = 4096;
+const uint32_t k_blocks       = 256;                    // 2^20 samples
+const uint8_t  k_bins         = 16;
+const double   k_full_scale   = 32768.0;
+const double   k_uniform_sd   = 65536.0 / std::sqrt( 12.0 );
+
+static int16_t block[ k_block ];
+
+void setUp( void ) { }
+void tearDown( void ) { }
+
+void test_white_is_flat( void ) {
+    random_generator generator( 1234 );
+    uint32_t         histogram[ k_bins ] = { 0 };
+    double           sum = 0.0;
+    double           squares = 0.0;
+
+    for ( uint32_t b = 0; b < k_blocks; ++b ) {
+        generator.white( block, k_block );
+        for ( uint16_t i = 0; i < k_block; ++i ) {
+            histogram[ uint16_t( block[ i ] + 32768 ) >> 12 ]++;
+            sum     += block[ i ];
+            squares += double( block[ i ] ) * block[ i ];
+        }
+    }
+
+    const double samples  = double( k_block ) * k_blocks;
+    const double expected = samples / k_bins;
+    double       chi_square = 0.0;
+    for ( uint8_t i = 0; i < k_bins; ++i ) {
+        chi_square += ( histogram[ i ] - expected ) * ( histogram[ i ] - expected ) / expected;
+    }
+
+    double mean = sum / samples;
+    double sd   = std::sqrt( squares / samples - mean * mean );
+
+    // 15 degrees of freedom: 50 is far past p = 0.0001
+    TEST_ASSERT_LESS_THAN( 50.0, chi_square );
+    // the mean's own sd is about 18, five of them
+    TEST_ASSERT_DOUBLE_WITHIN( 100.0, 0.0, mean );
+    TEST_ASSERT_DOUBLE_WITHIN( k_uniform_sd * 0.01, k_uniform_sd, sd );
+}
+
+void test_white_lanes_are_not_correlated( void ) {
+    random_generator generator( 99 );
+    double           products = 0.0;
+    double           squares = 0.0;
+    int16_t          previous = 0;
+
+    for ( uint32_t b = 0; b < k_blocks; ++b ) {
+        generator.white( block, k_block );
+        for ( uint16_t i = 0; i < k_block; ++i ) {
+            products += double( block[ i ] ) * previous;
+            squares  += double( block[ i ] ) * block[ i ];
+            previous  = block[ i ];
+        }
+    }
+
+    // neighbours come from different lanes, or from one lane a step apart
+    TEST_ASSERT_DOUBLE_WITHIN( 0.01, 0.0, products / squares );
+}
+
+void test_same_seed_same_blocks( void ) {
+    random_generator first( 7 );
+    random_generator second( 1 );
+    int16_t          other[ k_block ];
+
+    second.setSeed( 7 );
+    first.white( block, k_block );
+    second.white( other, k_block );
+
+    TEST_ASSERT_EQUAL_INT( 0, memcmp( block, other, sizeof( block ) ) );
+}
+
+// rms of a filter over 2^20 white samples, in fractions of full scale
+template < typename filter_t >
+static double colored_rms( filter_t filter ) {
+    random_generator generator( 4321 );
+    double           squares = 0.0;
+
+    for ( uint32_t b = 0; b < k_blocks; ++b ) {
+        generator.white( block, k_block );
+        for ( uint16_t i = 0; i < k_block; ++i ) {
+            double sample = filter( block[ i ] );
+            squares += sample * sample;
+        }
+    }
+    return std::sqrt( squares / ( double( k_block ) * k_blocks ) ) / k_full_scale;
+}
+
+void test_pink_level( void ) {
+    random_generator::pink_state state;
+    double rms = colored_rms( [ &state ]( int16_t white ) { return random_generator::pink( state, white ); } );
+
+    // about a fifth of full scale, nowhere near clipping
+    TEST_ASSERT_GREATER_THAN( 0.17, rms );
+    TEST_ASSERT_LESS_THAN( 0.26, rms );
+}
+
+void test_brown_level( void ) {
+    int32_t state = 0;
+    double  rms = colored_rms( [ &state ]( int16_t white ) { return random_generator::brown( state, white ); } );
+
+    TEST_ASSERT_GREATER_THAN( 0.17, rms );
+    TEST_ASSERT_LESS_THAN( 0.26, rms );
+}
+
+void test_white_samples_per_second( void ) {
+    random_generator generator;
+    const uint32_t   rounds = 4 * k_blocks;
+    volatile int16_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now( );
+    for ( uint32_t b = 0; b < rounds; ++b ) {
+        generator.white( block, k_block );
+        sink = block[ b % k_block ];
+    }
+    std::chrono::duration< double > elapsed = std::chrono::steady_clock::now( ) - start;
+    ( void )sink;
+
+    double rate = double( k_block ) * rounds / elapsed.count( );
+    char   message[ 96 ];
+    snprintf( message, sizeof( message ), "white: %.1f M samples/s on the host", rate / 1e6 );
+    TEST_MESSAGE( message );
+
+    // only a floor: a 48 kHz block rate many times over, even on a slow runner
+    TEST_ASSERT_GREATER_THAN( 1e6, rate );
+}
+
+int main( void ) {
+    UNITY_BEGIN( );
+    RUN_TEST( test_white_is_flat );
+    RUN_TEST( test_white_lanes_are_not_correlated );
+    RUN_TEST( test_same_seed_same_blocks );
+    RUN_TEST( test_pink_level );
+    RUN_TEST( test_brown_level );
+    RUN_TEST( test_white_samples_per_second );
+    return UNITY_END( );
+}